@@ -0,0 +1,102 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+namespace bench {
+
+struct Case {
+    const char* name;
+    void (*fn)();
+};
+
+inline std::vector<Case>& registry() {
+    static std::vector<Case> cases;
+    return cases;
+}
+
+struct Registrar {
+    Registrar(const char* name, void (*fn)()) { registry().push_back({name, fn}); }
+};
+
+// Best wall-clock time of `reps` runs, in milliseconds
+template <class F>
+double time_ms(F&& fn, int reps = 3) {
+    double best = 1e300;
+    for (int i = 0; i < reps; ++i) {
+        auto t0 = std::chrono::steady_clock::now();
+        fn();
+        auto t1 = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(t1 - t0).count());
+    }
+    return best;
+}
+
+inline void report(const std::string& label, double value, const std::string& unit) {
+    std::cout << "  " << std::left << std::setw(48) << label
+              << std::right << std::setw(12) << std::fixed << std::setprecision(2) << value
+              << " " << unit << "\n";
+}
+
+// Integer knob read from the environment, e.g. BENCH_MAX_MB=100
+inline long env_or(const char* name, long fallback) {
+    const char* v = std::getenv(name);
+    return v && *v ? std::strtol(v, nullptr, 10) : fallback;
+}
+
+struct Memory {
+    long rssKb = 0;    ///< Resident set
+    long anonKb = 0;   ///< Resident pages not backed by a file: heap, stacks
+};
+
+// Current memory use from /proc/self/statm (zeros where that does not exist)
+inline Memory memory_now() {
+    std::ifstream statm("/proc/self/statm");
+    long size = 0, resident = 0, shared = 0;
+    if (!(statm >> size >> resident >> shared)) return {};
+    const long pageKb = ::sysconf(_SC_PAGESIZE) / 1024;
+    return {resident * pageKb, (resident - shared) * pageKb};
+}
+
+// Peak growth of resident and anonymous memory while `fn` runs, sampled every millisecond
+template <class F>
+Memory peak_memory_growth(F&& fn) {
+    const Memory base = memory_now();
+    Memory peak = base;
+    std::atomic<bool> done {false};
+    std::thread sampler([&] {
+        while (!done) {
+            const Memory m = memory_now();
+            peak.rssKb = std::max(peak.rssKb, m.rssKb);
+            peak.anonKb = std::max(peak.anonKb, m.anonKb);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    fn();
+    done = true;
+    sampler.join();
+    const Memory last = memory_now();
+    return {std::max(peak.rssKb, last.rssKb) - base.rssKb, std::max(peak.anonKb, last.anonKb) - base.anonKb};
+}
+
+}
+
+// Benchmarks register themselves and are run by bench_main.cpp (optionally filtered by name)
+#define BENCH(bench_name) \
+    void bench_name(); \
+    static bench::Registrar bench_name##_registrar(#bench_name, bench_name); \
+    void bench_name()
+
+#endif
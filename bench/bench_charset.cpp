@@ -0,0 +1,40 @@
+#include "bench.h"
+#include "core/charset.h"
+
+#include <string>
+
+namespace {
+
+std::string repeat_to(std::size_t bytes, const std::string& unit) {
+    std::string out;
+    out.reserve(bytes + unit.size());
+    while (out.size() < bytes) out += unit;
+    return out;
+}
+
+}
+
+BENCH(bench_charset_throughput) {
+    const std::size_t bytes = static_cast<std::size_t>(bench::env_or("BENCH_CHARSET_MB", 128)) << 20;
+
+    const std::string english = repeat_to(bytes, "The quick brown fox jumps over the lazy dog, again and again.\n");
+    const std::string mixed = repeat_to(bytes, "Caf\xC3\xA9 cr\xC3\xA8me br\xC3\xBBl\xC3\xA9\x65 co\xC3\xBBte 5 \xE2\x82\xAC. ");
+    const std::string cjk = repeat_to(bytes, "\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E\xE3\x81\xAE\xE6\x96\x87\xE7\xAB\xA0\xE3\x80\x82");
+    const std::string latin1 = repeat_to(bytes, "Caf\xE9 cr\xE8me br\xFBl\xE9\x65 co\xFBte 5 \x80. Plain ASCII text follows here.\n");
+
+    auto gbps = [](std::size_t n, double ms) { return n / 1e9 / (ms / 1000.0); };
+
+    bool ok = true;
+    double ms = bench::time_ms([&] { ok &= is_valid_utf8(english); });
+    bench::report("validate UTF-8 (ASCII text)", gbps(english.size(), ms), "GB/s");
+    ms = bench::time_ms([&] { ok &= is_valid_utf8(mixed); });
+    bench::report("validate UTF-8 (Latin text)", gbps(mixed.size(), ms), "GB/s");
+    ms = bench::time_ms([&] { ok &= is_valid_utf8(cjk); });
+    bench::report("validate UTF-8 (CJK text)", gbps(cjk.size(), ms), "GB/s");
+
+    std::string out;
+    ms = bench::time_ms([&] { out = to_utf8(latin1, Charset::Windows1252); });
+    bench::report("windows-1252 -> UTF-8", gbps(latin1.size(), ms), "GB/s");
+
+    if (!ok) bench::report("unexpected invalid input", 0, "");
+}
@@ -0,0 +1,97 @@
+#include "bench.h"
+#include "local_server.h"
+#include "core/html_parser.h"
+#include "core/page_daemon.h"
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::string page_html(const std::string& path, std::size_t size) {
+    std::string html = "<html><head><title>" + path + "</title></head><body>";
+    for (int i = 0; html.size() < size; ++i) {
+        html += "<p>Paragraph " + std::to_string(i) + " of " + path + " with <a href=\"/page/"
+              + std::to_string(i) + "\">a link</a> and some &amp; entities.</p>\n";
+    }
+    return html + "</body></html>";
+}
+
+// Per-request latency of `n` cache hits on one connection, sorted ascending (microseconds)
+std::vector<double> hit_latencies(PageClient& client, const std::string& url, int n) {
+    std::vector<double> us;
+    us.reserve(n);
+    for (int i = 0; i < n; ++i) {
+        auto t0 = Clock::now();
+        client.fetch(url);
+        us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - t0).count());
+    }
+    std::sort(us.begin(), us.end());
+    return us;
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    return sorted[std::min(sorted.size() - 1, static_cast<std::size_t>(p * static_cast<double>(sorted.size())))];
+}
+
+}
+
+// Cache-hit latency and throughput of the page daemon, against fetching and parsing in-process
+BENCH(bench_daemon_cache_hits) {
+    LocalServer server([](const LocalServer::Request& req) {
+        return LocalServer::Response{200, page_html(req.path, req.path.starts_with("/large") ? 1u << 20 : 4096)};
+    });
+    const std::string path = (std::filesystem::temp_directory_path() / "mini-browser-bench-daemon.sock").string();
+    PageDaemon daemon;
+    if (!daemon.start(path)) {
+        std::cerr << "  cannot listen on " << path << "\n";
+        return;
+    }
+    const std::string small = server.url() + "/small";
+    const std::string large = server.url() + "/large";
+    const int n = static_cast<int>(bench::env_or("BENCH_DAEMON_REQUESTS", 2000));
+
+    PageClient client;
+    client.connect(path);
+    client.fetch(small);
+    client.fetch(large);
+
+    double direct = bench::time_ms([&] {
+        HttpResult r = http_get(small);
+        parse_html_basic(r.bodyView());
+    });
+    bench::report("in-process fetch + parse, 4 KB page", direct * 1000.0, "us");
+
+    std::vector<double> us = hit_latencies(client, small, n);
+    bench::report("daemon hit p50, 4 KB page (inline)", percentile(us, 0.50), "us");
+    bench::report("daemon hit p99, 4 KB page (inline)", percentile(us, 0.99), "us");
+    us = hit_latencies(client, large, std::max(1, n / 10));
+    bench::report("daemon hit p50, 1 MB page (shared memory)", percentile(us, 0.50), "us");
+    bench::report("daemon hit p99, 1 MB page (shared memory)", percentile(us, 0.99), "us");
+
+    // Many viewer processes at once, one connection each
+    for (long clients : {1L, 8L, bench::env_or("BENCH_DAEMON_CLIENTS", 64)}) {
+        std::atomic<long> done {0};
+        double ms = bench::time_ms([&] {
+            std::vector<std::thread> threads;
+            for (long t = 0; t < clients; ++t) {
+                threads.emplace_back([&] {
+                    PageClient c;
+                    if (!c.connect(path)) return;
+                    for (int i = 0; i < n / clients + 1; ++i) {
+                        if (c.fetch(small).response.status == 200) ++done;
+                    }
+                });
+            }
+            for (auto& t : threads) t.join();
+        }, 1);
+        bench::report("hits/s with " + std::to_string(clients) + " clients", static_cast<double>(done) / ms * 1000.0, "req/s");
+    }
+    daemon.stop();
+}
@@ -0,0 +1,93 @@
+#include "bench.h"
+#include "core/executor.h"
+#include "core/thread_pool.h"
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+long context_switches() {
+    rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_nvcsw + usage.ru_nivcsw;
+}
+
+// A few microseconds of arithmetic, about the size of one small parse or layout piece
+std::uint64_t work(std::uint64_t seed) {
+    std::uint64_t x = seed;
+    for (int i = 0; i < 2000; ++i) x = x * 6364136223846793005ull + 1442695040888963407ull;
+    return x;
+}
+
+// Submit `n` tasks through `submit`, wait for all; returns context switches per 1,000 tasks
+template <class Submit>
+double run_batch(long n, Submit&& submit, double& ms) {
+    const long before = context_switches();
+    ms = bench::time_ms([&] {
+        std::vector<std::future<std::uint64_t>> results;
+        results.reserve(static_cast<std::size_t>(n));
+        for (long i = 0; i < n; ++i) results.push_back(submit(static_cast<std::uint64_t>(i)));
+        for (auto& r : results) r.get();
+    }, 1);
+    return static_cast<double>(context_switches() - before) * 1000.0 / static_cast<double>(n);
+}
+
+// Round trip of one task: submit, run on a worker, get the result (microseconds, p50)
+template <class Submit>
+double round_trip_us(int n, Submit&& submit) {
+    std::vector<double> us;
+    us.reserve(static_cast<std::size_t>(n));
+    for (int i = 0; i < n; ++i) {
+        auto t0 = Clock::now();
+        submit(static_cast<std::uint64_t>(i)).get();
+        us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - t0).count());
+    }
+    std::nth_element(us.begin(), us.begin() + n / 2, us.end());
+    return us[static_cast<std::size_t>(n / 2)];
+}
+
+}
+
+// Task throughput, latency and context switches: std::async vs ThreadPool vs the work-stealing Executor
+BENCH(bench_executor_vs_async) {
+    const long n = bench::env_or("BENCH_TASKS", 20000);
+    Executor executor;
+    ThreadPool pool;
+    auto viaAsync = [](std::uint64_t i) { return std::async(std::launch::async, [i] { return work(i); }); };
+    auto viaPool = [&](std::uint64_t i) { return pool.submit([i] { return work(i); }); };
+    auto viaExecutor = [&](std::uint64_t i) { return executor.submit([i] { return work(i); }); };
+
+    double ms = 0;
+    double cs = run_batch(n, viaAsync, ms);
+    bench::report(std::to_string(n) + " tasks, std::async", ms, "ms");
+    bench::report("  context switches per 1000 tasks", cs, "");
+    cs = run_batch(n, viaPool, ms);
+    bench::report(std::to_string(n) + " tasks, ThreadPool", ms, "ms");
+    bench::report("  context switches per 1000 tasks", cs, "");
+    cs = run_batch(n, viaExecutor, ms);
+    bench::report(std::to_string(n) + " tasks, Executor", ms, "ms");
+    bench::report("  context switches per 1000 tasks", cs, "");
+
+    const int trips = static_cast<int>(std::min(n, 5000L));
+    bench::report("round trip p50, std::async", round_trip_us(trips, viaAsync), "us");
+    bench::report("round trip p50, ThreadPool", round_trip_us(trips, viaPool), "us");
+    bench::report("round trip p50, Executor", round_trip_us(trips, viaExecutor), "us");
+
+    // Nested fork/join from inside a task, the shape of a parse splitting into chunks
+    ms = bench::time_ms([&] {
+        executor.submit([&] {
+            std::vector<std::future<std::uint64_t>> parts;
+            for (long i = 0; i < n; ++i) parts.push_back(executor.submit([i] { return work(static_cast<std::uint64_t>(i)); }));
+            for (auto& part : parts) executor.wait(part);
+        }).get();
+    }, 1);
+    bench::report(std::to_string(n) + " tasks forked from a task, Executor", ms, "ms");
+    bench::report("  of which stolen by other workers", static_cast<double>(executor.stats().stolen), "");
+}
@@ -0,0 +1,45 @@
+#include "bench.h"
+#include "core/html_parser.h"
+
+#include <string>
+#include <thread>
+
+namespace {
+
+// Generated report/log page of roughly `bytes` size
+std::string make_report(std::size_t bytes) {
+    std::string html = "<html><head><title>Report</title><style>td{padding:2px}</style></head><body>\n";
+    html.reserve(bytes + 256);
+    for (std::size_t row = 0; html.size() < bytes; ++row) {
+        std::string n = std::to_string(row);
+        html += "<div class=\"row\"><p>2025-01-01 12:00:00 INFO worker-" + n +
+                " processed batch &amp; flushed <b>" + n + "</b> records</p>"
+                "<a href=\"/logs/" + n + "\">details " + n + "</a></div>\n";
+        if (row % 1000 == 0) html += "<script>\nconsole.log('<p>row " + n + "</p>');\n</script>\n";
+    }
+    html += "</body></html>";
+    return html;
+}
+
+}
+
+BENCH(bench_parse_parallel_speedup) {
+    long maxMb = bench::env_or("BENCH_MAX_MB", 100);
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    for (long mb : {10L, 50L, 100L}) {
+        if (mb > maxMb) break;
+        std::string html = make_report(static_cast<std::size_t>(mb) << 20);
+        double serial = bench::time_ms([&]{ parse_html_basic(html); });
+        bench::report(std::to_string(mb) + " MB serial", html.size() / 1048576.0 / (serial / 1000.0), "MB/s");
+        for (unsigned threads = 2; threads <= cores * 2; threads *= 2) {
+            ParseOptions options;
+            options.threads = threads;
+            double t = bench::time_ms([&]{ parse_html_basic(html, options); });
+            bench::report(std::to_string(mb) + " MB x" + std::to_string(threads) + " threads speedup", serial / t, "x");
+        }
+        ParseOptions all;
+        all.threads = 0;
+        double t = bench::time_ms([&]{ parse_html_basic(html, all); });
+        bench::report(std::to_string(mb) + " MB all " + std::to_string(cores) + " cores speedup", serial / t, "x");
+    }
+}
@@ -0,0 +1,58 @@
+#include "bench.h"
+#include "local_server.h"
+#include "core/http_engine.h"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+// N concurrent loopback GETs: one thread per request running http_get vs the single-threaded HttpEngine
+BENCH(bench_http_engine_concurrency) {
+    const std::string page(4096, 'x');
+    LocalServer server([&](const LocalServer::Request&) { return LocalServer::Response{200, page, "text/plain"}; });
+    const std::string url = server.url() + "/page";
+    HttpEngine engine;
+
+    for (long n : {1L, 100L, bench::env_or("BENCH_ENGINE_MAX", 5000)}) {
+        const std::string label = std::to_string(n) + " concurrent, ";
+        std::atomic<long> ok {0};
+        double ms = 0;
+        long grown = bench::peak_memory_growth([&] {
+            ms = bench::time_ms([&] {
+                std::vector<std::thread> threads;
+                threads.reserve(static_cast<std::size_t>(n));
+                for (long i = 0; i < n; ++i) {
+                    threads.emplace_back([&] {
+                        if (http_get(url).status == 200) ++ok;
+                    });
+                }
+                for (auto& t : threads) t.join();
+            }, 1);
+        }).rssKb;
+        bench::report(label + "thread per request", ms, "ms");
+        bench::report("  requests/s", static_cast<double>(ok) / ms * 1000.0, "req/s");
+        bench::report("  peak RSS growth", static_cast<double>(grown) / 1024.0, "MB");
+        bench::report("  threads", static_cast<double>(n), "");
+
+        ok = 0;
+        grown = bench::peak_memory_growth([&] {
+            ms = bench::time_ms([&] {
+                std::atomic<long> done {0};
+                for (long i = 0; i < n; ++i) {
+                    engine.fetch(url, [&](HttpResult r) {
+                        if (r.status == 200) ++ok;
+                        ++done;
+                    });
+                }
+                while (done < n) std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }, 1);
+        }).rssKb;
+        bench::report(label + "HttpEngine", ms, "ms");
+        bench::report("  requests/s", static_cast<double>(ok) / ms * 1000.0, "req/s");
+        bench::report("  peak RSS growth", static_cast<double>(grown) / 1024.0, "MB");
+        bench::report("  threads", 1, "");
+    }
+    bench::report("HttpEngine peak transfers in flight", static_cast<double>(engine.stats().peakActive), "");
+}
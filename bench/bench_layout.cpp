@@ -0,0 +1,34 @@
+#include "bench.h"
+#include "core/html_parser.h"
+#include "core/text_layout.h"
+
+#include <string>
+
+// Headless layout throughput with a font-metrics stub (proportional advances, no SFML)
+BENCH(bench_text_layout) {
+    const long maxMb = bench::env_or("BENCH_LAYOUT_MB", 16);
+    TableGlyphMetrics metrics(8.f, 17.f);
+    for (char32_t c = U' '; c < 0x7F; ++c) metrics.set(c, 4.f + static_cast<float>(c % 7));
+
+    for (long mb = 1; mb <= maxMb; mb *= 4) {
+        std::string html = "<html><body>";
+        for (long i = 0; html.size() < static_cast<std::size_t>(mb) << 20; ++i) {
+            html += "<p>Paragraph " + std::to_string(i) + " runs on for a while with ordinary words, ";
+            html += "a <a href=\"/a/" + std::to_string(i) + "\">link in the middle</a> and some more caf\xC3\xA9 text ";
+            html += "so that it wraps over several lines at typical window widths.</p>\n";
+        }
+        ParsedPage page = parse_html_basic(html);
+
+        const std::string label = std::to_string(mb) + " MB page";
+        TextLayout layout;
+        double serial = bench::time_ms([&] { layout = layout_text(page.text, page.links, metrics, LayoutOptions{780.f, 1}); });
+        double parallel = bench::time_ms([&] { layout = layout_text(page.text, page.links, metrics, LayoutOptions{780.f, 0}); });
+        const std::size_t lines = layout.lines().size();
+        double narrow = bench::time_ms([&] { layout = layout_text(page.text, page.links, metrics, LayoutOptions{300.f, 0}); });
+        bench::report(label + ": lines at 780 px", static_cast<double>(lines), "");
+        bench::report(label + ": layout, serial", serial, "ms");
+        bench::report(label + ": layout, parallel", parallel, "ms");
+        bench::report(label + ": re-layout at 300 px, parallel", narrow, "ms");
+        bench::report(label + ": serial throughput", static_cast<double>(page.text.size()) / (1 << 20) / (serial / 1000.0), "MB/s");
+    }
+}
@@ -0,0 +1,98 @@
+#include "bench.h"
+#include "core/charset.h"
+#include "core/html_parser.h"
+#include "core/local_file.h"
+#include "core/mapped_file.h"
+#include "core/text_layout.h"
+
+#include <filesystem>
+#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string>
+
+namespace {
+
+// The browser's parse budget: larger documents are shown truncated
+constexpr std::chrono::milliseconds kParseBudget {2000};
+
+// Generated report of roughly `mb` megabytes, written in 1 MB blocks
+std::filesystem::path make_report_file(long mb) {
+    std::string block;
+    for (int row = 0; block.size() < (1u << 20); ++row) {
+        const std::string n = std::to_string(row);
+        block += "<div><p>2025-01-01 12:00:00 INFO worker-" + n + " processed batch &amp; flushed <b>" + n +
+                 "</b> records</p><a href=\"logs/" + n + ".html\">details " + n + "</a></div>\n";
+    }
+    auto path = std::filesystem::temp_directory_path() / ("mini-browser-bench-" + std::to_string(mb) + "mb.html");
+    std::ofstream out(path, std::ios::binary);
+    out << "<html><head><title>Report</title></head><body>\n";
+    for (long i = 0; i < mb; ++i) out << block;
+    out << "</body></html>";
+    return path;
+}
+
+struct Painted {
+    std::size_t textBytes = 0;
+    bool truncated = false;
+};
+
+// What happens between opening a page and its first frame: decode check, parse, lay out the text
+Painted first_paint(std::string_view body, const Url& url) {
+    static FixedGlyphMetrics metrics(7.f, 17.f);
+    if (!is_valid_utf8(body)) return {};
+    ParsedPage page = parse_html_basic(body, ParseOptions{kParseBudget, 0});
+    resolve_links(page.links, url);
+    TextLayout layout = layout_text(page.text, page.links, metrics, LayoutOptions{780.f, 0});
+    return {page.text.size(), page.truncated};
+}
+
+}
+
+// Local documents from 1 MB to 1 GB: read into a string (the network model) vs load_local_file, to first paint
+BENCH(bench_local_file_first_paint) {
+    const long maxMb = bench::env_or("BENCH_MAX_MB", 1024);
+    for (long mb : {1L, 10L, 100L, 1024L}) {
+        if (mb > maxMb) break;
+        const auto path = make_report_file(mb);
+        const Url url = *Url::fromFilePath(path.string());
+        const std::string label = std::to_string(mb) + " MB file, ";
+
+        Painted painted;
+        double ms = 0;
+        bench::Memory grown = bench::peak_memory_growth([&] {
+            ms = bench::time_ms([&] {
+                std::ifstream in(path, std::ios::binary);
+                std::string body(std::filesystem::file_size(path), '\0');
+                in.read(body.data(), static_cast<std::streamsize>(body.size()));
+                painted = first_paint(body, url);
+            }, 1);
+        });
+        bench::report(label + "read into string: first paint", ms, "ms");
+        bench::report("  peak RSS growth", static_cast<double>(grown.rssKb) / 1024.0, "MB");
+        bench::report("  peak heap growth", static_cast<double>(grown.anonKb) / 1024.0, "MB");
+
+        grown = bench::peak_memory_growth([&] {
+            ms = bench::time_ms([&] {
+                HttpResult r = load_local_file(url);
+                painted = first_paint(r.bodyView(), url);
+            }, 1);
+        });
+        bench::report(label + "load_local_file: first paint", ms, "ms");
+        bench::report("  peak RSS growth", static_cast<double>(grown.rssKb) / 1024.0, "MB");
+        bench::report("  peak heap growth", static_cast<double>(grown.anonKb) / 1024.0, "MB");
+        bench::report(std::string("  text shown") + (painted.truncated ? " (parse budget hit)" : ""),
+                      static_cast<double>(painted.textBytes) / 1048576.0, "MB");
+
+        // What a snapshot of the whole file costs: load_local_file copies only up to kSnapshotLimit
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        ms = bench::time_ms([&] {
+            MappedFile copy;
+            copy.openSnapshot(fd);
+        }, 1);
+        ::close(fd);
+        bench::report("  copy to $TMPDIR for a snapshot", ms, "ms");
+
+        std::filesystem::remove(path);
+    }
+}
@@ -0,0 +1,14 @@
+#include "bench.h"
+
+#include <cstring>
+
+// Usage: bench [name-substring]
+int main(int argc, char** argv) {
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+    for (const auto& c : bench::registry()) {
+        if (filter && !std::strstr(c.name, filter)) continue;
+        std::cout << "Running " << c.name << "...\n";
+        c.fn();
+    }
+    return 0;
+}
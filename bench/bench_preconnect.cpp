@@ -0,0 +1,49 @@
+#include "bench.h"
+#include "local_server.h"
+#include "core/connection_pool.h"
+#include "core/http_client.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+BENCH(bench_click_to_first_byte) {
+    const auto handshake = std::chrono::milliseconds(bench::env_or("BENCH_HANDSHAKE_MS", 80));
+    const int rounds = static_cast<int>(bench::env_or("BENCH_PRECONNECT_ROUNDS", 10));
+    LocalServer server([](const LocalServer::Request&) { return LocalServer::Response{200, "<p>ok</p>"}; },
+                       handshake);
+    const std::string url = server.url() + "/article";
+
+    auto click_ms = [&](ConnectionPool& pool) {
+        auto start = std::chrono::steady_clock::now();
+        http_get(url, 10000, &pool);
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    double cold = 0, hovered = 0, early = 0;
+    for (int i = 0; i < rounds; ++i) {
+        {
+            ConnectionPool pool;
+            cold += click_ms(pool);
+        }
+        {
+            // Hover long enough for the warm-up to finish before the click
+            ConnectionPool pool;
+            pool.preconnect(url);
+            pool.waitForWarmups();
+            hovered += click_ms(pool);
+        }
+        {
+            // Click halfway through the handshake: the fetch joins the warm-up
+            ConnectionPool pool;
+            pool.preconnect(url);
+            std::this_thread::sleep_for(handshake / 2);
+            early += click_ms(pool);
+        }
+    }
+
+    std::string suffix = " (handshake " + std::to_string(handshake.count()) + " ms)";
+    bench::report("click, no preconnect" + suffix, cold / rounds, "ms");
+    bench::report("click after hover warm-up" + suffix, hovered / rounds, "ms");
+    bench::report("click mid warm-up" + suffix, early / rounds, "ms");
+}
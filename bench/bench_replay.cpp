@@ -0,0 +1,76 @@
+#include "bench.h"
+#include "local_server.h"
+#include "core/charset.h"
+#include "core/html_parser.h"
+#include "core/http_archive.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+
+namespace {
+
+// Fetch and parse every archived URL in recording order, the way the browser would
+std::size_t load_all(const HttpArchive& archive) {
+    std::size_t bytes = 0;
+    for (const ArchiveEntry& e : archive.entries()) {
+        HttpResult r = http_get(e.url);
+        if (!r.error.empty()) continue;
+        std::string_view body = r.bodyView();
+        Charset charset = detect_charset(r.content_type, body);
+        std::string decoded;
+        if (charset != Charset::Utf8 || !is_valid_utf8(body)) {
+            decoded = to_utf8(body, charset);
+            body = decoded;
+        }
+        ParsedPage page = parse_html_basic(body);
+        bytes += r.bodyView().size() + page.text.size();
+    }
+    return bytes;
+}
+
+}
+
+// Replays BENCH_ARCHIVE (e.g. recorded with `bin/main --record`) if set, otherwise records a generated site first
+BENCH(bench_replay_archive) {
+    std::string path;
+    if (const char* env = std::getenv("BENCH_ARCHIVE")) path = env;
+    if (path.empty()) {
+        path = (std::filesystem::temp_directory_path() / "mini-browser-bench-replay.mbha").string();
+        const long pages = bench::env_or("BENCH_REPLAY_PAGES", 200);
+        LocalServer server([](const LocalServer::Request& req) {
+            std::string html = "<html><head><title>" + req.path + "</title></head><body>";
+            for (int i = 0; html.size() < 40000; ++i) {
+                html += "<p>Paragraph " + std::to_string(i) + " of " + req.path + " with <a href=\"/page/"
+                      + std::to_string(i) + "\">a link</a> and some &amp; entities.</p>\n";
+            }
+            return LocalServer::Response{200, html + "</body></html>"};
+        });
+        http_record_start();
+        double live = bench::time_ms([&] {
+            for (long i = 0; i < pages; ++i) http_get(server.url() + "/page/" + std::to_string(i));
+        }, 1);
+        http_record_stop(path);
+        bench::report("recorded " + std::to_string(pages) + " loopback pages", live, "ms");
+    }
+
+    HttpArchive archive;
+    if (!archive.load(path)) {
+        std::cerr << "  cannot load archive " << path << "\n";
+        return;
+    }
+    double recordedMs = 0;
+    std::size_t bodyBytes = 0;
+    for (const ArchiveEntry& e : archive.entries()) {
+        recordedMs += static_cast<double>(e.totalUs) / 1000.0;
+        bodyBytes += e.body.size();
+    }
+    bench::report("archive entries", static_cast<double>(archive.size()), "");
+    bench::report("archive body size", static_cast<double>(bodyBytes) / (1 << 20), "MB");
+    bench::report("recorded network time (sum)", recordedMs, "ms");
+
+    http_replay_start(path, 0.0);
+    double replay = bench::time_ms([&] { load_all(archive); });
+    http_replay_stop();
+    bench::report("replay fetch + parse, no delays", replay, "ms");
+}
@@ -0,0 +1,60 @@
+#include "bench.h"
+#include "core/search_index.h"
+
+#include <filesystem>
+#include <cmath>
+#include <random>
+#include <string>
+
+BENCH(bench_index_query_latency) {
+    const long docs = bench::env_or("BENCH_INDEX_DOCS", 100000);
+    const std::string dir = (std::filesystem::temp_directory_path() / "mini-browser-bench-index").string();
+    std::filesystem::remove_all(dir);
+
+    // Zipf-ish vocabulary so common and rare terms both occur
+    std::mt19937 rng(42);
+    std::vector<std::string> vocab;
+    for (int i = 0; i < 50000; ++i) {
+        std::string w;
+        for (int k = 0, len = 3 + static_cast<int>(rng() % 7); k < len; ++k) w.push_back(static_cast<char>('a' + rng() % 26));
+        vocab.push_back(w);
+    }
+    auto word = [&] {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        return vocab[static_cast<std::size_t>(std::pow(u, 3.0) * (vocab.size() - 1))];
+    };
+
+    double build = bench::time_ms([&] {
+        IndexWriter writer;
+        std::string text;
+        for (long d = 0; d < docs; ++d) {
+            text.clear();
+            for (int w = 0; w < 150; ++w) { text += word(); text += ' '; }
+            writer.add("https://docs.test/page/" + std::to_string(d), word() + " " + word(), text);
+            if (writer.pending() == 10000) writer.flush(dir);
+        }
+        writer.flush(dir);
+        compact_index(dir);
+    }, 1);
+
+    IndexReader reader(dir);
+    std::uintmax_t bytes = 0;
+    for (const auto& e : std::filesystem::directory_iterator(dir)) bytes += e.file_size();
+    bench::report(std::to_string(reader.documentCount()) + " docs indexed + compacted", build / 1000.0, "s");
+    bench::report("index size", bytes / 1048576.0, "MB");
+
+    for (int termsPerQuery : {1, 2, 3}) {
+        std::vector<std::string> queries;
+        for (int q = 0; q < 200; ++q) {
+            std::string query;
+            for (int t = 0; t < termsPerQuery; ++t) query += word() + " ";
+            queries.push_back(query);
+        }
+        std::size_t hits = 0;
+        double ms = bench::time_ms([&] {
+            for (const auto& q : queries) hits += reader.search(q, 20).size();
+        }, 1);
+        bench::report(std::to_string(termsPerQuery) + "-term query latency (mean)", ms * 1000.0 / queries.size(), "us");
+    }
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,46 @@
+#include "bench.h"
+#include "core/html_parser.h"
+#include "core/session_snapshot.h"
+
+#include <filesystem>
+#include <string>
+
+BENCH(bench_session_snapshot) {
+    const long maxMb = bench::env_or("BENCH_SESSION_MB", 32);
+    const std::string path = (std::filesystem::temp_directory_path() / "mini-browser-bench-session.mbs").string();
+
+    for (long mb = 1; mb <= maxMb; mb *= 4) {
+        // Article-like page: paragraphs with a link every few sentences, some targets repeated
+        std::string html = "<html><head><title>Large page</title></head><body>";
+        for (long i = 0; html.size() < static_cast<std::size_t>(mb) << 20; ++i) {
+            html += "<p>Paragraph " + std::to_string(i) + " talks about things at some length, ";
+            html += "then points to <a href=\"https://example.com/article/" + std::to_string(i % 500) + "\">a related article</a> ";
+            html += "and continues with more plain text so that links stay a minority of the page.</p>\n";
+        }
+
+        SessionState state;
+        state.url = "https://example.com/large";
+        state.status = 200;
+        double parse = bench::time_ms([&] { state.page = parse_html_basic(html); }, 1);
+        state.scrollAnchor = state.page.text.size() / 2;
+        for (int i = 0; i < 50; ++i) state.history.push_back("https://example.com/visited/" + std::to_string(i));
+
+        double write = bench::time_ms([&] { save_session(path, state); });
+        SessionSnapshot snap;
+        double map = bench::time_ms([&] { snap.open(path); });
+        ParsedPage restored;
+        double restore = bench::time_ms([&] {
+            snap.open(path);
+            restored = snap.page();
+        });
+
+        const std::string label = std::to_string(mb) + " MB page";
+        bench::report(label + ": links", static_cast<double>(state.page.links.size()), "");
+        bench::report(label + ": parse from HTML", parse, "ms");
+        bench::report(label + ": snapshot write", write, "ms");
+        bench::report(label + ": snapshot map + validate", map, "ms");
+        bench::report(label + ": restore (map + copy page)", restore, "ms");
+        bench::report(label + ": snapshot size", snap.size() / 1048576.0, "MB");
+    }
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,20 @@
+#include "bench.h"
+#include "core/text_search.h"
+
+#include <string>
+
+BENCH(bench_find_throughput) {
+    std::size_t mb = static_cast<std::size_t>(bench::env_or("BENCH_FIND_MB", 256));
+    std::string text;
+    text.reserve(mb << 20);
+    const char* words[] = {"The ", "quick ", "brown ", "fox ", "jumps ", "over ", "the ", "lazy ", "dog. ",
+                           "Layout ", "renders ", "lines ", "of ", "Text\n"};
+    for (std::size_t i = 0; text.size() < (mb << 20); ++i) text += words[(i * 5) % 14];
+
+    for (const char* needle : {"performance", "LAZY DOG", "fox", "q"}) {
+        std::size_t found = 0;
+        double ms = bench::time_ms([&]{ found = find_all_ci(text, needle).size(); });
+        bench::report(std::string("find_all_ci \"") + needle + "\" (" + std::to_string(found) + " hits)",
+                      text.size() / 1e9 / (ms / 1000.0), "GB/s");
+    }
+}
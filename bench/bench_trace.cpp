@@ -0,0 +1,49 @@
+#include "bench.h"
+#include "core/html_parser.h"
+#include "core/trace.h"
+
+#include <string>
+
+namespace {
+
+volatile unsigned long sink = 0;
+
+void traced_loop(long n) {
+    for (long i = 0; i < n; ++i) {
+        TRACE_SCOPE("bench", "span");
+        sink = sink + 1;
+    }
+}
+
+}
+
+BENCH(bench_trace_overhead) {
+    // Per-span cost; stays under the per-thread event cap so every span is recorded
+    const long spans = 500000;
+    trace_stop();
+    double off = bench::time_ms([&] { traced_loop(spans); });
+    trace_start();
+    double on = bench::time_ms([&] { trace_clear(); traced_loop(spans); });
+    trace_stop();
+    trace_clear();
+    bench::report("scope cost, tracing off", off * 1e6 / spans, "ns");
+    bench::report("scope cost, tracing on", on * 1e6 / spans, "ns");
+
+    // End-to-end: an instrumented parse with tracing off vs on
+    const long mb = bench::env_or("BENCH_TRACE_MB", 8);
+    std::string html = "<html><head><title>Trace</title></head><body>";
+    for (long i = 0; html.size() < static_cast<std::size_t>(mb) << 20; ++i) {
+        html += "<p>Paragraph " + std::to_string(i) + " with <a href=\"/l" + std::to_string(i) + "\">a link</a> and text.</p>\n";
+    }
+    for (std::size_t threads : {std::size_t(1), std::size_t(0)}) {
+        ParseOptions options{std::chrono::milliseconds(0), threads};
+        const std::string label = std::to_string(mb) + " MB parse, " + (threads == 1 ? "serial" : "parallel");
+        double parseOff = bench::time_ms([&] { parse_html_basic(html, options); });
+        trace_start();
+        double parseOn = bench::time_ms([&] { parse_html_basic(html, options); });
+        trace_stop();
+        trace_clear();
+        bench::report(label + ", tracing off", parseOff, "ms");
+        bench::report(label + ", tracing on", parseOn, "ms");
+    }
+}
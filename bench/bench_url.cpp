@@ -0,0 +1,33 @@
+#include "bench.h"
+#include "core/html_parser.h"
+#include "core/url.h"
+
+#include <string>
+
+BENCH(bench_url_resolve_links) {
+    const long count = bench::env_or("BENCH_URL_LINKS", 200000);
+
+    // A link-dense page mixing the reference forms real sites use
+    const char* refs[] = {"../docs/intro.html", "/search?q=mini+browser", "#section-3", "?page=2",
+                          "//cdn.example.net/app.js", "https://other.example.org/a/b/../c", "img/logo.png",
+                          "./guide/./setup/", "mailto:team@example.com", "../../../up"};
+    std::vector<Link> links;
+    links.reserve(static_cast<std::size_t>(count));
+    for (long i = 0; i < count; ++i) links.push_back(Link{"link", refs[i % 10], 0, 0});
+
+    auto base = Url::parse("https://www.example.com/articles/2024/performance/index.html?ref=home");
+    std::vector<Link> work;
+    double ms = bench::time_ms([&] {
+        work = links;
+        resolve_links(work, *base);
+    });
+    bench::report("resolve_links (" + std::to_string(count) + " links)", count / (ms / 1000.0) / 1e6, "M links/s");
+
+    ms = bench::time_ms([&] {
+        for (const auto& link : work) {
+            auto u = Url::parse(link.url);
+            if (!u) continue;
+        }
+    });
+    bench::report("Url::parse (absolute)", count / (ms / 1000.0) / 1e6, "M urls/s");
+}
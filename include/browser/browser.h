@@ -4,6 +4,23 @@
 #include "ui/window.h"
 #include "ui/searchbar.h"
 #include "ui/content_view.h"
+#include "core/alloc_tracker.h"
+#include "core/connection_pool.h"
+#include "core/executor.h"
+#include "core/fetch_scheduler.h"
+#include "core/http_client.h"
+#include "core/page_daemon.h"
+#include "core/search_index.h"
+#include "core/session_snapshot.h"
+#include "core/thread_pool.h"
+#include "core/url.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <optional>
+#include <vector>
 
 /**
  * @class Browser
@@ -14,24 +31,173 @@
  */
 class Browser {
     private:
+        std::chrono::steady_clock::time_point startedAt = std::chrono::steady_clock::now();
         Window window;
         SearchBar searchBar;
         ContentView content;
         std::string url;
+        std::optional<Url> pageUrl;   ///< Base for resolving links on the current page
+        bool showingHistory = false;  ///< History search results are on screen instead of a page
+        std::size_t pageAnchor = 0;   ///< The page's scroll anchor, kept while history results cover it
         bool loading = false;
         long status = 0;
         std::string html;
+        ParsedPage page;                            ///< Page on screen, kept for the session snapshot
+        /// page.text, moved out when shown: the one copy, shared by the content view, find and history
+        std::shared_ptr<const std::string> pageText;
+        std::vector<std::string> sessionHistory;    ///< URLs shown this session, oldest first
         std::string lastError;
+        std::unique_ptr<SearchIndex> historyIndex;   ///< Opened in the background after the first frame
+        std::future<std::unique_ptr<SearchIndex>> historyIndexLoading;
+        bool firstFrameShown = false;
+        bool interactive = false;
+        ConnectionPool connections;   ///< Warm connections from link hovers and past fetches
+
+        FetchScheduler fetches {FetchScheduler::kMaxActive, FetchScheduler::kMaxPerHost, &connections};
+
+        /// Socket of a shared page daemon (MINI_BROWSER_DAEMON); empty fetches in-process
+        std::string daemonSocket;
+        ThreadPool daemonRequests {2};   ///< Blocking PageClient calls, off the UI thread
+
+        /// Results handed back from fetch threads and the executor; drained once per frame
+        std::shared_ptr<MainThreadQueue> mainQueue = std::make_shared<MainThreadQueue>();
+
+        /// A queued or running navigation fetch
+        struct Fetch {
+            Url target;
+            std::shared_ptr<std::atomic<bool>> cancel;
+            std::uint64_t id;   ///< Results of older navigations are dropped
+        };
+        std::optional<Fetch> pending;     ///< Navigation whose page will be shown
+        std::uint64_t lastNavigation = 0;
+
+        // Allocation accounting (builds with ALLOC_TRACKING=1 only)
+        AllocSnapshot navigationAllocs;          ///< Counters when the current navigation started
+        std::uint64_t lastFrameDrawAllocs = 0;   ///< Draw-phase allocations up to the previous frame
+        std::size_t framesSinceReport = 0;
+        std::size_t allocatingFrames = 0;        ///< Of those, frames whose draw allocated
+
+        /**
+         * @brief Print what the finished navigation allocated, by phase
+         *
+         * Covers everything from navigate() until the page is on screen,
+         * plus how many frames drawn since the previous report allocated
+         * (steady frames should not). No-op without allocation tracking.
+         */
+        void reportAllocations();
+
+        /**
+         * @brief History index, waiting for the background open if needed
+         */
+        SearchIndex& history();
+
+        /**
+         * @brief Per-frame hook: starts deferred initialization after the
+         *        first frame, reports startup timings and runs the tasks
+         *        posted to the main-thread queue (e.g. showing a finished
+         *        navigation)
+         *
+         * Prints time-to-first-frame and time-to-interactive (history index
+         * open and libcurl initialized) to stdout.
+         */
+        void onFrame();
+
+        /**
+         * @brief Show ranked full-text results from the history index
+         *
+         * Triggered by submitting "?query" in the search bar. Each hit is
+         * rendered as a clickable title followed by its URL.
+         *
+         * @param query Keywords to search for
+         */
+        void showHistorySearch(const std::string& query);
+
+        /**
+         * @brief Start fetching a page in the background
+         *
+         * Cancels the navigation still in flight, if any. When the fetch
+         * completes the page is decoded and parsed on the shared Executor,
+         * then shown on the UI thread by onFrame(). file: URLs skip the fetch:
+         * the file is mapped and parsed in place on the Executor. With a page
+         * daemon running the page is requested from it, already parsed; if
+         * the daemon cannot be reached the page is fetched in-process.
+         *
+         * @param target Absolute URL to load
+         */
+        void navigate(const Url& target);
+
+        /**
+         * @brief Cancel the pending navigation without waiting for it
+         */
+        void cancelNavigation();
+
+        /// A fetched page decoded and parsed off the UI thread
+        struct LoadedPage {
+            HttpResult response;   ///< body holds the page decoded to UTF-8, unless it is still mapped
+            ParsedPage page;
+            std::optional<Url> pageUrl;
+            const char* charset = "";
+        };
+
+        /**
+         * @brief Decode and parse a fetched page (runs on the Executor)
+         *
+         * The page's links are resolved against its final (post-redirect)
+         * URL in one batch, so clicks need no further URL work.
+         */
+        static LoadedPage loadPage(const Url& target, HttpResult r);
+
+        /**
+         * @brief Display a page loaded by loadPage()
+         */
+        void showPage(LoadedPage loaded);
+
+        /**
+         * @brief Display a page the daemon fetched and parsed (links already resolved)
+         */
+        void showDaemonPage(const Url& target, DaemonPage r);
+
+        /// Navigation `id` is still the one the user is waiting for
+        bool isPending(std::uint64_t id) const { return pending && pending->id == id; }
+
+        /**
+         * @brief Status line, content view, history and session updates shared by both paths
+         *
+         * Shows lastError if set, otherwise page at pageUrl.
+         */
+        void displayPage();
+
+        /**
+         * @brief Show the page saved by the last session, before the first frame
+         *
+         * The snapshot is memory-mapped and displayed as is: no fetch, no parse.
+         */
+        void restoreSession();
+
+        /**
+         * @brief Snapshot the current page, scroll position and history
+         */
+        void saveSession();
 
     public:
         /**
          * @brief Construct a new Browser instance
          */
         Browser();
+
+        /**
+         * @brief Abort every outstanding fetch and warm-up
+         *
+         * Done by destroying the fetch scheduler and connection pool, which
+         * returns within one fetch poll interval; nothing is waited out.
+         */
+        ~Browser();
         
         /**
          * @brief Run the browser application
          * 
+         * Saves the session when the window is closed.
+         * 
          * @note Call this method only once per Browser instance
          */
         void run();
@@ -46,7 +212,9 @@ class Browser {
         /**
          * @brief Get the raw HTML body of the current page
          * 
-         * @return const std::string& Reference to the HTML source
+         * @return const std::string& Reference to the HTML source (empty for
+         *         pages served by the page daemon, which sends only the parse,
+         *         and for local files and spooled responses, parsed from a mapping)
          */
         const std::string& getBody() const;
         
@@ -0,0 +1,122 @@
+#ifndef ALLOC_TRACKER_H
+#define ALLOC_TRACKER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * Heap allocation accounting by load phase.
+ *
+ * Built with -DMINI_BROWSER_ALLOC_TRACKING (`make ALLOC_TRACKING=1`; the test
+ * binary always is), the global operator new/delete are replaced by hooks
+ * that count allocations, bytes and live bytes against the calling thread's
+ * current phase. A block is credited back to the phase that allocated it
+ * when freed, whichever thread frees it.
+ *
+ * Without the flag nothing is counted: AllocPhaseScope only sets a
+ * thread-local and every counter reads zero.
+ */
+
+/**
+ * @enum AllocPhase
+ * @brief What a thread is doing, for attributing its allocations
+ */
+enum class AllocPhase : std::uint8_t {
+    Other,      ///< Anything outside a phase scope
+    Fetch,      ///< HTTP transfers
+    Decode,     ///< Charset detection and transcoding
+    Parse,      ///< HTML tokenizing
+    Links,      ///< Resolving link URLs
+    Layout,     ///< Text decoding for display and line breaking
+    Draw,       ///< Painting a frame
+};
+
+inline constexpr std::size_t kAllocPhaseCount = 7;
+
+/**
+ * @brief Lowercase phase name for reports ("parse")
+ */
+const char* alloc_phase_name(AllocPhase phase);
+
+/**
+ * @struct AllocCounters
+ * @brief Totals for one phase since the process started
+ */
+struct AllocCounters {
+    std::uint64_t allocations = 0;
+    std::uint64_t frees = 0;
+    std::uint64_t bytes = 0;           ///< Requested bytes allocated
+    std::uint64_t liveBytes = 0;       ///< Allocated by the phase and not yet freed
+    std::uint64_t peakLiveBytes = 0;   ///< Highest liveBytes since alloc_reset_peaks()
+};
+
+/**
+ * @struct AllocSnapshot
+ * @brief Counters of every phase at one moment
+ */
+struct AllocSnapshot {
+    std::array<AllocCounters, kAllocPhaseCount> phases {};
+
+    const AllocCounters& operator[](AllocPhase phase) const { return phases[static_cast<std::size_t>(phase)]; }
+};
+
+/**
+ * @brief Whether this binary was built with the counting hooks
+ */
+bool alloc_tracking_enabled();
+
+/**
+ * @brief Read every phase's counters
+ *
+ * Counters are updated with relaxed atomics, so a snapshot taken while other
+ * threads allocate is approximate; on a quiet process it is exact.
+ */
+AllocSnapshot alloc_snapshot();
+
+/**
+ * @brief Restart peak tracking from the current live bytes of every phase
+ */
+void alloc_reset_peaks();
+
+namespace alloc_detail {
+inline thread_local AllocPhase phase = AllocPhase::Other;
+}
+
+/**
+ * @brief The calling thread's current phase
+ */
+inline AllocPhase alloc_current_phase() {
+    return alloc_detail::phase;
+}
+
+/**
+ * @brief Per-phase table of what happened between two snapshots
+ *
+ * Lists allocations, bytes and peak live growth (peak in `after` above live
+ * bytes in `before`; take `before` right after alloc_reset_peaks()) for each
+ * phase that allocated.
+ */
+std::string alloc_report(const AllocSnapshot& before, const AllocSnapshot& after);
+
+/**
+ * @class AllocPhaseScope
+ * @brief Attributes the calling thread's allocations to a phase until the scope ends
+ *
+ * Scopes nest; the previous phase is restored on exit. Work handed to other
+ * threads needs a scope of its own there.
+ */
+class AllocPhaseScope {
+public:
+    explicit AllocPhaseScope(AllocPhase phase) : previous_(alloc_detail::phase) { alloc_detail::phase = phase; }
+    ~AllocPhaseScope() { alloc_detail::phase = previous_; }
+
+    AllocPhaseScope(const AllocPhaseScope&) = delete;
+    AllocPhaseScope& operator=(const AllocPhaseScope&) = delete;
+
+private:
+    AllocPhase previous_;
+};
+
+#endif
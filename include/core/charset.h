@@ -0,0 +1,99 @@
+#ifndef CHARSET_H
+#define CHARSET_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/**
+ * @enum Charset
+ * @brief Character encodings a page body can be decoded from
+ *
+ * Following the WHATWG Encoding Standard, "iso-8859-1" and "us-ascii" labels
+ * map to windows-1252.
+ */
+enum class Charset {
+    Unknown,
+    Utf8,
+    Windows1252,
+    Utf16Le,
+    Utf16Be,
+};
+
+/**
+ * @brief Map an encoding label such as "UTF-8" or "latin1" to a Charset
+ *
+ * @return Charset::Unknown for unsupported labels
+ */
+Charset charset_from_label(std::string_view label);
+
+/**
+ * @brief Canonical name of a charset ("utf-8", "windows-1252", ...)
+ */
+const char* charset_name(Charset charset);
+
+/**
+ * @brief Determine the encoding of an HTML body
+ *
+ * Checks, in order: a byte order mark, the charset parameter of the
+ * Content-Type header, a <meta charset> or <meta http-equiv> declaration in
+ * the first 1024 bytes, and finally whether the body is valid UTF-8
+ * (windows-1252 otherwise).
+ *
+ * @param contentType Content-Type header value (may be empty)
+ * @param body Raw response body
+ * @return Detected charset, never Charset::Unknown
+ */
+Charset detect_charset(std::string_view contentType, std::string_view body);
+
+/**
+ * @brief Length of the longest prefix that is well-formed UTF-8
+ *
+ * Rejects overlong forms, surrogates and code points above U+10FFFF. ASCII
+ * runs are checked 32 bytes at a time.
+ */
+std::size_t valid_utf8_prefix(std::string_view text);
+
+/**
+ * @brief Check that text is entirely well-formed UTF-8
+ */
+inline bool is_valid_utf8(std::string_view text) {
+    return valid_utf8_prefix(text) == text.size();
+}
+
+/**
+ * @brief Drop a leading UTF-8 byte order mark
+ *
+ * For bodies that are already valid UTF-8 and used without to_utf8(), so
+ * U+FEFF does not end up in the page text.
+ */
+inline std::string_view strip_utf8_bom(std::string_view text) {
+    return text.starts_with("\xEF\xBB\xBF") ? text.substr(3) : text;
+}
+
+/**
+ * @brief Transcode a body to UTF-8
+ *
+ * A leading byte order mark is dropped and malformed input is replaced with
+ * U+FFFD, so the result is always valid UTF-8.
+ *
+ * @param body Raw bytes
+ * @param charset Encoding of body (Unknown is treated as UTF-8)
+ * @return UTF-8 text
+ */
+std::string to_utf8(std::string_view body, Charset charset);
+
+/**
+ * @brief Decode the code point starting at a byte offset
+ *
+ * For walking UTF-8 text a code point at a time without a decoded copy. A
+ * malformed sequence decodes to U+FFFD and consumes one byte.
+ *
+ * @param text UTF-8 text
+ * @param i Byte offset of the code point
+ * @param cp Receives the code point
+ * @return Bytes consumed (1 to 4), or 0 at the end of the text
+ */
+std::size_t decode_utf8(std::string_view text, std::size_t i, char32_t& cp);
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef CONNECTION_POOL_H
+#define CONNECTION_POOL_H
+
+#include "core/curl_session.h"
+#include "core/url.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @class ConnectionPool
+ * @brief Warm curl sessions kept per origin for reuse by http_get
+ *
+ * A CurlSession keeps its DNS cache and live connections across reset(),
+ * so parking a session after a transfer keeps the connection to that
+ * origin open. preconnect() warms a handle ahead of time on a background
+ * thread with a HEAD request for the origin's root (DNS + TCP/TLS, no body);
+ * the hovered URL's path and query are never sent.
+ * At most maxIdle handles are kept; handles idle longer than idleTimeout are
+ * closed. The background thread starts on first use, so an unused pool
+ * costs nothing at startup.
+ */
+class ConnectionPool {
+public:
+    /**
+     * @param maxIdle Warm handles kept at once (oldest is closed first)
+     * @param idleTimeout How long an unused handle is kept
+     */
+    explicit ConnectionPool(std::size_t maxIdle = kMaxIdle,
+                            std::chrono::milliseconds idleTimeout = kIdleTimeout);
+
+    /**
+     * @brief Close every pooled connection and stop the warm-up thread
+     *
+     * A warm-up still in flight is cancelled, not waited for.
+     */
+    ~ConnectionPool();
+
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+    /**
+     * @brief Warm a connection to a URL's origin in the background
+     *
+     * Does nothing for non-http(s) URLs or when the origin already has a
+     * warm or warming handle. Returns immediately.
+     *
+     * @param url Absolute URL the user is likely to open next
+     */
+    void preconnect(const std::string& url);
+
+    /**
+     * @brief Take a warm handle for an origin
+     *
+     * If the origin's warm-up is running, waits up to kWarmupWait for it: its
+     * handshake is already further along than a new one would be. A warm-up
+     * that is only queued is dropped instead, the caller connects itself.
+     *
+     * @param origin Origin about to be fetched
+     * @param cancel Optional flag; the wait ends within
+     *        CurlSession::kPollInterval once it is set
+     * @param timeout Upper bound on the wait (the caller's request timeout)
+     * @return Session (reset, connections intact), or a closed session if
+     *         none is pooled or the wait was cancelled
+     */
+    CurlSession acquire(Origin origin, const std::atomic<bool>* cancel = nullptr,
+                        std::chrono::milliseconds timeout = kWarmupWait);
+
+    /**
+     * @brief Return a session after a successful transfer to an origin
+     */
+    void release(Origin origin, CurlSession session);
+
+    /**
+     * @brief Block until every queued or running warm-up has finished
+     */
+    void waitForWarmups();
+
+    /// Handles currently parked in the pool
+    std::size_t idleCount() const;
+
+    std::chrono::milliseconds idleTimeout() const { return idleTimeout_; }
+
+    static constexpr std::size_t kMaxIdle = 6;
+    static constexpr std::chrono::milliseconds kIdleTimeout {30000};
+
+    /// Longest acquire() waits for a running warm-up before connecting anew
+    static constexpr std::chrono::milliseconds kWarmupWait {500};
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Idle {
+        Origin origin;
+        CurlSession session;
+        Clock::time_point since;
+    };
+
+    void workerLoop();
+    void startWorkerLocked();
+
+    /// Remove expired and over-cap sessions; caller closes them outside the lock
+    void evictLocked(std::size_t reserve, std::vector<CurlSession>& closing);
+
+    const std::size_t maxIdle_;
+    const std::chrono::milliseconds idleTimeout_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;          ///< Wakes the worker
+    std::condition_variable warmed_;      ///< Signals finished warm-ups
+    std::vector<Idle> idle_;              ///< Oldest first
+    std::deque<Origin> queue_;
+    std::unordered_set<Origin> warming_;  ///< Queued or running
+    Origin running_;                      ///< Warm-up in progress (opaque when none)
+    bool stopping_ = false;
+    std::atomic<bool> cancelWarmup_ {false};  ///< Aborts a running warm-up on shutdown
+    std::thread worker_;
+};
+
+#endif
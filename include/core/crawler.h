@@ -0,0 +1,112 @@
+#ifndef CRAWLER_H
+#define CRAWLER_H
+
+#include "core/html_parser.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @class VisitedSet
+ * @brief Compact set of URLs seen by a crawl, stored as 64-bit fingerprints
+ *
+ * Open addressing over a flat array of hashes (8 bytes per slot, at most
+ * half full), so memory stays near 16 bytes per URL however long the URLs
+ * are. Two URLs share a fingerprint with probability ~n^2 / 2^65, which
+ * for a crawl of millions of pages is negligible.
+ */
+class VisitedSet {
+public:
+    explicit VisitedSet(std::size_t expected = 1024);
+
+    /**
+     * @brief Add a key
+     *
+     * @return true if it was not in the set yet
+     */
+    bool insert(std::string_view key);
+
+    bool contains(std::string_view key) const;
+
+    std::size_t size() const { return size_; }
+
+    /// Heap bytes used by the table
+    std::size_t memoryBytes() const { return slots_.capacity() * sizeof(std::uint64_t); }
+
+private:
+    static std::uint64_t fingerprint(std::string_view key);
+    void grow();
+
+    std::vector<std::uint64_t> slots_;   ///< 0 marks an empty slot
+    std::size_t size_ = 0;
+};
+
+/**
+ * @struct CrawlOptions
+ * @brief What to crawl and how gently
+ */
+struct CrawlOptions {
+    std::vector<std::string> seeds;            ///< Start URLs (depth 0)
+    std::vector<std::string> allowedOrigins;   ///< e.g. "https://docs.example.com"; empty: the seeds' origins
+    std::size_t maxPages = 1000;               ///< Fetches attempted before the crawl stops
+    std::size_t maxDepth = 10;                 ///< Link hops from a seed
+    std::size_t concurrency = 8;               ///< Fetches in flight at once
+    std::size_t maxPerHost = 2;                ///< Fetches in flight at once to one origin
+    std::chrono::milliseconds hostDelay {0};   ///< Minimum time between two request starts to one origin
+    std::string outputDir;                     ///< Where extracted text is written; empty: nowhere
+    int timeoutMs = 10000;                     ///< Per-request timeout
+};
+
+/**
+ * @struct CrawlStats
+ * @brief Totals and resource use of a finished crawl
+ */
+struct CrawlStats {
+    std::size_t pagesFetched = 0;      ///< Fetched and parsed (status < 400)
+    std::size_t pagesFailed = 0;       ///< Network errors and error statuses
+    std::size_t bytesFetched = 0;
+    std::size_t linksSeen = 0;         ///< Links extracted from fetched pages
+    std::size_t duplicateLinks = 0;    ///< Skipped: already visited or queued
+    std::size_t offOriginLinks = 0;    ///< Skipped: outside the allowed origins or not http(s)
+    std::size_t frontierPeak = 0;      ///< Most URLs queued at once
+    std::size_t frontierPeakBytes = 0; ///< Memory of the frontier at its largest
+    std::size_t visitedCount = 0;
+    std::size_t visitedBytes = 0;      ///< Memory of the visited set
+    std::chrono::milliseconds elapsed {0};
+
+    double pagesPerSecond() const {
+        return elapsed.count() > 0 ? static_cast<double>(pagesFetched) * 1000.0 / static_cast<double>(elapsed.count()) : 0.0;
+    }
+};
+
+/**
+ * @brief Called on the crawling thread for every fetched page
+ *
+ * Receives the page's final URL, its depth and the parsed page with links
+ * resolved to absolute URLs.
+ */
+using CrawlPageCallback = std::function<void(const std::string& url, std::size_t depth, const ParsedPage& page)>;
+
+/**
+ * @brief Crawl from the seeds, following links within the allowed origins
+ *
+ * Blocks until the frontier is exhausted or maxPages fetches were made.
+ * Pages are fetched and parsed on a pool of `concurrency` threads. Each
+ * origin has its own FIFO frontier and origins take turns, so one big host
+ * cannot crowd out the others. URLs are deduplicated without their
+ * fragment. With an outputDir, every fetched page is written as
+ * `<fingerprint>.txt` (URL, title, blank line, text), and `index.tsv` lists
+ * URL, depth and file name per page.
+ *
+ * @param options Seeds, scope, limits and politeness
+ * @param onPage Optional per-page callback
+ * @return Totals, pages/sec and frontier/visited-set memory
+ */
+CrawlStats crawl(const CrawlOptions& options, const CrawlPageCallback& onPage = {});
+
+#endif
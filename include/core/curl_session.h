@@ -0,0 +1,66 @@
+#ifndef CURL_SESSION_H
+#define CURL_SESSION_H
+
+#include <curl/curl.h>
+
+#include <atomic>
+#include <chrono>
+
+/**
+ * @class CurlSession
+ * @brief A curl easy handle driven through its own multi handle
+ *
+ * The multi handle owns the connection cache, so a session that is kept
+ * (e.g. parked in a ConnectionPool) keeps its connections open across
+ * transfers. Transfers are run in a poll loop that checks a cancel flag at
+ * least every kPollInterval; a cancelled transfer is removed from the multi
+ * handle, which stops it and closes its connection.
+ */
+class CurlSession {
+public:
+    CurlSession() = default;
+    ~CurlSession();
+
+    CurlSession(CurlSession&& other) noexcept;
+    CurlSession& operator=(CurlSession&& other) noexcept;
+    CurlSession(const CurlSession&) = delete;
+    CurlSession& operator=(const CurlSession&) = delete;
+
+    /**
+     * @brief Create the easy and multi handles
+     *
+     * @return true on success
+     */
+    bool open();
+
+    bool isOpen() const { return easy_ != nullptr; }
+
+    /// Easy handle to configure with curl_easy_setopt
+    CURL* easy() const { return easy_; }
+
+    /**
+     * @brief Clear all options; DNS cache and live connections are kept
+     */
+    void reset();
+
+    /**
+     * @brief Run the configured transfer to completion or cancellation
+     *
+     * @param cancel Optional flag; once true the transfer is aborted within
+     *        one poll interval
+     * @return CURLE_OK, the transfer's error, or CURLE_ABORTED_BY_CALLBACK
+     *         when cancelled
+     */
+    CURLcode perform(const std::atomic<bool>* cancel = nullptr);
+
+    /// Longest time between two checks of the cancel flag
+    static constexpr std::chrono::milliseconds kPollInterval {50};
+
+private:
+    void close();
+
+    CURLM* multi_ = nullptr;
+    CURL* easy_ = nullptr;
+};
+
+#endif
@@ -0,0 +1,210 @@
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @enum TaskPriority
+ * @brief Scheduling class of an executor task, most urgent first
+ */
+enum class TaskPriority {
+    Interactive,   ///< The user is waiting: navigation parse, layout of the page on screen
+    Normal,
+    Background,    ///< Indexing, warm-up, anything that can wait
+};
+
+inline constexpr std::size_t kTaskPriorityCount = 3;
+
+using Task = std::move_only_function<void()>;
+
+/**
+ * @class MainThreadQueue
+ * @brief Tasks that must run on one particular thread (the UI thread), run when it drains the queue
+ *
+ * Any thread may post; only the owning thread calls drain(), typically once per frame.
+ */
+class MainThreadQueue {
+public:
+    void post(Task task);
+
+    /**
+     * @brief Run every task posted so far, in posting order
+     *
+     * Tasks posted while draining run on the next call.
+     *
+     * @return Number of tasks run
+     */
+    std::size_t drain();
+
+    std::size_t pending() const;
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<Task> tasks_;
+};
+
+/**
+ * @struct ExecutorStats
+ * @brief Counters since the executor started
+ */
+struct ExecutorStats {
+    std::size_t executed = 0;   ///< Tasks run by workers
+    std::size_t stolen = 0;     ///< Of those, taken from another worker's deque
+};
+
+/**
+ * @class Executor
+ * @brief Work-stealing pool for CPU work: parsing, layout, fetch completion, background jobs
+ *
+ * Each worker owns one deque per priority. Tasks posted from a worker go
+ * to the back of its own deque and it pops from the back (the newest task,
+ * whose data is still in cache); idle workers steal from the front of the
+ * others' deques. Tasks posted from other threads go to a shared injection
+ * queue. A worker always takes the most urgent task it can find: its own,
+ * then injected, then stolen Interactive work before any Normal work.
+ *
+ * Workers are started once and sleep when there is nothing to do, so
+ * running a task costs no thread creation. Do not block a worker on I/O;
+ * long blocking calls belong on a ThreadPool or a dedicated thread.
+ */
+class Executor {
+public:
+    /**
+     * @param threads Worker count; zero uses std::thread::hardware_concurrency()
+     */
+    explicit Executor(std::size_t threads = 0);
+
+    /**
+     * @brief Finish every queued task (including ones they post) and join the workers
+     */
+    ~Executor();
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    /**
+     * @brief Process-wide executor with one worker per hardware thread
+     */
+    static Executor& shared();
+
+    /**
+     * @brief Queue a task whose result nobody waits for
+     */
+    void post(Task task, TaskPriority priority = TaskPriority::Normal);
+
+    /**
+     * @brief Queue a task
+     *
+     * @return Future for the callable's result; dropping it does not block
+     */
+    template <class F>
+    auto submit(F&& fn, TaskPriority priority = TaskPriority::Normal) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        using R = std::invoke_result_t<std::decay_t<F>>;
+        std::packaged_task<R()> task(std::forward<F>(fn));
+        std::future<R> result = task.get_future();
+        post(std::move(task), priority);
+        return result;
+    }
+
+    /**
+     * @brief Run `fn`, then `continuation(result)` as a new task on this executor
+     *
+     * The continuation is queued by the worker that ran `fn`, on its own
+     * deque, so it usually runs next on the same core. No thread waits in between.
+     */
+    template <class F, class C>
+    void then(F&& fn, C&& continuation, TaskPriority priority = TaskPriority::Normal) {
+        post([this, fn = std::forward<F>(fn), cont = std::forward<C>(continuation), priority]() mutable {
+            post(bind_result(fn, std::move(cont)), priority);
+        }, priority);
+    }
+
+    /**
+     * @brief Run `fn` here, then `continuation(result)` on the thread draining `queue`
+     *
+     * The queue is shared so a task finishing after its owner is gone posts harmlessly.
+     */
+    template <class F, class C>
+    void then(F&& fn, std::shared_ptr<MainThreadQueue> queue, C&& continuation,
+              TaskPriority priority = TaskPriority::Normal) {
+        post([fn = std::forward<F>(fn), queue = std::move(queue), cont = std::forward<C>(continuation)]() mutable {
+            queue->post(bind_result(fn, std::move(cont)));
+        }, priority);
+    }
+
+    /**
+     * @brief Wait for a future; a worker of this executor runs other tasks meanwhile
+     *
+     * Makes nested fork/join (a parse task splitting into chunk tasks)
+     * safe on any number of workers. Other threads simply block.
+     */
+    template <class R>
+    R wait(std::future<R>& future) {
+        if (onWorker()) {
+            while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                if (!runOne()) future.wait_for(std::chrono::microseconds(50));
+            }
+        }
+        return future.get();
+    }
+
+    /**
+     * @brief Number of worker threads
+     */
+    std::size_t size() const { return workers_.size(); }
+
+    ExecutorStats stats() const;
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::array<std::deque<Task>, kTaskPriorityCount> queues;
+    };
+
+    // Call fn() now and wrap its result into a task calling cont(result)
+    template <class F, class C>
+    static Task bind_result(F& fn, C cont) {
+        if constexpr (std::is_void_v<std::invoke_result_t<F&>>) {
+            fn();
+            return [cont = std::move(cont)]() mutable { cont(); };
+        } else {
+            return [cont = std::move(cont), r = fn()]() mutable { cont(std::move(r)); };
+        }
+    }
+
+    void workerLoop(std::size_t index);
+    bool onWorker() const;
+
+    /// Pop the most urgent task visible to the current thread, if any, and run it
+    bool runOne();
+    bool take(std::size_t self, Task& task);
+
+    std::vector<std::unique_ptr<Worker>> queues_;
+    std::mutex injectMutex_;
+    std::array<std::deque<Task>, kTaskPriorityCount> injected_;
+
+    std::atomic<std::size_t> pending_ {0};   ///< Queued, not yet taken
+    std::atomic<std::size_t> sleeping_ {0};
+    std::mutex sleepMutex_;
+    std::condition_variable wake_;
+    std::atomic<bool> stopping_ {false};
+
+    std::atomic<std::size_t> executed_ {0};
+    std::atomic<std::size_t> stolen_ {0};
+    std::vector<std::thread> workers_;
+};
+
+#endif
@@ -0,0 +1,171 @@
+#ifndef FETCH_SCHEDULER_H
+#define FETCH_SCHEDULER_H
+
+#include "core/http_client.h"
+#include "core/url.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class ConnectionPool;
+
+/**
+ * @enum FetchPriority
+ * @brief Scheduling class of a fetch, most urgent first
+ */
+enum class FetchPriority {
+    Navigation,   ///< Page the user asked for
+    Visible,      ///< Work for links/content currently on screen
+    Background,   ///< Batch loads, refreshes, crawls
+};
+
+inline constexpr std::size_t kFetchPriorityCount = 3;
+
+/**
+ * @brief Short lowercase name of a priority class ("navigation", ...)
+ */
+const char* fetch_priority_name(FetchPriority priority);
+
+/**
+ * @struct FetchClassMetrics
+ * @brief Queue statistics for one priority class
+ */
+struct FetchClassMetrics {
+    std::size_t queued = 0;                    ///< Waiting right now
+    std::size_t started = 0;                   ///< Dequeued so far
+    std::chrono::microseconds totalWait {0};   ///< Sum of queue waits of started fetches
+    std::chrono::microseconds maxWait {0};
+
+    double meanWaitMs() const {
+        return started ? totalWait.count() / 1000.0 / static_cast<double>(started) : 0.0;
+    }
+};
+
+/**
+ * @struct FetchMetrics
+ * @brief Snapshot of FetchScheduler state
+ */
+struct FetchMetrics {
+    std::array<FetchClassMetrics, kFetchPriorityCount> byPriority;   ///< Indexed by FetchPriority
+    std::size_t active = 0;                                          ///< Transfers in flight
+    std::vector<std::pair<std::string, std::size_t>> activePerHost;  ///< Origin -> transfers in flight
+
+    const FetchClassMetrics& operator[](FetchPriority p) const { return byPriority[static_cast<std::size_t>(p)]; }
+};
+
+/**
+ * @class FetchScheduler
+ * @brief Runs http_get requests by priority under global and per-host limits
+ *
+ * Each priority class has its own queue; a class is served only when every
+ * more urgent queue is empty or blocked by its host limit, so a new
+ * navigation goes ahead of all queued background work at once (running
+ * transfers are not interrupted). Within a class, hosts take turns
+ * round-robin and each host's requests run in FIFO order, so one busy host
+ * cannot starve the others. Hosts are keyed by Url origin.
+ *
+ * Worker threads (one per global slot) start on first submit.
+ */
+class FetchScheduler {
+public:
+    /**
+     * @param maxActive Transfers in flight at once, across all hosts
+     * @param maxPerHost Transfers in flight at once to one origin
+     * @param pool Optional connection pool passed to every http_get
+     */
+    explicit FetchScheduler(std::size_t maxActive = kMaxActive, std::size_t maxPerHost = kMaxPerHost,
+                            ConnectionPool* pool = nullptr);
+
+    /**
+     * @brief Cancel running transfers, fail queued ones as cancelled and join
+     */
+    ~FetchScheduler();
+
+    FetchScheduler(const FetchScheduler&) = delete;
+    FetchScheduler& operator=(const FetchScheduler&) = delete;
+
+    /**
+     * @brief Queue a GET request
+     *
+     * @param url Absolute URL to fetch
+     * @param priority Scheduling class
+     * @param cancel Optional flag to abort the request, queued or running;
+     *        the result is then marked cancelled
+     * @param timeout_ms Passed to http_get
+     * @return Future for the result; dropping it does not block
+     */
+    std::future<HttpResult> submit(const std::string& url, FetchPriority priority,
+                                   std::shared_ptr<std::atomic<bool>> cancel = nullptr,
+                                   int timeout_ms = 10000);
+
+    /**
+     * @brief Queue a GET request and hand the result to a callback
+     *
+     * @param onDone Called once with the result, on a fetch worker (or on
+     *        the calling thread if the scheduler is shutting down); keep it
+     *        short, e.g. post the processing to an Executor
+     */
+    void submit(const std::string& url, FetchPriority priority, std::shared_ptr<std::atomic<bool>> cancel,
+                int timeout_ms, std::move_only_function<void(HttpResult)> onDone);
+
+    /**
+     * @brief Snapshot of queue depths, waits and active transfers
+     */
+    FetchMetrics metrics() const;
+
+    static constexpr std::size_t kMaxActive = 10;
+    static constexpr std::size_t kMaxPerHost = 6;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Job {
+        std::string url;
+        Origin origin;
+        FetchPriority priority;
+        int timeoutMs;
+        std::shared_ptr<std::atomic<bool>> cancel;
+        std::move_only_function<void(HttpResult)> done;
+        Clock::time_point queuedAt;
+    };
+
+    /// One priority class: hosts with queued work, served round-robin
+    struct Lane {
+        std::deque<Origin> hosts;
+        std::unordered_map<Origin, std::deque<Job>> jobs;
+    };
+
+    void workerLoop();
+
+    /// Next job allowed to start under the limits, if any
+    std::optional<Job> pickLocked();
+
+    const std::size_t maxActive_;
+    const std::size_t maxPerHost_;
+    ConnectionPool* const pool_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::array<Lane, kFetchPriorityCount> lanes_;
+    std::unordered_map<Origin, std::size_t> active_;
+    std::vector<std::shared_ptr<std::atomic<bool>>> running_;   ///< Cancel flags of transfers in flight
+    FetchMetrics stats_;   ///< Per-class counters; active fields are filled in by metrics()
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+};
+
+#endif
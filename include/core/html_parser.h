@@ -1,7 +1,10 @@
 #ifndef HTML_PARSER_H
 #define HTML_PARSER_H
 
+#include <chrono>
+#include <cstddef>
 #include <string>
+#include <string_view>
 #include <vector>
 
 /**
@@ -23,18 +26,42 @@ struct ParsedPage {
     std::string title;
     std::string text;
     std::vector<Link> links;
+    bool truncated = false;   ///< Parsing stopped early because the CPU budget ran out
+};
+
+/**
+ * @struct ParseOptions
+ * @brief Limits and parallelism for parsing a single document
+ */
+struct ParseOptions {
+    /// CPU time the parser may spend on one document; zero means unlimited
+    std::chrono::milliseconds cpu_budget {0};
+
+    /// Worker threads for chunked parsing; 1 parses serially, 0 uses every core
+    std::size_t threads = 1;
+
+    /// Documents smaller than twice this size are always parsed serially
+    std::size_t min_chunk_size = 1 << 20;
 };
 
 /**
  * @brief Parse HTML and extract title, text content, and links
- * 
- * @param html Raw HTML source code as a string
+ *
+ * @param html Raw HTML source; only read during the call, so it may point into a mapped file
+ * @param options Parsing limits (CPU budget) and parallelism
  * @return ParsedPage with title, plain text, and extracted links
- * 
+ *
  * @note This is a naive parser, not a full HTML5 spec implementation
+ * @note Runs in a single left-to-right pass, so time is linear in the input size
+ * @note With options.threads != 1, large documents are split at safe points
+ *       (plain-text newlines outside tags, comments, script/style and links)
+ *       and the chunks are tokenized in parallel; the result is identical
+ *       to the serial parse
+ * @note If the CPU budget is exceeded, the text parsed so far is returned and
+ *       ParsedPage::truncated is set
  * @note Nested tags and complex structures are handled best-effort
  * @note Malformed HTML may produce unexpected results
  */
-ParsedPage parse_html_basic(const std::string& html);
+ParsedPage parse_html_basic(std::string_view html, const ParseOptions& options = {});
 
 #endif
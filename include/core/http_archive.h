@@ -0,0 +1,121 @@
+#ifndef HTTP_ARCHIVE_H
+#define HTTP_ARCHIVE_H
+
+#include "core/http_client.h"
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @struct ArchiveEntry
+ * @brief One recorded GET: the request, the final response and its timing
+ */
+struct ArchiveEntry {
+    std::string url;            ///< Requested URL (fragment dropped)
+    long status = 0;
+    std::string finalUrl;       ///< After redirects; empty on error
+    std::string contentType;
+    std::string headers;        ///< Raw header block of the final response
+    std::string body;
+    std::string error;          ///< Transport error; empty on success
+    std::uint64_t waitUs = 0;   ///< Request start to first response byte
+    std::uint64_t totalUs = 0;  ///< Request start to last byte
+};
+
+/**
+ * @class HttpArchive
+ * @brief Recorded HTTP exchanges, stored as a compact binary file
+ *
+ * File layout (little-endian, version 1): a 32-byte header (magic "MBHA",
+ * version, entry count, reserved, total file size, reserved) followed by
+ * the entries in recording order. Each entry is status (u32), flags (u32),
+ * wait and total time in microseconds (u64 each), then the URL, final URL,
+ * content type, headers and error as u32-length-prefixed strings and the
+ * body with a u64 length. Files are written to a temp file and renamed.
+ */
+class HttpArchive {
+public:
+    static constexpr std::uint32_t kVersion = 1;
+
+    void add(ArchiveEntry entry) { entries_.push_back(std::move(entry)); }
+    const std::vector<ArchiveEntry>& entries() const { return entries_; }
+    std::size_t size() const { return entries_.size(); }
+    void clear() { entries_.clear(); }
+
+    /**
+     * @brief Write the archive
+     *
+     * @return false if the file could not be written
+     */
+    bool save(const std::string& path) const;
+
+    /**
+     * @brief Read an archive, replacing the current entries
+     *
+     * @return false if the file is missing, truncated or not an archive
+     *         (the archive is left empty)
+     */
+    bool load(const std::string& path);
+
+private:
+    std::vector<ArchiveEntry> entries_;
+};
+
+/**
+ * @brief Start recording every http_get into memory
+ *
+ * Any previous recording or replay is dropped. Cancelled requests are not
+ * recorded; transport errors are, so replay reproduces them.
+ */
+void http_record_start();
+
+/**
+ * @brief Stop recording and write what was captured
+ *
+ * @param path Archive file to write
+ * @return false if nothing was being recorded or the file could not be written
+ */
+bool http_record_stop(const std::string& path);
+
+/**
+ * @brief Serve http_get from an archive instead of the network
+ *
+ * Requests are matched by URL without fragment. A URL recorded several
+ * times is answered with its recordings in order, the last one repeating.
+ * A URL that is not in the archive fails with "not in archive".
+ *
+ * @param path Archive file to load
+ * @param timeScale Multiplier for the recorded duration of each response
+ *        (1 reproduces the original timing, 0 answers immediately)
+ * @return false if the archive could not be loaded (replay stays off)
+ */
+bool http_replay_start(const std::string& path, double timeScale = 1.0);
+
+/**
+ * @brief Return http_get to the network
+ */
+void http_replay_stop();
+
+/// Entries captured since http_record_start (0 when not recording)
+std::size_t http_recorded_count();
+
+namespace archive_detail {
+
+/// Set while recording or replaying, so http_get pays one atomic load otherwise
+inline std::atomic<bool> active {false};
+
+/// Answers from the replay archive, or nullopt when not replaying
+std::optional<HttpResult> replay(const std::string& url, int timeout_ms, const std::atomic<bool>* cancel);
+
+/// Whether http_get should capture headers and timing for capture()
+bool recording();
+
+void capture(ArchiveEntry entry);
+
+}
+
+#endif
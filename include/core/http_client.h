@@ -1,7 +1,15 @@
 #ifndef HTTP_CLIENT_H
 #define HTTP_CLIENT_H
 
+#include "core/mapped_file.h"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
 #include <string>
+#include <string_view>
+
+class ConnectionPool;
 
 /**
  * @struct HttpResult
@@ -11,18 +19,57 @@ struct HttpResult {
     long status {0};
     std::string body {};
     std::string error {};
+    std::string url {};     ///< Final URL after redirects (empty on error)
+    std::string content_type {};   ///< Content-Type header of the final response
+    bool cancelled {false};        ///< Aborted through the cancel flag (error is "cancelled")
+
+    /// Body mapped from a file (a local document or a spooled large response); `body` is then empty
+    std::shared_ptr<const MappedFile> mapped {};
+
+    /// The body, wherever it lives
+    std::string_view bodyView() const { return mapped ? mapped->view() : std::string_view(body); }
 };
 
+/**
+ * @brief Initialize libcurl's process-wide state once (thread-safe)
+ *
+ * http_get calls this itself; calling it early from a background thread
+ * takes the cost off the first navigation.
+ */
+void http_global_init();
+
+/**
+ * @brief Spill response bodies larger than this to a temporary file (0, the default, never does)
+ *
+ * A body that grows past the threshold is moved to an unlinked file in the
+ * temp directory ($TMPDIR), the rest of the transfer is written there, and
+ * the result holds the file mapped read-only (HttpResult::mapped) instead of
+ * a heap copy. Applies to every later http_get call in the process.
+ */
+void http_set_spool_threshold(std::size_t bytes);
+
+/**
+ * @brief Current spool threshold in bytes (0 when spooling is off)
+ */
+std::size_t http_spool_threshold();
+
 /**
  * @brief Perform a blocking HTTP GET request
  * 
  * @param url The full URL to fetch (must include http:// or https://)
  * @param timeout_ms Request timeout in milliseconds (default: 10 seconds)
- * @return HttpResult containing status, body, and error information
+ * @param pool Optional pool: a warm connection to the URL's origin is reused
+ *        if one is parked there, and the connection is parked afterwards
+ * @param cancel Optional flag another thread sets to abort the request;
+ *        checked at least every CurlSession::kPollInterval
+ * @return HttpResult containing status, body (or a mapped spool file, see
+ *         http_set_spool_threshold) and error information
  * 
- * @note This call blocks until the request completes or times out
+ * @note This call blocks until the request completes, times out or is cancelled
+ * @note A cancelled request closes its connection; it is never pooled
  * @note Requires libcurl to be installed and linked
  */
-HttpResult http_get(const std::string& url, int timeout_ms = 10000);
+HttpResult http_get(const std::string& url, int timeout_ms = 10000, ConnectionPool* pool = nullptr,
+                    const std::atomic<bool>* cancel = nullptr);
 
 #endif
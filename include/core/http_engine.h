@@ -0,0 +1,148 @@
+#ifndef HTTP_ENGINE_H
+#define HTTP_ENGINE_H
+
+#include "core/http_client.h"
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+
+class Executor;
+
+/**
+ * @struct HttpEngineStats
+ * @brief Counters since the engine started
+ */
+struct HttpEngineStats {
+    std::size_t started = 0;
+    std::size_t completed = 0;   ///< Including failed and cancelled transfers
+    std::size_t cancelled = 0;
+    std::size_t active = 0;      ///< In flight right now
+    std::size_t peakActive = 0;
+    std::size_t wakeups = 0;     ///< Times the I/O thread woke up; flat while the engine is idle
+};
+
+/**
+ * @class HttpEngine
+ * @brief Event-driven HTTP client: any number of transfers on one I/O thread
+ *
+ * All transfers share one curl multi handle (and so its connection and DNS
+ * caches). The I/O thread waits on the sockets curl asks for (epoll on
+ * Linux, poll() elsewhere) and drives curl with curl_multi_socket_action,
+ * so the thread count stays at one however many transfers are in flight.
+ * Cancel flags are checked at least every CurlSession::kPollInterval; a
+ * cancelled transfer is removed at once, closing its connection. With no
+ * transfers in flight the thread sleeps until the next fetch().
+ *
+ * Completion callbacks and resumed coroutines run on the I/O thread and
+ * must not block; hand heavier work (parsing) to an Executor, or ask the
+ * awaitable to resume there.
+ *
+ * The engine does not take part in http_get's record/replay archive or in
+ * ConnectionPool: it keeps its own connections.
+ */
+class HttpEngine {
+public:
+    using Callback = std::move_only_function<void(HttpResult)>;
+
+    /**
+     * @param maxConnections Open connections at once across all hosts; 0 is unlimited.
+     *        Transfers beyond it wait inside curl for a free connection.
+     */
+    explicit HttpEngine(std::size_t maxConnections = 0);
+
+    /**
+     * @brief Cancel every transfer (callbacks still run, with cancelled set) and join the I/O thread
+     *
+     * A fetch() made meanwhile, e.g. from a cancelled transfer's callback,
+     * gets its callback at once with cancelled set.
+     */
+    ~HttpEngine();
+
+    HttpEngine(const HttpEngine&) = delete;
+    HttpEngine& operator=(const HttpEngine&) = delete;
+
+    /**
+     * @brief Process-wide engine, started on first use
+     */
+    static HttpEngine& shared();
+
+    /**
+     * @brief Start a GET request; `onDone` gets the result on the I/O thread
+     *
+     * @param url Absolute URL
+     * @param onDone Called exactly once
+     * @param timeout_ms Whole-transfer timeout
+     * @param cancel Optional flag that aborts the transfer
+     */
+    void fetch(const std::string& url, Callback onDone, int timeout_ms = 10000,
+               std::shared_ptr<std::atomic<bool>> cancel = nullptr);
+
+    /**
+     * @class Awaitable
+     * @brief `co_await engine.get(url)` suspends until the transfer completes
+     *
+     * The transfer starts when awaited. The coroutine resumes on the I/O
+     * thread, or on an Executor worker if one was given.
+     */
+    class Awaitable {
+    public:
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle);
+        HttpResult await_resume() { return std::move(result_); }
+
+    private:
+        friend class HttpEngine;
+        Awaitable(HttpEngine& engine, std::string url, int timeoutMs, std::shared_ptr<std::atomic<bool>> cancel,
+                  Executor* resumeOn)
+            : engine_(engine), url_(std::move(url)), timeoutMs_(timeoutMs), cancel_(std::move(cancel)), resumeOn_(resumeOn) {}
+
+        HttpEngine& engine_;
+        std::string url_;
+        int timeoutMs_;
+        std::shared_ptr<std::atomic<bool>> cancel_;
+        Executor* resumeOn_;
+        HttpResult result_;
+    };
+
+    /**
+     * @brief Awaitable GET request
+     *
+     * @param resumeOn Executor to continue the coroutine on; nullptr resumes on the I/O thread
+     */
+    Awaitable get(std::string url, int timeout_ms = 10000, std::shared_ptr<std::atomic<bool>> cancel = nullptr,
+                  Executor* resumeOn = nullptr) {
+        return Awaitable(*this, std::move(url), timeout_ms, std::move(cancel), resumeOn);
+    }
+
+    HttpEngineStats stats() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+/**
+ * @struct DetachedTask
+ * @brief Return type for a fire-and-forget coroutine: starts at once, frees itself when done
+ *
+ * Lets a plain function `co_await` fetches, e.g.
+ * `DetachedTask load(HttpEngine& e) { HttpResult r = co_await e.get(url); ... }`.
+ * Completion has to be signalled by the coroutine itself.
+ */
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef LOCAL_FILE_H
+#define LOCAL_FILE_H
+
+#include "core/http_client.h"
+#include "core/url.h"
+
+/**
+ * @brief Load a local file: URL the way http_get loads a network page
+ *
+ * Files up to 8 MB are read into HttpResult::body. Files up to 128 MB are
+ * copied into an unlinked temp file (in the kernel where possible) and the
+ * copy is mapped read-only (HttpResult::mapped). Either way the result is
+ * a snapshot: rewriting or truncating the file while the page is parsed
+ * cannot change it or crash the process (SIGBUS).
+ *
+ * Larger files, or any file $TMPDIR has no room for, are mapped in place:
+ * copying them would cost as much time and (on tmpfs) memory as the
+ * mapping saves. Truncating such a file while it is parsed raises SIGBUS.
+ *
+ * @param url A file: URL with no host (or "localhost")
+ * @return Status 200 with the mapping, the URL and a Content-Type guessed
+ *         from the extension; error set for other URLs, missing or
+ *         unreadable files and directories
+ */
+HttpResult load_local_file(const Url& url);
+
+#endif
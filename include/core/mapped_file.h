@@ -0,0 +1,77 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/**
+ * @class MappedFile
+ * @brief Read-only memory mapping of a whole file (RAII, move-only)
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Map a file, replacing any current mapping
+     *
+     * @param path File to map
+     * @return true on success; an empty file maps successfully with size 0
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Map the whole file behind an open descriptor, replacing any current mapping
+     *
+     * The descriptor stays owned by the caller and may be closed right after;
+     * the mapping keeps the file alive, even if it has been unlinked.
+     *
+     * @param fd Descriptor opened for reading
+     * @return true on success
+     */
+    bool openDescriptor(int fd);
+
+    /**
+     * @brief Map a private copy of the file behind an open descriptor
+     *
+     * The contents are copied (in the kernel where possible) into an unlinked
+     * temporary file, which is then mapped. A mapping of the original file
+     * raises SIGBUS when the file is truncated under it; the copy cannot be
+     * touched by anyone else.
+     *
+     * @param fd Descriptor opened for reading, positioned at the start
+     * @return true on success; false (nothing mapped) if the copy could not be made
+     */
+    bool openSnapshot(int fd);
+
+    /**
+     * @brief Unmap the file
+     */
+    void close();
+
+    bool isOpen() const { return open_; }
+    const char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    std::string_view view() const { return {data_, size_}; }
+
+private:
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+    bool open_ = false;
+};
+
+/**
+ * @brief Create a temporary file in $TMPDIR (/tmp if unset) and unlink it at once
+ *
+ * @return Descriptor open for reading and writing, or -1 with errno set
+ */
+int create_unlinked_temp_file();
+
+#endif
@@ -0,0 +1,164 @@
+#ifndef PAGE_DAEMON_H
+#define PAGE_DAEMON_H
+
+#include "core/html_parser.h"
+#include "core/http_client.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/**
+ * @struct DaemonPage
+ * @brief A page fetched and parsed by the daemon
+ */
+struct DaemonPage {
+    HttpResult response;        ///< Status, final URL, content type and error; body is not sent
+    ParsedPage page;            ///< Links already resolved against the final URL
+    bool cached = false;        ///< Served from the daemon's cache
+    bool sharedMemory = false;  ///< Page arrived through shared memory rather than the socket
+};
+
+/**
+ * @struct PageDaemonOptions
+ * @brief Cache and worker limits of a PageDaemon
+ */
+struct PageDaemonOptions {
+    std::size_t workers = 8;                         ///< Concurrent upstream fetches
+    std::size_t maxCacheBytes = 256u << 20;          ///< Parsed pages kept, least recently used dropped first
+    std::chrono::seconds ttl {60};                   ///< How long a cached page is served
+    std::size_t sharedMemoryThreshold = 64u << 10;   ///< Pages at least this large go through shared memory
+    int timeoutMs = 10000;                           ///< Upstream request timeout
+};
+
+/**
+ * @struct PageDaemonStats
+ * @brief Counters since the daemon started
+ */
+struct PageDaemonStats {
+    std::size_t requests = 0;
+    std::size_t hits = 0;
+    std::size_t coalesced = 0;       ///< Misses that joined a fetch already in flight
+    std::size_t fetches = 0;         ///< Upstream http_get calls
+    std::size_t clients = 0;         ///< Connections accepted
+    std::size_t cacheEntries = 0;
+    std::size_t cacheBytes = 0;
+};
+
+/**
+ * @class PageDaemon
+ * @brief Fetch-and-parse service for many viewer processes on one host
+ *
+ * Listens on a Unix domain socket. One I/O thread multiplexes every client
+ * with poll() and answers cache hits itself; misses are fetched and parsed
+ * on a worker pool that shares one ConnectionPool, and concurrent requests
+ * for the same URL share one fetch. Successful responses (status < 400)
+ * are cached by URL without fragment.
+ *
+ * Wire format (native byte order, the peer is on the same host). Request:
+ * u32 length of the rest, u32 request id, URL bytes.
+ * Response: u32 length of the rest, u32 request id, u32 flags (cached,
+ * truncated, shared memory), u32 status, then final URL, content type and
+ * error as u32-length-prefixed strings, then the page. A page is the title
+ * (u32 length), the text (u64 length) and u32 link count followed by
+ * (u64 start, u64 end, url, text) per link. Pages of at least
+ * sharedMemoryThreshold bytes are written once into a read-only shared
+ * memory object whose descriptor travels with the response (SCM_RIGHTS);
+ * the frame then carries only the page size.
+ */
+class PageDaemon {
+public:
+    explicit PageDaemon(PageDaemonOptions options = {});
+
+    /**
+     * @brief Stop serving: in-flight fetches are cancelled and clients disconnected
+     */
+    ~PageDaemon();
+
+    PageDaemon(const PageDaemon&) = delete;
+    PageDaemon& operator=(const PageDaemon&) = delete;
+
+    /**
+     * @brief Bind the socket and start serving
+     *
+     * A socket file left by a daemon that is no longer running is replaced;
+     * one another daemon still accepts on is left alone. The socket is
+     * created accessible to the current user only (umask 077 around bind).
+     *
+     * @param socketPath Filesystem path of the Unix socket
+     * @return false if the socket could not be bound, the path is in use by
+     *         a live daemon or another file, or this daemon already runs
+     */
+    bool start(const std::string& socketPath);
+
+    /**
+     * @brief Stop serving and remove the socket file (idempotent)
+     */
+    void stop();
+
+    PageDaemonStats stats() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+/**
+ * @class PageClient
+ * @brief Blocking connection from a viewer to a PageDaemon
+ *
+ * One request at a time per client; use one client per thread.
+ */
+class PageClient {
+public:
+    PageClient() = default;
+    ~PageClient();
+
+    PageClient(PageClient&& other) noexcept;
+    PageClient& operator=(PageClient&& other) noexcept;
+    PageClient(const PageClient&) = delete;
+    PageClient& operator=(const PageClient&) = delete;
+
+    /**
+     * @brief Connect to a daemon
+     *
+     * @return false if nothing listens at the path
+     */
+    bool connect(const std::string& socketPath);
+
+    /// Connected now; fetch() reconnects by itself after a cancelled request
+    bool isConnected() const { return fd_ >= 0; }
+
+    void close();
+
+    /**
+     * @brief Fetch and parse a page through the daemon
+     *
+     * @param url Absolute http(s) URL
+     * @param timeout_ms Bound on the wait for the answer, plus the parse budget
+     *        (the daemon applies its own upstream timeout)
+     * @param cancel Optional flag that abandons the request (checked every
+     *        CurlSession::kPollInterval); the connection is closed since the
+     *        answer would arrive later
+     * @return The page; response.error is set if the daemon could not be
+     *         reached or the fetch failed
+     */
+    DaemonPage fetch(const std::string& url, int timeout_ms = 10000, const std::atomic<bool>* cancel = nullptr);
+
+private:
+    int fd_ = -1;
+    std::string socketPath_;
+    std::uint32_t nextId_ = 1;
+};
+
+/**
+ * @brief Socket path shared by the daemon and the browser when none is given
+ *
+ * @return $XDG_RUNTIME_DIR/mini-browser.sock, else /tmp/mini-browser-<uid>.sock
+ */
+std::string default_daemon_socket();
+
+#endif
@@ -0,0 +1,221 @@
+#ifndef SEARCH_INDEX_H
+#define SEARCH_INDEX_H
+
+#include "core/mapped_file.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @struct SearchHit
+ * @brief One ranked result of a full-text query
+ */
+struct SearchHit {
+    std::string url;
+    std::string title;
+    double score = 0.0;
+};
+
+/**
+ * @brief Split text into lowercase index terms
+ *
+ * ASCII letters and digits (and any non-ASCII byte) form words; everything
+ * else separates them. Terms shorter than two bytes are skipped and long
+ * terms are cut at 40 bytes.
+ *
+ * @param text Text to tokenize
+ * @param out Receives the terms (appended)
+ */
+void tokenize_terms(std::string_view text, std::vector<std::string>& out);
+
+/**
+ * @class IndexWriter
+ * @brief In-memory batch of documents written out as one immutable segment
+ *
+ * Segment files (seg-NNNNNNNN.mbi) hold a document table, a sorted term
+ * table and per-term posting lists of (doc delta, term frequency) pairs
+ * encoded as varints. Numbers are stored in host (little-endian) order.
+ */
+class IndexWriter {
+public:
+    /**
+     * @brief Tokenize and buffer a page; title terms count three times
+     *
+     * Only the first kMaxTextBytes of the text are indexed, cut at a word
+     * boundary (or, inside a run of non-ASCII text, at a code point), so a
+     * huge local document costs no more than a long page.
+     */
+    void add(const std::string& url, const std::string& title, std::string_view text);
+
+    /// Text indexed per page; plenty to find a page by what it is about
+    static constexpr std::size_t kMaxTextBytes = 1 << 20;
+
+    /**
+     * @brief Number of buffered documents
+     */
+    std::size_t pending() const { return docs_.size(); }
+
+    /**
+     * @brief Write buffered documents as a new segment in dir and clear the buffer
+     *
+     * Takes an flock on dir/lock while the segment is numbered and written,
+     * so processes sharing the directory never reuse a segment number.
+     *
+     * @return true on success (or if nothing was buffered)
+     */
+    bool flush(const std::string& dir);
+
+private:
+    struct Doc {
+        std::string url;
+        std::string title;
+        std::uint32_t length;
+    };
+    struct Posting {
+        std::uint32_t doc;
+        std::uint32_t tf;
+    };
+
+    std::vector<Doc> docs_;
+    std::unordered_map<std::string, std::vector<Posting>> postings_;
+};
+
+/**
+ * @class IndexReader
+ * @brief Memory-mapped view over every segment in an index directory
+ */
+class IndexReader {
+public:
+    /**
+     * @brief Map all segments in a directory (missing directory = empty index)
+     */
+    explicit IndexReader(const std::string& dir);
+
+    /**
+     * @brief Ranked keyword search (BM25) across all segments
+     *
+     * When several matching copies of a URL exist (it was revisited since
+     * the last compaction), only the newest one is returned.
+     *
+     * @param query Free-text query; every term contributes to the score
+     * @param limit Maximum number of hits
+     * @return Hits ordered by descending score
+     */
+    std::vector<SearchHit> search(std::string_view query, std::size_t limit = 20) const;
+
+    std::size_t documentCount() const { return docCount_; }
+    std::size_t segmentCount() const { return segments_.size(); }
+
+private:
+    friend bool compact_index(const std::string& dir);
+
+    struct Segment {
+        MappedFile file;
+        std::uint32_t number = 0;
+        std::uint32_t docCount = 0;
+        std::uint32_t termCount = 0;
+        const char* docIndex = nullptr;     ///< docCount x u64 record offsets
+        const char* termIndex = nullptr;    ///< termCount x 24-byte entries
+        const char* termBlob = nullptr;
+        const char* postings = nullptr;
+
+        /// Term bytes, up to the postings section
+        std::string_view blob() const { return {termBlob, static_cast<std::size_t>(postings - termBlob)}; }
+        std::uint64_t postingsSize() const { return static_cast<std::uint64_t>(file.data() + file.size() - postings); }
+    };
+
+    std::vector<Segment> segments_;   ///< Ascending by segment number (oldest first)
+    std::size_t docCount_ = 0;
+    std::uint64_t totalLength_ = 0;
+};
+
+/**
+ * @brief Merge every segment in dir into one, dropping superseded copies of a URL
+ *
+ * Holds the same dir/lock as IndexWriter::flush, so a segment another
+ * process is writing is never merged away or overwritten.
+ *
+ * @return true on success
+ */
+bool compact_index(const std::string& dir);
+
+/**
+ * @class SearchIndex
+ * @brief Persistent history index that ingests pages on a background thread
+ *
+ * Pages are tokenized off the UI thread and flushed as segments in batches
+ * (and on destruction). Queries run against the latest flushed state.
+ */
+class SearchIndex {
+public:
+    /**
+     * @brief Open or create an index directory
+     */
+    explicit SearchIndex(std::string dir);
+
+    /**
+     * @brief Flush pending pages and stop the background thread
+     */
+    ~SearchIndex();
+
+    SearchIndex(const SearchIndex&) = delete;
+    SearchIndex& operator=(const SearchIndex&) = delete;
+
+    /**
+     * @brief Queue a visited page for indexing (returns immediately)
+     *
+     * The text is shared with the caller rather than copied, and released
+     * once the page is tokenized.
+     */
+    void addAsync(std::string url, std::string title, std::shared_ptr<const std::string> text);
+
+    /**
+     * @brief Ranked search over everything flushed so far
+     */
+    std::vector<SearchHit> search(std::string_view query, std::size_t limit = 20) const;
+
+    /**
+     * @brief Block until every queued page is indexed and flushed
+     */
+    void flush();
+
+    /// Pages buffered before a segment is written
+    static constexpr std::size_t kBatchSize = 16;
+    /// Segments tolerated before they are compacted into one
+    static constexpr std::size_t kMaxSegments = 8;
+    /// A partial batch is written after this long without new pages
+    static constexpr std::chrono::seconds kIdleFlush {30};
+
+private:
+    struct Page {
+        std::string url;
+        std::string title;
+        std::shared_ptr<const std::string> text;
+    };
+
+    void workerLoop();
+    void writeBatch(IndexWriter& writer);
+
+    std::string dir_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable idle_;
+    std::deque<Page> queue_;
+    bool busy_ = false;
+    bool flushRequested_ = false;
+    bool stopping_ = false;
+    std::shared_ptr<const IndexReader> reader_;
+    std::thread worker_;
+};
+
+#endif
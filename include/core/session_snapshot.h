@@ -0,0 +1,103 @@
+#ifndef SESSION_SNAPSHOT_H
+#define SESSION_SNAPSHOT_H
+
+#include "core/html_parser.h"
+#include "core/mapped_file.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @struct SessionState
+ * @brief What is saved on exit to reopen the browser where it was left
+ */
+struct SessionState {
+    std::string url;                    ///< Final URL of the page on screen (empty: nothing to restore)
+    long status = 0;
+    ParsedPage page;
+    std::size_t scrollAnchor = 0;       ///< Byte offset into page.text of the first visible line
+    std::vector<std::string> history;   ///< URLs visited this session, oldest first
+};
+
+/**
+ * @brief Write a session snapshot (atomically: temp file, then rename)
+ *
+ * Layout, numbers in host (little-endian) order:
+ * - 64-byte header: magic "MBSS", version, flags (bit 0: truncated), string,
+ *   link and history counts, status, scroll anchor, string index offset,
+ *   link table offset, file size
+ * - String table: u32 length + bytes per string; strings 0-2 are URL,
+ *   title and text, link texts/URLs and history URLs are deduplicated
+ * - String index: u64 file offset per string
+ * - Link table: 24 bytes per link, (u64 start, u64 end) offsets into the
+ *   text plus u32 URL and text string ids
+ * - History: u32 string id per entry
+ *
+ * @param path Snapshot file; its directory is created if needed
+ * @return true on success
+ */
+bool save_session(const std::string& path, const SessionState& state);
+
+/**
+ * @class SessionSnapshot
+ * @brief Memory-mapped, validated view of a session snapshot
+ *
+ * open() checks the header and every table bound once; accessors then
+ * return views into the mapping without parsing or copying.
+ */
+class SessionSnapshot {
+public:
+    /**
+     * @brief Map and validate a snapshot, replacing any open one
+     *
+     * @return false if the file is missing, truncated, corrupt or of
+     *         another format version
+     */
+    bool open(const std::string& path);
+
+    bool isOpen() const { return file_.isOpen(); }
+
+    /// Size of the mapped file in bytes
+    std::size_t size() const { return file_.size(); }
+
+    std::string_view url() const { return string(0); }
+    std::string_view title() const { return string(1); }
+    std::string_view text() const { return string(2); }
+    long status() const { return status_; }
+    bool truncated() const { return truncated_; }
+    std::size_t scrollAnchor() const { return scrollAnchor_; }
+
+    std::size_t linkCount() const { return linkCount_; }
+
+    /// Link i with positions into text()
+    Link link(std::size_t i) const;
+
+    std::size_t historyCount() const { return historyCount_; }
+    std::string_view history(std::size_t i) const;
+
+    /**
+     * @brief Copy the page out for display (no parsing involved)
+     */
+    ParsedPage page() const;
+
+    static constexpr std::uint32_t kVersion = 1;
+
+private:
+    std::string_view string(std::uint32_t id) const;
+
+    MappedFile file_;
+    const char* stringIndex_ = nullptr;
+    const char* links_ = nullptr;
+    const char* historyIds_ = nullptr;
+    std::uint32_t stringCount_ = 0;
+    std::uint32_t linkCount_ = 0;
+    std::uint32_t historyCount_ = 0;
+    long status_ = 0;
+    bool truncated_ = false;
+    std::size_t scrollAnchor_ = 0;
+};
+
+#endif
@@ -0,0 +1,249 @@
+#ifndef TEXT_LAYOUT_H
+#define TEXT_LAYOUT_H
+
+#include "core/html_parser.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class GlyphMetrics
+ * @brief Font measurements the layout engine needs, independent of any graphics library
+ *
+ * Implementations must be safe to call from several threads at once: layout
+ * of a large page measures paragraphs in parallel.
+ */
+class GlyphMetrics {
+public:
+    virtual ~GlyphMetrics() = default;
+
+    /// Horizontal pen advance after drawing a code point, in pixels
+    virtual float advance(char32_t c) const = 0;
+
+    /// Distance between two baselines, in pixels
+    virtual float lineHeight() const = 0;
+
+    /// Width of a run of code points; override to avoid one virtual call per glyph
+    virtual float measure(std::u32string_view run) const {
+        float w = 0.f;
+        for (char32_t c : run) w += advance(c);
+        return w;
+    }
+};
+
+/**
+ * @class TableGlyphMetrics
+ * @brief Metrics looked up from a table of advances filled in advance
+ *
+ * Latin-1 code points live in a flat array; others in a hash map. Code
+ * points never set measure as the fallback advance. Lookups are read-only,
+ * so once filled the table can be shared by any number of layout threads.
+ */
+class TableGlyphMetrics : public GlyphMetrics {
+public:
+    TableGlyphMetrics(float fallbackAdvance, float lineHeight);
+
+    /// Record a code point's advance (not thread-safe; fill before laying out)
+    void set(char32_t c, float advance);
+
+    /// Whether a code point has an advance of its own
+    bool has(char32_t c) const;
+
+    float advance(char32_t c) const override;
+    float lineHeight() const override { return lineHeight_; }
+    float measure(std::u32string_view run) const override;
+
+private:
+    std::array<float, 256> latin1_ {};
+    std::array<bool, 256> latin1Set_ {};
+    std::unordered_map<char32_t, float> other_;
+    float fallback_;
+    float lineHeight_;
+};
+
+/**
+ * @class FixedGlyphMetrics
+ * @brief Every glyph has the same advance (monospace stub for tests and benchmarks)
+ */
+class FixedGlyphMetrics : public GlyphMetrics {
+public:
+    FixedGlyphMetrics(float advance, float lineHeight) : advance_(advance), lineHeight_(lineHeight) {}
+
+    float advance(char32_t) const override { return advance_; }
+    float lineHeight() const override { return lineHeight_; }
+    float measure(std::u32string_view run) const override { return advance_ * static_cast<float>(run.size()); }
+
+private:
+    float advance_;
+    float lineHeight_;
+};
+
+/**
+ * @struct LayoutRun
+ * @brief One word placed on a line
+ *
+ * 16 bytes per word: the word's UTF-8 bytes are found relative to its
+ * line's byteStart, and its code points are decoded from the page text
+ * only when the line is painted.
+ */
+struct LayoutRun {
+    std::uint32_t start;     ///< Byte offset from the start of the line (LayoutLine::byteStart)
+    std::uint32_t length;    ///< Bytes in the word
+    float x;                 ///< Left edge relative to the line start
+    float width;
+};
+
+/**
+ * @struct LayoutLine
+ * @brief A line of runs; its top is index * lineHeight
+ */
+struct LayoutLine {
+    std::size_t firstRun;
+    std::size_t runCount;
+    std::size_t byteStart;   ///< Text offset the line starts at (empty lines: where their paragraph starts)
+};
+
+/**
+ * @struct LinkBox
+ * @brief The part of a link on one line, for underlining and hit testing
+ */
+struct LinkBox {
+    std::size_t link;        ///< Index into the links given to layout_text
+    std::size_t line;
+    float x;
+    float width;
+};
+
+/**
+ * @struct VisibleLines
+ * @brief The part of a layout a viewport shows: what a frame paints
+ */
+struct VisibleLines {
+    std::size_t first = 0;      ///< First line on screen
+    std::size_t last = 0;       ///< One past the last line on screen
+    std::size_t firstBox = 0;   ///< Link boxes [firstBox, lastBox) of linkBoxes() lie on those lines
+    std::size_t lastBox = 0;
+};
+
+/**
+ * @struct LayoutOptions
+ * @brief Width and parallelism for one layout
+ */
+struct LayoutOptions {
+    /// Wrap width in pixels; a word wider than this gets a line of its own
+    float width = 780.f;
+
+    /// Worker threads for laying out paragraphs in parallel; 1 is serial, 0 uses every core
+    std::size_t threads = 1;
+
+    /// Texts shorter than twice this many bytes are always laid out serially
+    std::size_t min_chunk_size = 1 << 18;
+};
+
+/**
+ * @class TextLayout
+ * @brief Immutable result of laying out a page: lines, word runs and link boxes
+ *
+ * Coordinates are relative to the top-left of the text; line i spans
+ * [i * lineHeight, (i + 1) * lineHeight). Built only by layout_text.
+ */
+class TextLayout {
+public:
+    TextLayout() = default;
+
+    const std::vector<LayoutLine>& lines() const { return lines_; }
+    const std::vector<LayoutRun>& runs() const { return runs_; }
+    const std::vector<LinkBox>& linkBoxes() const { return linkBoxes_; }   ///< Ascending by line
+
+    /// Text offset of a run's first byte; `line` is the line holding it
+    std::size_t runStart(std::size_t line, std::size_t run) const { return lines_[line].byteStart + runs_[run].start; }
+
+    float width() const { return width_; }
+    float lineHeight() const { return lineHeight_; }
+    float height() const { return static_cast<float>(lines_.size()) * lineHeight_; }
+
+    /// Line at a y coordinate, clamped to the existing lines
+    std::size_t lineAt(float y) const;
+
+    /// Line holding a text offset; whitespace belongs to the word before it
+    std::size_t lineOf(std::size_t byteOffset) const;
+
+    /**
+     * @brief Lines and link boxes on screen for a scroll position
+     *
+     * Includes the lines cut by the top and bottom edges. Allocates
+     * nothing, so it can run every frame.
+     *
+     * @param scrollY Distance from the top of the text to the top of the viewport
+     * @param viewHeight Viewport height in pixels
+     */
+    VisibleLines visibleLines(float scrollY, float viewHeight) const;
+
+    /**
+     * @brief First of ascending text offsets (such as find matches) on or below a line
+     *
+     * @return Index into offsets; offsets.size() if every offset lies above the line
+     */
+    std::size_t firstOffsetFrom(const std::vector<std::size_t>& offsets, std::size_t line) const;
+
+    /**
+     * @brief Horizontal position of a text offset on its line
+     *
+     * @param text The text the layout was built from
+     * @param metrics The metrics the layout was built with
+     */
+    float xOf(std::size_t byteOffset, std::string_view text, const GlyphMetrics& metrics) const;
+
+    /**
+     * @brief Link under a point
+     *
+     * @return Index into the links given to layout_text, or npos
+     */
+    std::size_t linkAt(float x, float y) const;
+
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+private:
+    friend TextLayout layout_text(std::string_view, const std::vector<Link>&, const GlyphMetrics&,
+                                  const LayoutOptions&);
+
+    /// Last run starting at or before a text offset, or npos
+    std::size_t runOf(std::size_t byteOffset) const;
+
+    /// Line holding a run
+    std::size_t lineOfRun(std::size_t run) const;
+
+    std::vector<LayoutLine> lines_;
+    std::vector<LayoutRun> runs_;
+    std::vector<LinkBox> linkBoxes_;
+    float width_ = 0.f;
+    float lineHeight_ = 0.f;
+};
+
+/**
+ * @brief Break text into lines and place words and links
+ *
+ * Each '\n' starts a new line; other whitespace collapses to one space
+ * between words. Links are placed from their byte ranges (as produced by
+ * the parser) and split into one box per line they cross. Large texts are
+ * cut at paragraph breaks and the pieces laid out in parallel; the result
+ * is identical to a serial layout. The calling thread lays out pieces
+ * itself alongside Executor::shared() workers, so a busy executor slows
+ * layout down but never blocks it behind queued tasks. Words are decoded
+ * to code points only to be measured; no decoded copy of the text is kept.
+ *
+ * @param text UTF-8 page text; offsets in the result are byte offsets into it
+ * @param links Links with byte ranges into the UTF-8 text
+ * @param metrics Glyph advances and line height
+ * @param options Wrap width and parallelism
+ * @return The finished layout
+ */
+TextLayout layout_text(std::string_view text, const std::vector<Link>& links, const GlyphMetrics& metrics,
+                       const LayoutOptions& options = {});
+
+#endif
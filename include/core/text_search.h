@@ -0,0 +1,149 @@
+#ifndef TEXT_SEARCH_H
+#define TEXT_SEARCH_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/**
+ * @class CaseInsensitiveSearcher
+ * @brief ASCII case-insensitive Boyer-Moore-Horspool substring matcher
+ *
+ * The skip table is built once per needle; searching compares folded bytes,
+ * so non-ASCII UTF-8 bytes must match exactly. Needles too short for
+ * Horspool to skip are located with a word-at-a-time (SWAR) first-byte scan.
+ */
+class CaseInsensitiveSearcher {
+public:
+    /**
+     * @brief Prepare the skip table for a needle
+     *
+     * @param needle Text to look for (an empty needle never matches)
+     */
+    explicit CaseInsensitiveSearcher(std::string_view needle);
+
+    /**
+     * @brief Find the next match at or after a position
+     *
+     * @param haystack Text to search
+     * @param from Index to start searching at
+     * @return Index of the match, or std::string_view::npos
+     */
+    std::size_t find(std::string_view haystack, std::size_t from = 0) const;
+
+    /**
+     * @brief Check whether the needle matches at an exact position
+     */
+    bool matchesAt(std::string_view haystack, std::size_t pos) const;
+
+    std::size_t size() const { return needle_.size(); }
+
+private:
+    std::size_t findShort(std::string_view haystack, std::size_t from) const;
+
+    std::string needle_; // folded
+    std::array<std::uint32_t, 256> skip_ {};
+};
+
+/**
+ * @brief Find every case-insensitive match, including overlapping ones
+ *
+ * @param haystack Text to search
+ * @param needle Text to look for
+ * @param cancel Optional flag; when it becomes true the search stops early
+ * @return Start offsets of all matches found (partial if cancelled)
+ */
+std::vector<std::size_t> find_all_ci(std::string_view haystack, std::string_view needle,
+                                     const std::atomic<bool>* cancel = nullptr);
+
+/**
+ * @struct FindResult
+ * @brief Matches for one query over the finder's current text
+ */
+struct FindResult {
+    std::string query;
+    std::vector<std::size_t> matches;   ///< Start offsets, ascending
+    std::size_t length = 0;             ///< Match length in bytes
+};
+
+/**
+ * @class TextFinder
+ * @brief Incremental find-in-page running on a background thread
+ *
+ * Each search() supersedes the previous one: an in-flight scan is cancelled
+ * and only the newest query's result is delivered. When a query extends the
+ * previous completed query, only the previous matches are re-checked.
+ * Small texts are searched inline, so poll() sees them immediately.
+ */
+class TextFinder {
+public:
+    TextFinder() = default;
+    ~TextFinder();
+
+    TextFinder(const TextFinder&) = delete;
+    TextFinder& operator=(const TextFinder&) = delete;
+
+    /**
+     * @brief Replace the searched text, cancelling any running search
+     */
+    void setText(std::shared_ptr<const std::string> text);
+
+    /**
+     * @brief Start searching for a query, superseding earlier ones
+     *
+     * @param query Text to find; empty clears the result
+     */
+    void search(const std::string& query);
+
+    /**
+     * @brief Cancel the running search without delivering a result
+     */
+    void cancel();
+
+    /**
+     * @brief Take the latest completed result, if a new one is available
+     *
+     * @param out Receives the result
+     * @return true if out was updated
+     */
+    bool poll(FindResult& out);
+
+    /// Texts at least this long are searched off the calling thread
+    static constexpr std::size_t kBackgroundThreshold = 256 * 1024;
+
+private:
+    struct Job {
+        std::uint64_t generation = 0;
+        std::shared_ptr<const std::string> text;
+        std::string query;
+        std::shared_ptr<const FindResult> previous;
+    };
+
+    void workerLoop();
+    FindResult run(const Job& job) const;
+    bool superseded(std::uint64_t generation) const { return latest_.load(std::memory_order_relaxed) != generation; }
+    void publish(std::uint64_t generation, FindResult result);
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::thread worker_;
+    bool stopping_ = false;
+    bool hasJob_ = false;
+    Job job_;
+
+    std::shared_ptr<const std::string> text_;
+    std::shared_ptr<const FindResult> last_;   ///< Newest completed result for the current text
+    bool fresh_ = false;                       ///< last_ not yet returned by poll()
+    std::uint64_t generation_ = 0;
+    std::atomic<std::uint64_t> latest_ {0};    ///< Generation a running scan must match to continue
+};
+
+#endif
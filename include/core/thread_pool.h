@@ -0,0 +1,70 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @class ThreadPool
+ * @brief Fixed-size pool of worker threads running queued tasks in FIFO order
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief Start a pool with the given number of workers
+     *
+     * @param threads Worker count; zero uses std::thread::hardware_concurrency()
+     */
+    explicit ThreadPool(std::size_t threads = 0);
+
+    /**
+     * @brief Stop accepting work, finish queued tasks and join all workers
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Queue a task for execution on a worker
+     *
+     * @param fn Callable taking no arguments
+     * @return std::future for the callable's result
+     */
+    template <class F>
+    auto submit(F&& fn) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        using R = std::invoke_result_t<std::decay_t<F>>;
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(fn));
+        std::future<R> result = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.emplace_back([task]{ (*task)(); });
+        }
+        cv_.notify_one();
+        return result;
+    }
+
+    /**
+     * @brief Number of worker threads
+     */
+    std::size_t size() const { return workers_.size(); }
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> queue_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_ = false;
+};
+
+#endif
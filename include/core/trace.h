@@ -0,0 +1,105 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * Span tracing exported as Chrome trace-event JSON (Perfetto, chrome://tracing).
+ *
+ * Each thread appends finished spans to its own buffer, so recording never
+ * contends with other threads. While tracing is off a TRACE_SCOPE costs one
+ * relaxed atomic load and a branch.
+ *
+ * Enable with MINI_BROWSER_TRACE=<file> or `--trace <file>`; the file is
+ * written when the browser exits.
+ */
+
+namespace trace_detail {
+inline std::atomic<bool> enabled {false};
+
+/// Nanoseconds since the process-wide trace epoch
+std::uint64_t now_ns();
+
+void record(const char* category, const char* name, std::uint64_t startNs, std::uint64_t endNs);
+}
+
+/**
+ * @brief Whether spans are being recorded
+ */
+inline bool trace_enabled() {
+    return trace_detail::enabled.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Start recording spans (events recorded earlier are kept)
+ */
+void trace_start();
+
+/**
+ * @brief Stop recording spans; recorded events stay until trace_clear()
+ */
+void trace_stop();
+
+/**
+ * @brief Drop every recorded event
+ */
+void trace_clear();
+
+/**
+ * @brief Events recorded so far across all threads
+ */
+std::size_t trace_event_count();
+
+/**
+ * @brief Label the calling thread in the exported trace (e.g. "ui")
+ *
+ * @param name Must outlive the trace (use a string literal)
+ */
+void trace_set_thread_name(const char* name);
+
+/**
+ * @brief Write all recorded events as Chrome trace-event JSON
+ *
+ * Spans are "complete" (ph "X") events with microsecond timestamps; each
+ * recording thread gets its own track.
+ *
+ * @return true on success
+ */
+bool trace_write(const std::string& path);
+
+/**
+ * @class TraceScope
+ * @brief Records the lifetime of a scope as one span (see TRACE_SCOPE)
+ *
+ * Category and name are stored as pointers: pass string literals.
+ */
+class TraceScope {
+public:
+    TraceScope(const char* category, const char* name)
+        : name_(trace_enabled() ? name : nullptr), category_(category) {
+        if (name_) start_ = trace_detail::now_ns();
+    }
+
+    ~TraceScope() {
+        if (name_) trace_detail::record(category_, name_, start_, trace_detail::now_ns());
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name_;
+    const char* category_;
+    std::uint64_t start_ = 0;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+/// Trace the enclosing scope, e.g. TRACE_SCOPE("net", "http_get")
+#define TRACE_SCOPE(category, name) TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(category, name)
+
+#endif
@@ -0,0 +1,180 @@
+#ifndef URL_H
+#define URL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct Link;
+
+/**
+ * @class Origin
+ * @brief Interned scheme://host[:port] of a URL
+ *
+ * Every distinct origin string is stored once per process, so origins compare
+ * and hash by pointer. A default-constructed Origin is opaque (e.g. mailto:).
+ */
+class Origin {
+public:
+    Origin() = default;
+
+    /**
+     * @brief Intern an origin string such as "https://example.com:8443"
+     */
+    static Origin intern(std::string_view key);
+
+    bool isOpaque() const { return key_ == nullptr; }
+
+    /**
+     * @brief Serialized origin ("" when opaque); default ports are omitted
+     */
+    std::string_view str() const { return key_ ? std::string_view(*key_) : std::string_view(); }
+
+    friend bool operator==(Origin a, Origin b) { return a.key_ == b.key_; }
+
+    std::size_t hash() const { return std::hash<const void*>{}(key_); }
+
+private:
+    explicit Origin(const std::string* key) : key_(key) {}
+    const std::string* key_ = nullptr;
+};
+
+template <>
+struct std::hash<Origin> {
+    std::size_t operator()(Origin o) const noexcept { return o.hash(); }
+};
+
+/**
+ * @class Url
+ * @brief Absolute URL parsed once into component spans (RFC 3986)
+ *
+ * The stored form is normalized: scheme and host are lowercased, default
+ * ports (80 for http, 443 for https) are dropped, dot segments are removed
+ * and an empty http(s) path becomes "/". Accessors return views into it.
+ */
+class Url {
+public:
+    /**
+     * @brief Parse an absolute URL
+     *
+     * @param text URL with a scheme, e.g. "https://example.com/a?b#c"
+     * @return Parsed URL, or std::nullopt if there is no valid scheme
+     */
+    static std::optional<Url> parse(std::string_view text);
+
+    /**
+     * @brief Parse what a user typed into the address bar
+     *
+     * Text without "scheme://" (e.g. "example.com/path") is treated as https.
+     * Local paths ("/abs", "~/in/home", "./rel", "../rel") become file: URLs.
+     */
+    static std::optional<Url> fromUserInput(std::string_view text);
+
+    /**
+     * @brief file: URL for an absolute filesystem path
+     *
+     * @param path Absolute path; bytes that cannot appear in a URL path are percent-encoded
+     * @return The URL, or std::nullopt if the path is not absolute
+     */
+    static std::optional<Url> fromFilePath(std::string_view path);
+
+    /**
+     * @brief Filesystem path of a local file: URL, percent-decoded
+     *
+     * @return std::nullopt for other schemes and for file: URLs naming another host
+     */
+    std::optional<std::string> filePath() const;
+
+    /**
+     * @brief Resolve a reference against this URL (RFC 3986 section 5.2)
+     *
+     * Handles absolute, protocol-relative ("//host"), absolute-path,
+     * relative-path ("../x"), query-only ("?q") and fragment-only ("#f")
+     * references.
+     */
+    std::optional<Url> resolve(std::string_view reference) const;
+
+    /// Full normalized URL
+    const std::string& href() const { return href_; }
+
+    /// href() without the fragment; use as a cache or map key
+    std::string_view cacheKey() const {
+        return std::string_view(href_).substr(0, hasFragment_ ? fragment_.pos - 1 : href_.size());
+    }
+
+    std::string_view scheme() const { return view(scheme_); }
+    std::string_view userinfo() const { return view(userinfo_); }
+    std::string_view host() const { return view(host_); }
+    std::string_view path() const { return view(path_); }
+    std::string_view query() const { return view(query_); }
+    std::string_view fragment() const { return view(fragment_); }
+
+    bool hasAuthority() const { return hasAuthority_; }
+    bool hasQuery() const { return hasQuery_; }
+    bool hasFragment() const { return hasFragment_; }
+
+    /**
+     * @brief Explicit port, else the scheme's default; -1 if neither
+     */
+    int port() const { return port_; }
+
+    /**
+     * @brief Interned origin (opaque for URLs without an authority)
+     */
+    Origin origin() const { return origin_; }
+
+    friend bool operator==(const Url& a, const Url& b) { return a.href_ == b.href_; }
+
+private:
+    struct Span {
+        std::uint32_t pos = 0;
+        std::uint32_t len = 0;
+    };
+
+    std::string_view view(Span s) const { return std::string_view(href_).substr(s.pos, s.len); }
+
+    friend class UrlBuilder;
+
+    std::string href_;
+    Span scheme_, userinfo_, host_, path_, query_, fragment_;
+    bool hasAuthority_ = false;
+    bool hasQuery_ = false;
+    bool hasFragment_ = false;
+    int port_ = -1;
+    Origin origin_;
+};
+
+template <>
+struct std::hash<Url> {
+    std::size_t operator()(const Url& u) const noexcept { return std::hash<std::string>{}(u.href()); }
+};
+
+/**
+ * @brief Whether clicking a link on a page may open its target
+ *
+ * http(s) targets always may. file: targets only from a page that is itself
+ * a local file, so a remote page cannot open (and show, and record in
+ * history) arbitrary local files; typed input goes through
+ * Url::fromUserInput instead and is not restricted. Other schemes never may.
+ *
+ * @param page URL of the page holding the link (nullopt: no page)
+ * @param target Resolved link target
+ */
+bool link_may_open(const std::optional<Url>& page, const Url& target);
+
+/**
+ * @brief Resolve every link of a page against its base URL in one batch
+ *
+ * Each Link::url is replaced by its absolute normalized form. References
+ * that cannot be resolved are left unchanged.
+ *
+ * @param links Links as extracted by parse_html_basic
+ * @param base URL the page was loaded from (after redirects)
+ */
+void resolve_links(std::vector<Link>& links, const Url& base);
+
+#endif
@@ -2,46 +2,50 @@
 #define CONTENT_VIEW_H
 
 #include <SFML/Graphics.hpp>
+#include <chrono>
+#include <memory>
 #include <string>
 #include <vector>
 #include <functional>
 #include "core/html_parser.h"
-
-/**
- * @struct RenderedLink
- * @brief Rendered link with screen-space bounds for click detection
- */
-struct RenderedLink {
-    std::string url;
-    sf::FloatRect bounds;
-};
+#include "core/text_layout.h"
+#include "core/text_search.h"
+#include "ui/font_metrics.h"
 
 /**
  * @class ContentView
  * @brief Scrollable text viewer with clickable links
+ *
+ * Line breaking and link geometry come from layout_text (core, no SFML);
+ * this class only paints the visible lines of the resulting TextLayout and
+ * maps input back onto it.
  */
 class ContentView {
 public:
     /**
      * @brief Construct a new ContentView
      * 
-     * Initializes the content viewer with default viewport, loads the font,
-     * and sets up text rendering. The view starts with empty content.
+     * Initializes the content viewer with default viewport and sets up text
+     * rendering. The view starts with empty content.
      * 
-     * @note Requires assets/HelveticaNeue.ttc font file to be present
+     * @note Uses the shared UI font from Resources
      */
     ContentView();
     
     /**
      * @brief Set content to display with optional links
      * 
+     * The text is shared, not copied: layout, painting and find-in-page all
+     * read this one buffer (unless it is not valid UTF-8, in which case a
+     * repaired copy is made).
+     * 
      * @param text Plain text content to display (can include newlines)
      * @param links Vector of links with positions matching text indices
      * 
      * @note Link positions (start_pos, end_pos) must correspond to character
      *       indices in the text parameter for correct rendering
      */
-    void setContent(const std::string& text, const std::vector<Link>& links = {});
+    void setContent(std::shared_ptr<const std::string> text, const std::vector<Link>& links = {});
     
     /**
      * @brief Set the viewport rectangle for content rendering
@@ -56,6 +60,10 @@ public:
      * Processes:
      * - MouseWheelScrolled: Scrolls content up/down
      * - MouseButtonPressed: Detects clicks on links and invokes onLinkClick callback
+     * - MouseMoved: Tracks the hovered link (see setOnLinkHover)
+     * - Ctrl+F (Cmd+F): Opens the find bar
+     * - While the find bar is open: typed text edits the query, Enter jumps to
+     *   the next match (Shift+Enter previous), Escape closes it
      * 
      * @param event SFML event to process
      * @return true if event was handled by this component
@@ -65,9 +73,10 @@ public:
     /**
      * @brief Draw content to the window
      * 
-     * Renders the status text, body text with word wrapping, and draws
-     * blue underlines beneath clickable links. Applies scroll offset and
-     * viewport clipping.
+     * Renders the status text, paints the glyphs of the visible lines and
+     * draws blue underlines beneath their links. Also collects finished
+     * find results, highlights the matches and fires onLinkHover once the
+     * pointer has dwelt on a link.
      * 
      * @param window Target SFML render window
      */
@@ -101,28 +110,117 @@ public:
     void setOnLinkClick(std::function<void(const std::string&)> callback) {
         onLinkClick_ = std::move(callback);
     }
+
+    /**
+     * @brief Register callback for link hover intent
+     *
+     * Called once when the pointer has rested on a link for kHoverDwell,
+     * e.g. to warm a connection before the likely click.
+     *
+     * @param callback Function receiving the hovered link's URL
+     */
+    void setOnLinkHover(std::function<void(const std::string&)> callback) {
+        onLinkHover_ = std::move(callback);
+    }
+
+    /// Pointer rest time on a link before onLinkHover fires
+    static constexpr std::chrono::milliseconds kHoverDwell {100};
+
+    /**
+     * @brief Byte offset into the page text of the first visible line
+     *
+     * Unlike the pixel scroll offset this survives a different window size,
+     * so it is what a saved session records.
+     */
+    std::size_t scrollAnchor() const;
+
+    /**
+     * @brief Scroll so the line holding a page text offset is at the top
+     *
+     * The anchor is re-applied on every re-wrap until the user scrolls, so it
+     * can be set before the window's first resize.
+     *
+     * @param textOffset Byte offset into the text given to setContent
+     */
+    void scrollToAnchor(std::size_t textOffset);
+
+    /**
+     * @brief Check whether the find bar is open
+     *
+     * While it is open the find bar owns keyboard input.
+     */
+    bool isFindOpen() const { return findOpen_; }
     
+    /// Body text size in pixels
+    static constexpr unsigned kBodySize = 14;
+
 private:
+    void openFind();
+    void closeFind();
+    void updateFind();
+    void stepFind(bool forward);
+    void scrollToMatch();
+    void refreshFindLabel();
+    void drawFindHighlights(sf::RenderWindow& window);
+
+    float lineHeight() const { return metrics_.lineHeight(); }
+
+    /// Screen position of the layout's top-left corner
+    sf::Vector2f textOrigin() const;
+
+    /// Index into links_ of the link under a screen point, or TextLayout::npos
+    std::size_t linkAt(sf::Vector2f point) const;
+
     /**
-     * @brief Perform word wrapping on content text
-     * 
-     * Splits text into lines that fit within the viewport width, respecting
-     * existing newlines from HTML formatting. Updates the wrapped_ string
-     * used for rendering.
+     * @brief Lay the text out again for the viewport width
+     *
+     * Works on the UTF-8 text and keeps no decoded copy of it: the layout
+     * stores byte offsets and only the visible lines are decoded for
+     * painting. Large pages are laid out in parallel.
      */
     void rewrap();
-    
-    sf::Font font_;
+
+    /**
+     * @brief Build glyph quads for lines [first, last) of the layout
+     */
+    void buildGlyphs(std::size_t first, std::size_t last);
+
+    const sf::Font& font_;                  ///< Shared; owned by Resources
+    FontMetrics metrics_;
     sf::Text statusText_;
-    sf::Text bodyText_;
     sf::FloatRect viewport_ { {10.f, 50.f}, {780.f, 540.f} };
-    std::string raw_;
-    std::string wrapped_;
+    std::shared_ptr<const std::string> text_ = std::make_shared<const std::string>();   ///< UTF-8 page text, shared with finder_
+    TextLayout layout_;
     float scrollY_ = 0.f;
+    std::size_t anchor_ = std::string::npos; ///< text_ offset pinned to the top until the user scrolls
+
+    // Glyph quads of the lines on screen, rebuilt when that range changes
+    sf::VertexArray glyphs_ {sf::PrimitiveType::Triangles};
+    std::size_t glyphsFirst_ = 0;
+    std::size_t glyphsLast_ = 0;
+    bool glyphsStale_ = true;
+
+    // Reused every frame: building a shape allocates its vertices
+    sf::RectangleShape underline_;
+    sf::RectangleShape highlight_;
+
+    // Find-in-page
+    bool findOpen_ = false;
+    std::string findQuery_;
+    sf::RectangleShape findBox_;
+    sf::Text findText_;
+    TextFinder finder_;
+    FindResult findResult_;
+    std::size_t findCurrent_ = 0;
 
     std::vector<Link> links_;
-    std::vector<RenderedLink> renderedLinks_;
     std::function<void(const std::string&)> onLinkClick_;
+
+    // Hover intent
+    std::string hoverUrl_;                  ///< Link under the pointer, empty if none
+    sf::Clock hoverClock_;                  ///< Time since hoverUrl_ changed
+    bool hoverFired_ = true;
+    std::function<void(const std::string&)> onLinkHover_;
 };
 
 #endif
@@ -0,0 +1,41 @@
+#ifndef FONT_METRICS_H
+#define FONT_METRICS_H
+
+#include <SFML/Graphics.hpp>
+#include <string_view>
+#include "core/text_layout.h"
+
+/**
+ * @class FontMetrics
+ * @brief Glyph advances of an SFML font, copied into a table the layout engine can read from any thread
+ *
+ * sf::Font is not thread-safe (looking up a glyph may render it into the
+ * font's texture), so advances are fetched on the UI thread by prepare()
+ * and layout only ever reads the table.
+ */
+class FontMetrics : public TableGlyphMetrics {
+public:
+    /**
+     * @brief Measure a font at one character size
+     *
+     * @param font Font to measure; must outlive this object
+     * @param characterSize Size in pixels, as given to sf::Text
+     */
+    FontMetrics(const sf::Font& font, unsigned characterSize);
+
+    /**
+     * @brief Fetch the advance of every code point in UTF-8 text not seen yet
+     *
+     * Call on the UI thread before laying the text out. This also loads the
+     * glyphs into the font texture, ready for painting.
+     */
+    void prepare(std::string_view text);
+
+    unsigned characterSize() const { return size_; }
+
+private:
+    const sf::Font& font_;
+    unsigned size_;
+};
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef RESOURCES_H
+#define RESOURCES_H
+
+#include <SFML/Graphics.hpp>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/**
+ * @class Resources
+ * @brief Process-wide cache of UI resources shared by every component
+ *
+ * Each font face is opened once and lives until the process exits, so
+ * sf::Text objects may keep references to it.
+ */
+class Resources {
+public:
+    /**
+     * @brief The single shared instance
+     */
+    static Resources& instance();
+
+    /**
+     * @brief Font used by the UI (assets/HelveticaNeue.ttc or a system fallback)
+     */
+    const sf::Font& uiFont();
+
+    /**
+     * @brief Load a font face once and return the shared copy
+     *
+     * @param path Font file path
+     * @return The font, or nullptr if it could not be opened
+     */
+    const sf::Font* font(const std::string& path);
+
+private:
+    Resources() = default;
+
+    std::mutex mutex_;
+    std::map<std::string, std::unique_ptr<sf::Font>> fonts_;   ///< nullptr marks a failed load
+    const sf::Font* uiFont_ = nullptr;
+};
+
+#endif
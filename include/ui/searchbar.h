@@ -14,7 +14,6 @@ class SearchBar {
     private:
         sf::RectangleShape background;
         sf::Text text;
-        sf::Font font;
         bool focused = true;
         std::function<void(const std::string&)> onSubmit;
 
@@ -22,7 +21,7 @@ class SearchBar {
         /**
          * @brief Construct a new SearchBar
          * 
-         * @note Requires assets/HelveticaNeue.ttc font file to be present
+         * @note Uses the shared UI font from Resources
          */
         SearchBar();
         
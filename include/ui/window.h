@@ -2,6 +2,7 @@
 #define WINDOW_H
 
 #include <SFML/Graphics.hpp>
+#include <functional>
 #include "ui/searchbar.h"
 #include "ui/content_view.h"
 
@@ -15,6 +16,7 @@
 class Window {
     private:
         sf::RenderWindow window;
+        std::function<void()> onFrame;
     
     public:
         /**
@@ -30,6 +32,7 @@ class Window {
          * - Forwards events to SearchBar and ContentView
          * - Handles window resize and close events
          * - Clears, draws, and displays each frame
+         * - Invokes the frame callback after each displayed frame
          * 
          * This call blocks until the window is closed.
          * 
@@ -48,6 +51,18 @@ class Window {
          * @param content Reference to the content view to draw
          */
         void draw(SearchBar& searchBar, ContentView& content);
+
+        /**
+         * @brief Register a callback run on the UI thread after every frame
+         *
+         * The first call happens right after the first frame is on screen,
+         * which makes it the place to start deferred initialization.
+         *
+         * @param callback Function to invoke, signature: void()
+         */
+        void setOnFrame(std::function<void()> callback) {
+            onFrame = std::move(callback);
+        }
 };
 
 #endif
\ No newline at end of file
@@ -1,95 +1,355 @@
 #include "browser/browser.h"
+#include "core/charset.h"
 #include "core/http_client.h"
 #include "core/html_parser.h"
-#include <future>
+#include "core/local_file.h"
+#include "core/trace.h"
+#include <cstdlib>
+#include <iomanip>
 #include <iostream>
+#include <string_view>
+
+namespace {
+// Hostile or huge pages must not freeze the UI; stop parsing after this much CPU time
+constexpr std::chrono::milliseconds kParseBudget {2000};
+
+// Startup goal for the first frame on screen
+constexpr std::chrono::milliseconds kFirstFrameTarget {100};
+
+// Shared fetch-and-parse daemon; MINI_BROWSER_DAEMON=<socket> (or 1 for the default socket) enables it
+std::string daemon_socket() {
+    const char* env = std::getenv("MINI_BROWSER_DAEMON");
+    if (!env || !*env) return {};
+    return std::string_view(env) == "1" ? default_daemon_socket() : env;
+}
+
+// Session history kept in the snapshot
+constexpr std::size_t kMaxSessionHistory = 100;
+
+// Full-text index of visited pages; MINI_BROWSER_INDEX overrides the location
+std::string history_index_dir() {
+    if (const char* dir = std::getenv("MINI_BROWSER_INDEX")) return dir;
+    const char* home = std::getenv("HOME");
+    return std::string(home ? home : ".") + "/.mini-browser/index";
+}
+
+// Snapshot restored at startup; MINI_BROWSER_SESSION overrides the location
+std::string session_path() {
+    if (const char* path = std::getenv("MINI_BROWSER_SESSION")) return path;
+    const char* home = std::getenv("HOME");
+    return std::string(home ? home : ".") + "/.mini-browser/session.mbs";
+}
+
+std::string status_line(long status, const ParsedPage& page) {
+    std::string line = "HTTP " + std::to_string(status);
+    if (!page.title.empty()) line += " — " + page.title;
+    if (page.truncated) line += " (truncated)";
+    return line;
+}
+}
+
+Browser::Browser() : daemonSocket(daemon_socket()) {
+    window.setOnFrame([this]{ onFrame(); });
 
-Browser::Browser() {
     // When user presses Enter in the search bar, store the URL text
     searchBar.setOnSubmit([this](const std::string& s){
-        url = s;
-        // Normalize: prepend https:// if missing scheme
-        std::string normalized = url;
-        if (normalized.rfind("http://", 0) != 0 && normalized.rfind("https://", 0) != 0) {
-            normalized = "https://" + normalized;
+        // "?keywords" searches previously visited pages instead of navigating
+        if (!s.empty() && s[0] == '?') {
+            cancelNavigation();
+            showHistorySearch(s.substr(1));
+            return;
         }
-        // Launch async fetch using std::async and poll in-place via future
-        loading = true;
-        auto fut = std::async(std::launch::async, [normalized]{
-            return http_get(normalized, 10000);
-        });
-        // Busy-ish polling just once; result will be consumed below (we could store the future if we wanted)
-        HttpResult r = fut.get();
-        loading = false;
-        if (!r.error.empty()) {
-            lastError = r.error;
-            status = 0;
-            html.clear();
-        } else {
-            lastError.clear();
-            status = r.status;
-            html = std::move(r.body);
-            std::cout << "Fetched status " << status << ", body size: " << html.size() << " bytes\n";
+        auto target = Url::fromUserInput(s);
+        if (!target) {
+            content.setStatus("Invalid URL: " + s);
+            return;
         }
-        // Update the UI content view
-        if (!lastError.empty()) {
-            content.setStatus("Error: " + lastError);
-            content.setContent("", {});
-        } else {
-            auto parsed = parse_html_basic(html);
-            std::string statusLine = "HTTP " + std::to_string(status);
-            if (!parsed.title.empty()) statusLine += " — " + parsed.title;
-            content.setStatus(statusLine);
-            content.setContent(parsed.text, parsed.links);
+        navigate(*target);
+    });
+
+    // Link click navigation; page links were resolved to absolute URLs at parse time
+    content.setOnLinkClick([this](const std::string& linkUrl){
+        auto target = Url::parse(linkUrl);
+        if (!target && pageUrl) target = pageUrl->resolve(linkUrl);
+        if (!target) {
+            content.setStatus("Unsupported link: " + linkUrl);
+            return;
+        }
+        // History results are the browser's own page: their file: entries were visited before
+        if (!showingHistory && !link_may_open(pageUrl, *target)) {
+            content.setStatus((target->scheme() == "file" ? "Blocked link to a local file: " : "Unsupported link: ") + linkUrl);
+            return;
+        }
+        navigate(*target);
+    });
+
+    // Hovering a link warms DNS and the connection so the click skips the handshake
+    content.setOnLinkHover([this](const std::string& linkUrl){
+        connections.preconnect(linkUrl);
+    });
+
+    restoreSession();
+}
+
+Browser::~Browser() {
+    cancelNavigation();
+    // Members are destroyed next: the scheduler cancels its transfers, then the pool stops
+}
+
+void Browser::navigate(const Url& target) {
+    cancelNavigation();
+    url = target.href();
+    loading = true;
+    if (alloc_tracking_enabled()) {
+        alloc_reset_peaks();
+        navigationAllocs = alloc_snapshot();
+    }
+    content.setStatus("Loading " + url + " ...");
+    auto cancel = std::make_shared<std::atomic<bool>>(false);
+    const std::uint64_t id = ++lastNavigation;
+    pending = Fetch{target, cancel, id};
+    // Results come back through mainQueue, which only onFrame() drains: capturing `this` there is safe
+    if (target.scheme() == "file") {
+        // Local documents are mapped and parsed on the executor; there is nothing to fetch
+        Executor::shared().then([target] { return loadPage(target, load_local_file(target)); },
+                                mainQueue,
+                                [this, id](LoadedPage loaded) mutable {
+                                    if (isPending(id)) showPage(std::move(loaded));
+                                },
+                                TaskPriority::Interactive);
+        return;
+    }
+    if (!daemonSocket.empty()) {
+        PageClient client;
+        if (client.connect(daemonSocket)) {
+            daemonRequests.submit([this, client = std::move(client), url = url, cancel, target, id,
+                                   queue = mainQueue]() mutable {
+                DaemonPage r = client.fetch(url, 10000, cancel.get());
+                if (r.response.cancelled) return;
+                queue->post([this, target, id, r = std::move(r)]() mutable {
+                    if (isPending(id)) showDaemonPage(target, std::move(r));
+                });
+            });
+            return;
         }
-        });
-
-        // Link click navigation
-        content.setOnLinkClick([this](const std::string& linkUrl){
-            std::string fullUrl = linkUrl;
-            // If relative, try to resolve naively
-            if (!linkUrl.empty() && linkUrl[0] == '/') {
-                auto proto = url.find("://");
-                if (proto != std::string::npos) {
-                    auto domainEnd = url.find('/', proto + 3);
-                    std::string origin = domainEnd == std::string::npos ? url : url.substr(0, domainEnd);
-                    fullUrl = origin + linkUrl;
-                }
-            } else if (linkUrl.find("://") == std::string::npos) {
-                fullUrl = "https://" + linkUrl;
-            }
-
-            url = fullUrl;
-            loading = true;
-            auto fut = std::async(std::launch::async, [fullUrl]{ return http_get(fullUrl, 10000); });
-            HttpResult r = fut.get();
-            loading = false;
-
-            if (!r.error.empty()) {
-                lastError = r.error;
-                status = 0;
-                html.clear();
-            } else {
-                lastError.clear();
-                status = r.status;
-                html = std::move(r.body);
-            }
-
-            if (!lastError.empty()) {
-                content.setStatus("Error: " + lastError);
-                content.setContent("", {});
-            } else {
-                auto parsed = parse_html_basic(html);
-                std::string statusLine = "HTTP " + std::to_string(status);
-                if (!parsed.title.empty()) statusLine += " — " + parsed.title;
-                content.setStatus(statusLine);
-                content.setContent(parsed.text, parsed.links);
-            }
-        });
+        std::cerr << "Page daemon not reachable at " << daemonSocket << ", fetching in-process\n";
+    }
+    fetches.submit(url, FetchPriority::Navigation, std::move(cancel), 10000,
+                   [this, target, id, queue = mainQueue](HttpResult r) mutable {
+        if (r.cancelled) return;
+        // Decode and parse on the executor, then show on the UI thread; no thread waits in between
+        Executor::shared().then([target, r = std::move(r)]() mutable { return loadPage(target, std::move(r)); },
+                                queue,
+                                [this, id](LoadedPage loaded) mutable {
+                                    if (isPending(id)) showPage(std::move(loaded));
+                                },
+                                TaskPriority::Interactive);
+    });
+}
+
+void Browser::cancelNavigation() {
+    if (!pending) return;
+    // The scheduler drops the transfer within one poll interval; its result is not waited for
+    pending->cancel->store(true);
+    pending.reset();
+    loading = false;
+}
+
+Browser::LoadedPage Browser::loadPage(const Url& target, HttpResult r) {
+    TRACE_SCOPE("page", "loadPage");
+    LoadedPage loaded;
+    if (r.error.empty()) {
+        // Decode once; everything downstream (parser, index, view) works on UTF-8.
+        // A mapped body (local file, spooled response) that already is UTF-8 is parsed in place
+        std::string_view body = r.bodyView();
+        Charset charset = detect_charset(r.content_type, body);
+        if (charset != Charset::Utf8 || !is_valid_utf8(body)) {
+            r.body = to_utf8(body, charset);
+            r.mapped.reset();
+            body = r.body;
+        }
+        body = strip_utf8_bom(body);
+        loaded.charset = charset_name(charset);
+        loaded.pageUrl = r.url.empty() ? std::nullopt : Url::parse(r.url);
+        if (!loaded.pageUrl) loaded.pageUrl = target;
+        loaded.page = parse_html_basic(body, ParseOptions{kParseBudget, 0});
+        resolve_links(loaded.page.links, *loaded.pageUrl);
+    }
+    loaded.response = std::move(r);
+    return loaded;
+}
+
+void Browser::showPage(LoadedPage loaded) {
+    TRACE_SCOPE("page", "showPage");
+    pending.reset();
+    loading = false;
+    HttpResult& r = loaded.response;
+    if (!r.error.empty()) {
+        lastError = r.error;
+        status = 0;
+        html.clear();
+    } else {
+        lastError.clear();
+        status = r.status;
+        std::cout << "Fetched status " << status << ", body size: " << r.bodyView().size() << " bytes, "
+                  << loaded.charset << (r.mapped ? ", mapped" : "") << "\n";
+        html = std::move(r.body);   // a mapped body is released with `loaded`
+        pageUrl = std::move(loaded.pageUrl);
+        page = std::move(loaded.page);
+    }
+    displayPage();
+}
+
+void Browser::showDaemonPage(const Url& target, DaemonPage r) {
+    TRACE_SCOPE("page", "showDaemonPage");
+    pending.reset();
+    loading = false;
+    lastError = r.response.error;
+    status = lastError.empty() ? r.response.status : 0;
+    html.clear();
+    if (lastError.empty()) {
+        std::cout << "Daemon status " << status << ", text size: " << r.page.text.size() << " bytes"
+                  << (r.cached ? ", cached" : "") << (r.sharedMemory ? ", shared memory" : "") << "\n";
+        pageUrl = r.response.url.empty() ? std::nullopt : Url::parse(r.response.url);
+        if (!pageUrl) pageUrl = target;
+        page = std::move(r.page);
+    }
+    displayPage();
+}
+
+void Browser::displayPage() {
+    showingHistory = false;
+    // Update the UI content view
+    if (!lastError.empty()) {
+        pageUrl.reset();
+        page = ParsedPage{};
+        pageText = std::make_shared<const std::string>();
+        content.setStatus("Error: " + lastError);
+        content.setContent(pageText, {});
+    } else {
+        pageText = std::make_shared<const std::string>(std::move(page.text));
+        page.text.clear();
+        content.setStatus(status_line(status, page));
+        content.setContent(pageText, page.links);
+        if (status < 400) history().addAsync(pageUrl->href(), page.title, pageText);
+        if (sessionHistory.size() == kMaxSessionHistory) sessionHistory.erase(sessionHistory.begin());
+        sessionHistory.push_back(pageUrl->href());
+    }
+    reportAllocations();
+}
+
+void Browser::reportAllocations() {
+    if (!alloc_tracking_enabled()) return;
+    std::cout << "Allocations for " << url << ":\n"
+              << alloc_report(navigationAllocs, alloc_snapshot())
+              << "  " << allocatingFrames << " of " << framesSinceReport << " frames since the last page allocated\n";
+    framesSinceReport = 0;
+    allocatingFrames = 0;
+}
+
+void Browser::restoreSession() {
+    TRACE_SCOPE("startup", "restoreSession");
+    auto started = std::chrono::steady_clock::now();
+    SessionSnapshot snap;
+    if (!snap.open(session_path())) return;
+    for (std::size_t i = 0; i < snap.historyCount(); ++i) sessionHistory.emplace_back(snap.history(i));
+    pageUrl = Url::parse(snap.url());
+    if (!pageUrl) return;
+
+    url = pageUrl->href();
+    status = snap.status();
+    page = snap.page();
+    pageText = std::make_shared<const std::string>(std::move(page.text));
+    page.text.clear();
+    searchBar.setText(url);
+    content.setStatus(status_line(status, page) + " (restored)");
+    content.setContent(pageText, page.links);
+    content.scrollToAnchor(snap.scrollAnchor());
+
+    std::chrono::duration<double, std::milli> took = std::chrono::steady_clock::now() - started;
+    std::cout << std::fixed << std::setprecision(1) << "Startup: session restored in " << took.count() << " ms ("
+              << snap.size() / 1024 << " KB)\n";
+}
+
+void Browser::saveSession() {
+    SessionState state;
+    if (pageUrl && lastError.empty()) {
+        state.url = pageUrl->href();
+        state.status = status;
+        state.page = std::move(page);
+        state.page.text = *pageText;   // the view still shares the original; this copy lives only while saving
+        state.scrollAnchor = showingHistory ? pageAnchor : content.scrollAnchor();
+    }
+    state.history = sessionHistory;
+    if (!save_session(session_path(), state)) std::cerr << "Could not save the session to " << session_path() << "\n";
+}
+
+SearchIndex& Browser::history() {
+    if (!historyIndex) {
+        // Needed before the background open finished (or started): wait for it / open here
+        historyIndex = historyIndexLoading.valid() ? historyIndexLoading.get()
+                                                   : std::make_unique<SearchIndex>(history_index_dir());
+    }
+    return *historyIndex;
+}
+
+void Browser::onFrame() {
+    using Ms = std::chrono::duration<double, std::milli>;
+    if (!firstFrameShown) {
+        firstFrameShown = true;
+        Ms firstFrame = std::chrono::steady_clock::now() - startedAt;
+        std::cout << std::fixed << std::setprecision(1) << "Startup: first frame after " << firstFrame.count() << " ms";
+        if (firstFrame > kFirstFrameTarget) std::cout << " (target " << kFirstFrameTarget.count() << " ms)";
+        std::cout << "\n";
+
+        // Nothing below is needed to paint; do it off the UI thread now that something is on screen
+        historyIndexLoading = Executor::shared().submit([]{
+            http_global_init();
+            return std::make_unique<SearchIndex>(history_index_dir());
+        }, TaskPriority::Background);
+        return;
+    }
+    if (alloc_tracking_enabled()) {
+        // Window::draw ran just before this hook; a steady frame adds nothing to the draw phase
+        const std::uint64_t drawAllocs = alloc_snapshot()[AllocPhase::Draw].allocations;
+        ++framesSinceReport;
+        if (drawAllocs != lastFrameDrawAllocs) ++allocatingFrames;
+        lastFrameDrawAllocs = drawAllocs;
+    }
+    mainQueue->drain();
+    if (!interactive && (historyIndex || historyIndexLoading.wait_for(std::chrono::seconds(0)) == std::future_status::ready)) {
+        history();
+        interactive = true;
+        Ms ready = std::chrono::steady_clock::now() - startedAt;
+        std::cout << "Startup: interactive after " << ready.count() << " ms\n";
+    }
+}
+
+void Browser::showHistorySearch(const std::string& query) {
+    auto hits = history().search(query, 50);
+
+    std::string text;
+    std::vector<Link> links;
+    for (const auto& hit : hits) {
+        if (!text.empty()) text += "\n\n";
+        Link link;
+        link.text = hit.title.empty() ? hit.url : hit.title;
+        link.url = hit.url;
+        link.start_pos = text.size();
+        text += link.text;
+        link.end_pos = text.size();
+        links.push_back(std::move(link));
+        text += "\n" + hit.url;
+    }
+    if (!showingHistory) pageAnchor = content.scrollAnchor();
+    showingHistory = true;
+    content.setStatus("History search: " + std::to_string(hits.size()) + " results for \"" + query + "\"");
+    content.setContent(std::make_shared<const std::string>(text.empty() ? "No visited pages match." : std::move(text)), links);
 }
 
 void Browser::run() {
     window.run(searchBar, content);
+    saveSession();
 };
 
 const std::string& Browser::getUrl() const {
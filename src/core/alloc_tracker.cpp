@@ -0,0 +1,178 @@
+#include "core/alloc_tracker.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// One cache line per phase so threads in different phases do not contend
+struct alignas(64) PhaseCounters {
+    std::atomic<std::uint64_t> allocations {0};
+    std::atomic<std::uint64_t> frees {0};
+    std::atomic<std::uint64_t> bytes {0};
+    std::atomic<std::uint64_t> liveBytes {0};
+    std::atomic<std::uint64_t> peakLiveBytes {0};
+};
+
+// Constant-initialized, so usable by allocations made during static initialization
+PhaseCounters counters[kAllocPhaseCount];
+
+constexpr const char* kPhaseNames[kAllocPhaseCount] = {"other", "fetch", "decode", "parse", "links", "layout", "draw"};
+
+std::string format_bytes(std::uint64_t bytes) {
+    char buf[32];
+    if (bytes >= 10 * 1024 * 1024) std::snprintf(buf, sizeof buf, "%.1f MB", static_cast<double>(bytes) / (1024.0 * 1024.0));
+    else if (bytes >= 10 * 1024) std::snprintf(buf, sizeof buf, "%.1f KB", static_cast<double>(bytes) / 1024.0);
+    else std::snprintf(buf, sizeof buf, "%llu B", static_cast<unsigned long long>(bytes));
+    return buf;
+}
+
+#ifdef MINI_BROWSER_ALLOC_TRACKING
+
+// Every block carries this header just before the pointer handed out
+struct alignas(16) BlockHeader {
+    std::uint64_t size;
+    std::uint8_t phase;
+};
+static_assert(sizeof(BlockHeader) == 16);
+
+constexpr std::size_t kHeaderSize = sizeof(BlockHeader);
+
+void count_alloc(std::size_t size, AllocPhase phase) {
+    PhaseCounters& c = counters[static_cast<std::size_t>(phase)];
+    c.allocations.fetch_add(1, std::memory_order_relaxed);
+    c.bytes.fetch_add(size, std::memory_order_relaxed);
+    const std::uint64_t live = c.liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    std::uint64_t peak = c.peakLiveBytes.load(std::memory_order_relaxed);
+    while (live > peak && !c.peakLiveBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+void count_free(const BlockHeader& header) {
+    PhaseCounters& c = counters[header.phase];
+    c.frees.fetch_add(1, std::memory_order_relaxed);
+    c.liveBytes.fetch_sub(header.size, std::memory_order_relaxed);
+}
+
+// `offset` is the header size rounded up to the alignment, so the user pointer stays aligned
+void* tracked_alloc(std::size_t size, std::size_t alignment) {
+    const std::size_t offset = alignment > kHeaderSize ? alignment : kHeaderSize;
+    void* base;
+    if (alignment > kHeaderSize) {
+        const std::size_t total = (offset + size + alignment - 1) / alignment * alignment;
+        base = std::aligned_alloc(alignment, total);
+    } else {
+        base = std::malloc(offset + size);
+    }
+    if (!base) return nullptr;
+    char* user = static_cast<char*>(base) + offset;
+    const AllocPhase phase = alloc_detail::phase;
+    ::new (user - kHeaderSize) BlockHeader{size, static_cast<std::uint8_t>(phase)};
+    count_alloc(size, phase);
+    return user;
+}
+
+void tracked_free(void* p, std::size_t alignment) {
+    if (!p) return;
+    char* user = static_cast<char*>(p);
+    count_free(*reinterpret_cast<const BlockHeader*>(user - kHeaderSize));
+    std::free(user - (alignment > kHeaderSize ? alignment : kHeaderSize));
+}
+
+void* tracked_alloc_or_throw(std::size_t size, std::size_t alignment) {
+    void* p = tracked_alloc(size, alignment);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+constexpr std::size_t kDefaultAlignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+#endif
+
+}
+
+#ifdef MINI_BROWSER_ALLOC_TRACKING
+
+void* operator new(std::size_t size) { return tracked_alloc_or_throw(size, kDefaultAlignment); }
+void* operator new[](std::size_t size) { return tracked_alloc_or_throw(size, kDefaultAlignment); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return tracked_alloc(size, kDefaultAlignment); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return tracked_alloc(size, kDefaultAlignment); }
+void* operator new(std::size_t size, std::align_val_t a) { return tracked_alloc_or_throw(size, static_cast<std::size_t>(a)); }
+void* operator new[](std::size_t size, std::align_val_t a) { return tracked_alloc_or_throw(size, static_cast<std::size_t>(a)); }
+void* operator new(std::size_t size, std::align_val_t a, const std::nothrow_t&) noexcept {
+    return tracked_alloc(size, static_cast<std::size_t>(a));
+}
+void* operator new[](std::size_t size, std::align_val_t a, const std::nothrow_t&) noexcept {
+    return tracked_alloc(size, static_cast<std::size_t>(a));
+}
+
+void operator delete(void* p) noexcept { tracked_free(p, kDefaultAlignment); }
+void operator delete[](void* p) noexcept { tracked_free(p, kDefaultAlignment); }
+void operator delete(void* p, std::size_t) noexcept { tracked_free(p, kDefaultAlignment); }
+void operator delete[](void* p, std::size_t) noexcept { tracked_free(p, kDefaultAlignment); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { tracked_free(p, kDefaultAlignment); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { tracked_free(p, kDefaultAlignment); }
+void operator delete(void* p, std::align_val_t a) noexcept { tracked_free(p, static_cast<std::size_t>(a)); }
+void operator delete[](void* p, std::align_val_t a) noexcept { tracked_free(p, static_cast<std::size_t>(a)); }
+void operator delete(void* p, std::size_t, std::align_val_t a) noexcept { tracked_free(p, static_cast<std::size_t>(a)); }
+void operator delete[](void* p, std::size_t, std::align_val_t a) noexcept { tracked_free(p, static_cast<std::size_t>(a)); }
+void operator delete(void* p, std::align_val_t a, const std::nothrow_t&) noexcept {
+    tracked_free(p, static_cast<std::size_t>(a));
+}
+void operator delete[](void* p, std::align_val_t a, const std::nothrow_t&) noexcept {
+    tracked_free(p, static_cast<std::size_t>(a));
+}
+
+bool alloc_tracking_enabled() {
+    return true;
+}
+
+#else
+
+bool alloc_tracking_enabled() {
+    return false;
+}
+
+#endif
+
+const char* alloc_phase_name(AllocPhase phase) {
+    const auto i = static_cast<std::size_t>(phase);
+    return i < kAllocPhaseCount ? kPhaseNames[i] : "?";
+}
+
+AllocSnapshot alloc_snapshot() {
+    AllocSnapshot snap;
+    for (std::size_t i = 0; i < kAllocPhaseCount; ++i) {
+        const PhaseCounters& c = counters[i];
+        snap.phases[i] = AllocCounters{c.allocations.load(std::memory_order_relaxed),
+                                       c.frees.load(std::memory_order_relaxed),
+                                       c.bytes.load(std::memory_order_relaxed),
+                                       c.liveBytes.load(std::memory_order_relaxed),
+                                       c.peakLiveBytes.load(std::memory_order_relaxed)};
+    }
+    return snap;
+}
+
+void alloc_reset_peaks() {
+    for (PhaseCounters& c : counters) c.peakLiveBytes.store(c.liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+std::string alloc_report(const AllocSnapshot& before, const AllocSnapshot& after) {
+    std::string out;
+    char line[160];
+    std::snprintf(line, sizeof line, "  %-8s %12s %12s %12s\n", "phase", "allocations", "bytes", "peak live");
+    out += line;
+    for (std::size_t i = 0; i < kAllocPhaseCount; ++i) {
+        const AllocCounters& a = before.phases[i];
+        const AllocCounters& b = after.phases[i];
+        if (b.allocations == a.allocations) continue;
+        const std::uint64_t peak = b.peakLiveBytes > a.liveBytes ? b.peakLiveBytes - a.liveBytes : 0;
+        std::snprintf(line, sizeof line, "  %-8s %12llu %12s %12s\n", kPhaseNames[i],
+                      static_cast<unsigned long long>(b.allocations - a.allocations),
+                      format_bytes(b.bytes - a.bytes).c_str(), format_bytes(peak).c_str());
+        out += line;
+    }
+    return out;
+}
@@ -0,0 +1,358 @@
+#include "core/charset.h"
+#include "core/alloc_tracker.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+constexpr std::uint64_t kHighBits = 0x8080808080808080ULL;
+constexpr std::size_t kMetaPrescan = 1024;
+constexpr char32_t kReplacement = 0xFFFD;
+
+std::uint64_t load64(const char* p) {
+    std::uint64_t word;
+    std::memcpy(&word, p, sizeof(word));
+    return word;
+}
+
+// Index of the first byte >= 0x80 at or after i (or n); tests 32 bytes per step
+std::size_t skip_ascii(const char* p, std::size_t i, std::size_t n) {
+    while (i + 32 <= n) {
+        std::uint64_t any = load64(p + i) | load64(p + i + 8) | load64(p + i + 16) | load64(p + i + 24);
+        if (any & kHighBits) break;
+        i += 32;
+    }
+    while (i + 8 <= n) {
+        std::uint64_t high = load64(p + i) & kHighBits;
+        if (high) return i + (static_cast<std::size_t>(__builtin_ctzll(high)) >> 3);
+        i += 8;
+    }
+    while (i < n && static_cast<unsigned char>(p[i]) < 0x80) ++i;
+    return i;
+}
+
+// Per lead byte: sequence length (0 = not a lead byte) and allowed range of the second byte
+struct LeadInfo {
+    unsigned char len, lo, hi;
+};
+
+constexpr std::array<LeadInfo, 256> kLead = [] {
+    std::array<LeadInfo, 256> t {};
+    for (int c = 0; c < 0x80; ++c) t[c] = {1, 0, 0};
+    for (int c = 0xC2; c <= 0xDF; ++c) t[c] = {2, 0x80, 0xBF};
+    for (int c = 0xE0; c <= 0xEF; ++c) t[c] = {3, 0x80, 0xBF};
+    for (int c = 0xF0; c <= 0xF4; ++c) t[c] = {4, 0x80, 0xBF};
+    t[0xE0].lo = 0xA0;   // overlong
+    t[0xED].hi = 0x9F;   // surrogates
+    t[0xF0].lo = 0x90;   // overlong
+    t[0xF4].hi = 0x8F;   // above U+10FFFF
+    return t;
+}();
+
+/**
+ * Decode one multi-byte sequence starting at p[i] (p[i] >= 0x80)
+ * @return Sequence length, or 0 if malformed
+ */
+inline std::size_t decode_sequence(const unsigned char* p, std::size_t i, std::size_t n, char32_t& cp) {
+    const unsigned char c = p[i];
+    const LeadInfo lead = kLead[c];
+    if (lead.len < 2 || n - i < lead.len) return 0;
+    const unsigned char c1 = p[i + 1];
+    if (c1 < lead.lo || c1 > lead.hi) return 0;
+    if (lead.len == 2) {
+        cp = (static_cast<char32_t>(c & 0x1F) << 6) | (c1 & 0x3F);
+        return 2;
+    }
+    const unsigned char c2 = p[i + 2];
+    if ((c2 & 0xC0) != 0x80) return 0;
+    if (lead.len == 3) {
+        cp = (static_cast<char32_t>(c & 0x0F) << 12) | (static_cast<char32_t>(c1 & 0x3F) << 6) | (c2 & 0x3F);
+        return 3;
+    }
+    const unsigned char c3 = p[i + 3];
+    if ((c3 & 0xC0) != 0x80) return 0;
+    cp = (static_cast<char32_t>(c & 0x07) << 18) | (static_cast<char32_t>(c1 & 0x3F) << 12)
+         | (static_cast<char32_t>(c2 & 0x3F) << 6) | (c3 & 0x3F);
+    return 4;
+}
+
+void append_utf8(std::string& out, char32_t cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+// windows-1252 bytes 0x80-0x9F; the rest of the upper half equals Latin-1
+constexpr char16_t kWindows1252High[32] = {
+    0x20AC, 0x0081, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021,
+    0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0x008D, 0x017D, 0x008F,
+    0x0090, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014,
+    0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0x009D, 0x017E, 0x0178,
+};
+
+// UTF-8 encoding of every windows-1252 byte >= 0x80
+struct Encoded {
+    char bytes[3];
+    unsigned char len;
+};
+
+constexpr std::array<Encoded, 128> kWindows1252Utf8 = [] {
+    std::array<Encoded, 128> t {};
+    for (int c = 0x80; c < 0x100; ++c) {
+        char32_t cp = c < 0xA0 ? kWindows1252High[c - 0x80] : static_cast<char32_t>(c);
+        Encoded& e = t[c - 0x80];
+        if (cp < 0x800) {
+            e = {{static_cast<char>(0xC0 | (cp >> 6)), static_cast<char>(0x80 | (cp & 0x3F)), 0}, 2};
+        } else {
+            e = {{static_cast<char>(0xE0 | (cp >> 12)), static_cast<char>(0x80 | ((cp >> 6) & 0x3F)),
+                  static_cast<char>(0x80 | (cp & 0x3F))}, 3};
+        }
+    }
+    return t;
+}();
+
+char to_lower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+bool is_label_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+}
+
+std::size_t find_ci(std::string_view haystack, std::string_view needle, std::size_t from = 0) {
+    if (needle.size() > haystack.size()) return std::string_view::npos;
+    for (std::size_t i = from; i + needle.size() <= haystack.size(); ++i) {
+        std::size_t k = 0;
+        while (k < needle.size() && to_lower(haystack[i + k]) == needle[k]) ++k;
+        if (k == needle.size()) return i;
+    }
+    return std::string_view::npos;
+}
+
+// Value following "charset" in s (after '=' and optional quotes), or empty
+std::string_view charset_parameter(std::string_view s) {
+    std::size_t pos = 0;
+    while ((pos = find_ci(s, "charset", pos)) != std::string_view::npos) {
+        std::size_t i = pos + 7;
+        while (i < s.size() && is_label_space(s[i])) ++i;
+        if (i >= s.size() || s[i] != '=') {
+            pos = i;
+            continue;
+        }
+        ++i;
+        while (i < s.size() && is_label_space(s[i])) ++i;
+        if (i < s.size() && (s[i] == '"' || s[i] == '\'')) ++i;
+        std::size_t end = i;
+        while (end < s.size() && !is_label_space(s[end]) && s[end] != ';' && s[end] != '"' && s[end] != '\''
+               && s[end] != '>' && s[end] != '/') {
+            ++end;
+        }
+        return s.substr(i, end - i);
+    }
+    return {};
+}
+
+Charset meta_charset(std::string_view body) {
+    std::string_view head = body.substr(0, kMetaPrescan);
+    std::size_t pos = 0;
+    while ((pos = find_ci(head, "<meta", pos)) != std::string_view::npos) {
+        std::size_t end = head.find('>', pos);
+        if (end == std::string_view::npos) end = head.size();
+        Charset cs = charset_from_label(charset_parameter(head.substr(pos, end - pos)));
+        if (cs != Charset::Unknown) {
+            // A document that can declare its encoding in ASCII is not UTF-16
+            return (cs == Charset::Utf16Le || cs == Charset::Utf16Be) ? Charset::Utf8 : cs;
+        }
+        pos = end;
+    }
+    return Charset::Unknown;
+}
+
+std::string utf8_to_utf8(std::string_view body) {
+    std::string out;
+    out.reserve(body.size());
+    const auto* p = reinterpret_cast<const unsigned char*>(body.data());
+    const std::size_t n = body.size();
+    std::size_t i = 0;
+    while (i < n) {
+        std::size_t valid = i + valid_utf8_prefix(body.substr(i));
+        out.append(body.data() + i, valid - i);
+        if (valid >= n) break;
+        // One U+FFFD per truncated sequence, or per stray byte
+        append_utf8(out, kReplacement);
+        std::size_t expect = std::max<std::size_t>(1, kLead[p[valid]].len);
+        i = valid + 1;
+        while (i < n && i - valid < expect && (p[i] & 0xC0) == 0x80) ++i;
+    }
+    return out;
+}
+
+std::string windows1252_to_utf8(std::string_view body) {
+    std::string out;
+    const char* p = body.data();
+    const std::size_t n = body.size();
+    // Every input byte needs at most three output bytes
+    out.resize_and_overwrite(n * 3, [&](char* dst, std::size_t) {
+        char* o = dst;
+        std::size_t i = 0;
+        while (i < n) {
+            if (i + 8 <= n && (load64(p + i) & kHighBits) == 0) {
+                std::memcpy(o, p + i, 8);
+                o += 8;
+                i += 8;
+                continue;
+            }
+            unsigned char c = static_cast<unsigned char>(p[i++]);
+            if (c < 0x80) {
+                *o++ = static_cast<char>(c);
+            } else {
+                const Encoded& e = kWindows1252Utf8[c - 0x80];
+                std::memcpy(o, e.bytes, 3);
+                o += e.len;
+            }
+        }
+        return static_cast<std::size_t>(o - dst);
+    });
+    return out;
+}
+
+std::string utf16_to_utf8(std::string_view body, bool bigEndian) {
+    std::string out;
+    out.reserve(body.size());
+    const auto* p = reinterpret_cast<const unsigned char*>(body.data());
+    const std::size_t units = body.size() / 2;
+    auto unit = [&](std::size_t k) -> char32_t {
+        return bigEndian ? (p[2 * k] << 8) | p[2 * k + 1] : (p[2 * k + 1] << 8) | p[2 * k];
+    };
+    for (std::size_t k = 0; k < units; ++k) {
+        char32_t u = unit(k);
+        if (u >= 0xD800 && u <= 0xDBFF && k + 1 < units) {
+            char32_t low = unit(k + 1);
+            if (low >= 0xDC00 && low <= 0xDFFF) {
+                append_utf8(out, 0x10000 + ((u - 0xD800) << 10) + (low - 0xDC00));
+                ++k;
+                continue;
+            }
+        }
+        append_utf8(out, (u >= 0xD800 && u <= 0xDFFF) ? kReplacement : u);
+    }
+    if (body.size() % 2) append_utf8(out, kReplacement);
+    return out;
+}
+}
+
+Charset charset_from_label(std::string_view label) {
+    while (!label.empty() && is_label_space(label.front())) label.remove_prefix(1);
+    while (!label.empty() && is_label_space(label.back())) label.remove_suffix(1);
+    if (label.empty() || label.size() > 32) return Charset::Unknown;
+
+    std::string lower;
+    for (char c : label) lower += to_lower(c);
+
+    if (lower == "utf-8" || lower == "utf8" || lower == "unicode-1-1-utf-8") return Charset::Utf8;
+    if (lower == "windows-1252" || lower == "cp1252" || lower == "x-cp1252" || lower == "iso-8859-1"
+        || lower == "iso8859-1" || lower == "iso_8859-1" || lower == "latin1" || lower == "l1"
+        || lower == "us-ascii" || lower == "ascii") {
+        return Charset::Windows1252;
+    }
+    if (lower == "utf-16le" || lower == "utf-16") return Charset::Utf16Le;
+    if (lower == "utf-16be") return Charset::Utf16Be;
+    return Charset::Unknown;
+}
+
+const char* charset_name(Charset charset) {
+    switch (charset) {
+        case Charset::Utf8: return "utf-8";
+        case Charset::Windows1252: return "windows-1252";
+        case Charset::Utf16Le: return "utf-16le";
+        case Charset::Utf16Be: return "utf-16be";
+        case Charset::Unknown: break;
+    }
+    return "unknown";
+}
+
+Charset detect_charset(std::string_view contentType, std::string_view body) {
+    if (body.starts_with("\xEF\xBB\xBF")) return Charset::Utf8;
+    if (body.starts_with("\xFF\xFE")) return Charset::Utf16Le;
+    if (body.starts_with("\xFE\xFF")) return Charset::Utf16Be;
+
+    Charset cs = charset_from_label(charset_parameter(contentType));
+    if (cs != Charset::Unknown) return cs;
+
+    cs = meta_charset(body);
+    if (cs != Charset::Unknown) return cs;
+
+    return is_valid_utf8(body) ? Charset::Utf8 : Charset::Windows1252;
+}
+
+std::size_t valid_utf8_prefix(std::string_view text) {
+    const char* p = text.data();
+    const auto* u = reinterpret_cast<const unsigned char*>(p);
+    const std::size_t n = text.size();
+    std::size_t i = skip_ascii(p, 0, n);
+    while (i < n) {
+        if (u[i] < 0x80) {
+            // Long ASCII stretches go back to the word-at-a-time scan
+            if (n - i >= 8 && (load64(p + i) & kHighBits) == 0) {
+                i = skip_ascii(p, i + 8, n);
+            } else {
+                ++i;
+            }
+            continue;
+        }
+        char32_t cp;
+        std::size_t len = decode_sequence(u, i, n, cp);
+        if (len == 0) return i;
+        i += len;
+    }
+    return n;
+}
+
+std::string to_utf8(std::string_view body, Charset charset) {
+    AllocPhaseScope phase(AllocPhase::Decode);
+    switch (charset) {
+        case Charset::Windows1252:
+            return windows1252_to_utf8(body);
+        case Charset::Utf16Le:
+            if (body.starts_with("\xFF\xFE")) body.remove_prefix(2);
+            return utf16_to_utf8(body, false);
+        case Charset::Utf16Be:
+            if (body.starts_with("\xFE\xFF")) body.remove_prefix(2);
+            return utf16_to_utf8(body, true);
+        case Charset::Utf8:
+        case Charset::Unknown:
+            break;
+    }
+    if (body.starts_with("\xEF\xBB\xBF")) body.remove_prefix(3);
+    return utf8_to_utf8(body);
+}
+
+
+std::size_t decode_utf8(std::string_view text, std::size_t i, char32_t& cp) {
+    if (i >= text.size()) return 0;
+    const auto* u = reinterpret_cast<const unsigned char*>(text.data());
+    if (u[i] < 0x80) {
+        cp = u[i];
+        return 1;
+    }
+    const std::size_t len = decode_sequence(u, i, text.size(), cp);
+    if (len == 0) {
+        cp = kReplacement;
+        return 1;
+    }
+    return len;
+}
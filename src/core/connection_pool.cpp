@@ -0,0 +1,174 @@
+#include "core/connection_pool.h"
+#include "core/http_client.h"
+#include "core/trace.h"
+
+#include <algorithm>
+
+namespace {
+// Give up on a warm-up that takes longer than a user would wait anyway
+constexpr long kWarmupTimeoutMs = 5000;
+}
+
+ConnectionPool::ConnectionPool(std::size_t maxIdle, std::chrono::milliseconds idleTimeout)
+    : maxIdle_(std::max<std::size_t>(1, maxIdle)), idleTimeout_(idleTimeout) {}
+
+ConnectionPool::~ConnectionPool() {
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    cancelWarmup_ = true;
+    cv_.notify_all();
+    warmed_.notify_all();
+    if (worker_.joinable()) worker_.join();
+}
+
+void ConnectionPool::preconnect(const std::string& url) {
+    auto target = Url::parse(url);
+    if (!target || (target->scheme() != "http" && target->scheme() != "https")) return;
+    Origin origin = target->origin();
+    if (origin.isOpaque()) return;
+
+    {
+        std::lock_guard lock(mutex_);
+        if (stopping_ || warming_.contains(origin) || warming_.size() >= maxIdle_) return;
+        bool warm = std::any_of(idle_.begin(), idle_.end(), [&](const Idle& e) { return e.origin == origin; });
+        if (warm) return;
+        warming_.insert(origin);
+        queue_.push_back(origin);
+        startWorkerLocked();
+    }
+    cv_.notify_one();
+}
+
+CurlSession ConnectionPool::acquire(Origin origin, const std::atomic<bool>* cancel, std::chrono::milliseconds timeout) {
+    CurlSession session;
+    if (origin.isOpaque()) return session;
+
+    auto cancelled = [&] { return cancel && cancel->load(std::memory_order_relaxed); };
+    std::vector<CurlSession> closing;
+    {
+        std::unique_lock lock(mutex_);
+        if (running_ == origin) {
+            // Nothing signals the cancel flag, so wake once per poll interval to check it
+            const auto deadline = Clock::now() + std::min(timeout, kWarmupWait);
+            while (!stopping_ && running_ == origin && !cancelled() && Clock::now() < deadline) {
+                warmed_.wait_for(lock, std::min<Clock::duration>(CurlSession::kPollInterval, deadline - Clock::now()));
+            }
+            if (cancelled()) return session;
+        } else if (warming_.contains(origin)) {
+            // Queued behind other origins' warm-ups: connecting now is sooner
+            std::erase(queue_, origin);
+            warming_.erase(origin);
+            warmed_.notify_all();
+        }
+        evictLocked(0, closing);
+        // Newest handle for the origin is the least likely to have been dropped by the server
+        for (std::size_t i = idle_.size(); i-- > 0;) {
+            if (idle_[i].origin == origin) {
+                session = std::move(idle_[i].session);
+                idle_.erase(idle_.begin() + static_cast<std::ptrdiff_t>(i));
+                break;
+            }
+        }
+    }
+    session.reset();
+    return session;
+}
+
+void ConnectionPool::release(Origin origin, CurlSession session) {
+    if (!session.isOpen()) return;
+    std::vector<CurlSession> closing;
+    std::lock_guard lock(mutex_);
+    if (stopping_ || origin.isOpaque()) return;
+    evictLocked(1, closing);
+    idle_.push_back(Idle{origin, std::move(session), Clock::now()});
+    startWorkerLocked();   // expires the session if it stays unused
+    // Evicted sessions close when `closing` goes out of scope, after the lock is released
+}
+
+void ConnectionPool::waitForWarmups() {
+    std::unique_lock lock(mutex_);
+    warmed_.wait(lock, [&] { return stopping_ || warming_.empty(); });
+}
+
+std::size_t ConnectionPool::idleCount() const {
+    std::lock_guard lock(mutex_);
+    return idle_.size();
+}
+
+void ConnectionPool::evictLocked(std::size_t reserve, std::vector<CurlSession>& closing) {
+    auto now = Clock::now();
+    std::erase_if(idle_, [&](Idle& e) {
+        if (now - e.since < idleTimeout_) return false;
+        closing.push_back(std::move(e.session));
+        return true;
+    });
+    std::size_t excess = idle_.size() + reserve > maxIdle_ ? idle_.size() + reserve - maxIdle_ : 0;
+    excess = std::min(excess, idle_.size());
+    for (std::size_t i = 0; i < excess; ++i) closing.push_back(std::move(idle_[i].session));
+    idle_.erase(idle_.begin(), idle_.begin() + static_cast<std::ptrdiff_t>(excess));
+}
+
+void ConnectionPool::startWorkerLocked() {
+    if (!worker_.joinable()) worker_ = std::thread([this] { workerLoop(); });
+}
+
+void ConnectionPool::workerLoop() {
+    trace_set_thread_name("preconnect");
+    std::unique_lock lock(mutex_);
+    while (true) {
+        // Wake at least once per idle period to expire unused connections
+        cv_.wait_for(lock, idleTimeout_, [&] { return stopping_ || !queue_.empty(); });
+        if (stopping_) break;
+
+        std::vector<CurlSession> closing;
+        if (queue_.empty()) {
+            evictLocked(0, closing);
+            lock.unlock();
+            closing.clear();
+            lock.lock();
+            continue;
+        }
+
+        const Origin origin = queue_.front();
+        queue_.pop_front();
+        running_ = origin;
+        lock.unlock();
+
+        // HEAD of the origin's root resolves the host and completes TCP/TLS without
+        // transferring a body. A CONNECT_ONLY connection would be cheaper but curl
+        // never reuses one for a later transfer.
+        TRACE_SCOPE("net", "preconnect");
+        const std::string root = std::string(origin.str()) + "/";
+        CurlSession session;
+        if (session.open()) {
+            CURL* handle = session.easy();
+            curl_easy_setopt(handle, CURLOPT_URL, root.c_str());
+            curl_easy_setopt(handle, CURLOPT_NOBODY, 1L);
+            curl_easy_setopt(handle, CURLOPT_TIMEOUT_MS, kWarmupTimeoutMs);
+            curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT_MS, kWarmupTimeoutMs);
+            curl_easy_setopt(handle, CURLOPT_USERAGENT, "mini-browser/0.1");
+            curl_easy_setopt(handle, CURLOPT_MAXAGE_CONN, static_cast<long>(idleTimeout_.count() / 1000 + 1));
+#ifdef CURL_HTTP_VERSION_2TLS
+            curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+#endif
+            if (session.perform(&cancelWarmup_) != CURLE_OK) session = CurlSession();
+        }
+
+        lock.lock();
+        running_ = Origin();
+        warming_.erase(origin);
+        if (session.isOpen() && !stopping_) {
+            evictLocked(1, closing);
+            idle_.push_back(Idle{origin, std::move(session), Clock::now()});
+        }
+        warmed_.notify_all();
+        if (!closing.empty() || session.isOpen()) {
+            lock.unlock();
+            closing.clear();
+            session = CurlSession();
+            lock.lock();
+        }
+    }
+}
@@ -0,0 +1,290 @@
+#include "core/crawler.h"
+#include "core/charset.h"
+#include "core/connection_pool.h"
+#include "core/http_client.h"
+#include "core/thread_pool.h"
+#include "core/trace.h"
+#include "core/url.h"
+
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Same per-page limit the browser uses; a hostile page must not stall the crawl
+constexpr std::chrono::milliseconds kParseBudget {2000};
+
+using Clock = std::chrono::steady_clock;
+
+struct Entry {
+    std::string url;
+    std::size_t depth = 0;
+};
+
+std::size_t entry_bytes(const Entry& e) {
+    return sizeof(Entry) + e.url.capacity();
+}
+
+struct Host {
+    std::deque<Entry> queue;
+    Clock::time_point nextAllowed {};
+    std::size_t inflight = 0;
+};
+
+struct Fetched {
+    Entry entry;
+    Origin origin;
+    std::string finalUrl;
+    long status = 0;
+    std::string error;
+    std::size_t bytes = 0;
+    std::optional<ParsedPage> page;   ///< Set for successfully fetched HTML
+    std::string file;                 ///< Text file written for the page
+};
+
+bool is_html(const std::string& contentType) {
+    if (contentType.empty()) return true;
+    std::string lower(contentType);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return lower.find("html") != std::string::npos;
+}
+
+std::string fingerprint_name(std::string_view url) {
+    char name[24];
+    std::snprintf(name, sizeof(name), "%016llx.txt", static_cast<unsigned long long>(std::hash<std::string_view>{}(url)));
+    return name;
+}
+
+// Runs on a pool thread: fetch, decode, parse, resolve links, write the text
+Fetched fetch_page(Entry entry, Origin origin, const CrawlOptions& options, ConnectionPool& pool) {
+    TRACE_SCOPE("crawl", "fetch_page");
+    Fetched out;
+    out.origin = origin;
+    HttpResult r = http_get(entry.url, options.timeoutMs, &pool);
+    out.entry = std::move(entry);
+    out.status = r.status;
+    out.bytes = r.bodyView().size();
+    out.finalUrl = r.url.empty() ? out.entry.url : r.url;
+    if (!r.error.empty()) {
+        out.error = r.error;
+        return out;
+    }
+    if (r.status >= 400 || !is_html(r.content_type)) return out;
+
+    // A body above the spool threshold is mapped, not in r.body
+    std::string_view body = r.bodyView();
+    Charset charset = detect_charset(r.content_type, body);
+    std::string decoded;
+    if (charset != Charset::Utf8 || !is_valid_utf8(body)) {
+        decoded = to_utf8(body, charset);
+        body = decoded;
+    }
+    ParsedPage page = parse_html_basic(strip_utf8_bom(body), ParseOptions{kParseBudget, 1});
+    if (auto base = Url::parse(out.finalUrl)) resolve_links(page.links, *base);
+
+    if (!options.outputDir.empty()) {
+        out.file = fingerprint_name(out.finalUrl);
+        std::ofstream file(fs::path(options.outputDir) / out.file, std::ios::binary | std::ios::trunc);
+        file << out.finalUrl << "\n" << page.title << "\n\n" << page.text << "\n";
+        if (!file) out.file.clear();
+    }
+    out.page = std::move(page);
+    return out;
+}
+
+}
+
+VisitedSet::VisitedSet(std::size_t expected) {
+    slots_.assign(std::bit_ceil(std::max<std::size_t>(16, expected * 2)), 0);
+}
+
+std::uint64_t VisitedSet::fingerprint(std::string_view key) {
+    std::uint64_t h = std::hash<std::string_view>{}(key);
+    // Finalizer (splitmix64) so the low bits used for the slot index are well mixed
+    h ^= h >> 30; h *= 0xbf58476d1ce4e5b9ull;
+    h ^= h >> 27; h *= 0x94d049bb133111ebull;
+    h ^= h >> 31;
+    return h ? h : 1;
+}
+
+bool VisitedSet::insert(std::string_view key) {
+    if ((size_ + 1) * 2 > slots_.size()) grow();
+    const std::uint64_t fp = fingerprint(key);
+    const std::size_t mask = slots_.size() - 1;
+    for (std::size_t i = fp & mask;; i = (i + 1) & mask) {
+        if (slots_[i] == fp) return false;
+        if (slots_[i] == 0) {
+            slots_[i] = fp;
+            ++size_;
+            return true;
+        }
+    }
+}
+
+bool VisitedSet::contains(std::string_view key) const {
+    const std::uint64_t fp = fingerprint(key);
+    const std::size_t mask = slots_.size() - 1;
+    for (std::size_t i = fp & mask;; i = (i + 1) & mask) {
+        if (slots_[i] == fp) return true;
+        if (slots_[i] == 0) return false;
+    }
+}
+
+void VisitedSet::grow() {
+    std::vector<std::uint64_t> old(slots_.size() * 2, 0);
+    old.swap(slots_);
+    const std::size_t mask = slots_.size() - 1;
+    for (std::uint64_t fp : old) {
+        if (!fp) continue;
+        std::size_t i = fp & mask;
+        while (slots_[i]) i = (i + 1) & mask;
+        slots_[i] = fp;
+    }
+}
+
+CrawlStats crawl(const CrawlOptions& options, const CrawlPageCallback& onPage) {
+    TRACE_SCOPE("crawl", "crawl");
+    const auto started = Clock::now();
+    CrawlStats stats;
+    const std::size_t concurrency = std::max<std::size_t>(1, options.concurrency);
+    const std::size_t maxPerHost = std::max<std::size_t>(1, options.maxPerHost);
+
+    std::unordered_set<Origin> allowed;
+    for (const auto& o : options.allowedOrigins) {
+        if (auto u = Url::parse(o)) allowed.insert(u->origin());
+    }
+
+    VisitedSet visited;
+    std::unordered_map<Origin, Host> hosts;
+    std::deque<Origin> rotation;   ///< Hosts with queued URLs, served round-robin
+    std::size_t frontierSize = 0, frontierBytes = 0;
+
+    auto enqueue = [&](const Url& url, std::size_t depth) {
+        if (!visited.insert(url.cacheKey())) {
+            ++stats.duplicateLinks;
+            return;
+        }
+        Origin origin = url.origin();
+        Host& host = hosts[origin];
+        if (host.queue.empty()) rotation.push_back(origin);
+        host.queue.push_back(Entry{std::string(url.cacheKey()), depth});
+        ++frontierSize;
+        frontierBytes += entry_bytes(host.queue.back());
+        stats.frontierPeak = std::max(stats.frontierPeak, frontierSize);
+        stats.frontierPeakBytes = std::max(stats.frontierPeakBytes, frontierBytes);
+    };
+    auto inScope = [&](const std::optional<Url>& url) {
+        return url && (url->scheme() == "http" || url->scheme() == "https") && allowed.contains(url->origin());
+    };
+
+    for (const auto& seed : options.seeds) {
+        auto url = Url::fromUserInput(seed);
+        if (!url) continue;
+        if (options.allowedOrigins.empty()) allowed.insert(url->origin());
+        enqueue(*url, 0);
+    }
+
+    std::error_code ec;
+    std::ofstream index;
+    if (!options.outputDir.empty()) {
+        fs::create_directories(options.outputDir, ec);
+        index.open(fs::path(options.outputDir) / "index.tsv", std::ios::trunc);
+    }
+
+    ConnectionPool pool(concurrency);
+    std::mutex doneMutex;
+    std::condition_variable doneCv;
+    std::vector<Fetched> done;
+    std::size_t inflight = 0, dispatched = 0;
+    {
+        ThreadPool workers(concurrency);
+        while (true) {
+            // Start every fetch the limits allow, hosts taking turns
+            auto now = Clock::now();
+            std::optional<Clock::time_point> wakeAt;
+            for (std::size_t i = 0; i < rotation.size() && inflight < concurrency && dispatched < options.maxPages;) {
+                Origin origin = rotation[i];
+                Host& host = hosts[origin];
+                if (host.inflight >= maxPerHost) { ++i; continue; }
+                if (now < host.nextAllowed) {
+                    wakeAt = wakeAt ? std::min(*wakeAt, host.nextAllowed) : host.nextAllowed;
+                    ++i;
+                    continue;
+                }
+                Entry entry = std::move(host.queue.front());
+                host.queue.pop_front();
+                --frontierSize;
+                frontierBytes -= entry_bytes(entry);
+                rotation.erase(rotation.begin() + static_cast<std::ptrdiff_t>(i));
+                if (!host.queue.empty()) rotation.push_back(origin);
+
+                ++host.inflight;
+                host.nextAllowed = now + options.hostDelay;
+                ++inflight;
+                ++dispatched;
+                workers.submit([&, entry = std::move(entry), origin]() mutable {
+                    Fetched f = fetch_page(std::move(entry), origin, options, pool);
+                    std::lock_guard lock(doneMutex);
+                    done.push_back(std::move(f));
+                    doneCv.notify_one();
+                });
+            }
+            if (inflight == 0 && (rotation.empty() || dispatched >= options.maxPages)) break;
+
+            std::vector<Fetched> batch;
+            {
+                std::unique_lock lock(doneMutex);
+                auto ready = [&] { return !done.empty(); };
+                if (wakeAt && inflight < concurrency) doneCv.wait_until(lock, *wakeAt, ready);
+                else doneCv.wait(lock, ready);
+                batch.swap(done);
+            }
+
+            for (Fetched& f : batch) {
+                --inflight;
+                --hosts[f.origin].inflight;
+                stats.bytesFetched += f.bytes;
+                if (!f.page) {
+                    if (!f.error.empty() || f.status >= 400) ++stats.pagesFailed;
+                    continue;
+                }
+                ++stats.pagesFetched;
+                if (index.is_open()) index << f.finalUrl << '\t' << f.entry.depth << '\t' << f.file << '\n';
+                if (onPage) onPage(f.finalUrl, f.entry.depth, *f.page);
+
+                // A redirect may land on a page we would otherwise fetch again
+                auto landed = Url::parse(f.finalUrl);
+                if (landed) visited.insert(landed->cacheKey());
+                if (!inScope(landed)) continue;
+
+                for (const Link& link : f.page->links) {
+                    ++stats.linksSeen;
+                    auto target = Url::parse(link.url);
+                    if (!inScope(target)) {
+                        ++stats.offOriginLinks;
+                        continue;
+                    }
+                    if (f.entry.depth + 1 > options.maxDepth) continue;
+                    enqueue(*target, f.entry.depth + 1);
+                }
+            }
+        }
+    }
+
+    stats.visitedCount = visited.size();
+    stats.visitedBytes = visited.memoryBytes();
+    stats.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - started);
+    return stats;
+}
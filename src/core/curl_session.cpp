@@ -0,0 +1,75 @@
+#include "core/curl_session.h"
+#include "core/http_client.h"
+
+#include <utility>
+
+CurlSession::~CurlSession() {
+    close();
+}
+
+CurlSession::CurlSession(CurlSession&& other) noexcept
+    : multi_(std::exchange(other.multi_, nullptr)), easy_(std::exchange(other.easy_, nullptr)) {}
+
+CurlSession& CurlSession::operator=(CurlSession&& other) noexcept {
+    if (this != &other) {
+        close();
+        multi_ = std::exchange(other.multi_, nullptr);
+        easy_ = std::exchange(other.easy_, nullptr);
+    }
+    return *this;
+}
+
+bool CurlSession::open() {
+    close();
+    http_global_init();
+    multi_ = curl_multi_init();
+    easy_ = curl_easy_init();
+    if (!multi_ || !easy_) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void CurlSession::close() {
+    if (easy_) curl_easy_cleanup(easy_);
+    if (multi_) curl_multi_cleanup(multi_);
+    easy_ = nullptr;
+    multi_ = nullptr;
+}
+
+void CurlSession::reset() {
+    if (easy_) curl_easy_reset(easy_);
+}
+
+CURLcode CurlSession::perform(const std::atomic<bool>* cancel) {
+    if (!easy_) return CURLE_FAILED_INIT;
+    if (cancel && cancel->load(std::memory_order_relaxed)) return CURLE_ABORTED_BY_CALLBACK;
+    if (curl_multi_add_handle(multi_, easy_) != CURLM_OK) return CURLE_FAILED_INIT;
+
+    CURLcode result = CURLE_OK;
+    while (true) {
+        int running = 0;
+        if (curl_multi_perform(multi_, &running) != CURLM_OK) {
+            result = CURLE_FAILED_INIT;
+            break;
+        }
+        bool done = false;
+        int queued = 0;
+        while (CURLMsg* msg = curl_multi_info_read(multi_, &queued)) {
+            if (msg->msg == CURLMSG_DONE && msg->easy_handle == easy_) {
+                result = msg->data.result;
+                done = true;
+            }
+        }
+        if (done || running == 0) break;
+        if (cancel && cancel->load(std::memory_order_relaxed)) {
+            result = CURLE_ABORTED_BY_CALLBACK;
+            break;
+        }
+        curl_multi_poll(multi_, nullptr, 0, static_cast<int>(kPollInterval.count()), nullptr);
+    }
+    // Removing an unfinished transfer aborts it and closes its connection
+    curl_multi_remove_handle(multi_, easy_);
+    return result;
+}
@@ -0,0 +1,160 @@
+#include "core/executor.h"
+#include "core/trace.h"
+
+#include <algorithm>
+
+namespace {
+
+// Look for work this many rounds before sleeping, so a task posted right
+// after another finishes is picked up without a context switch. On one core
+// spinning only delays the thread that would post, so there is none.
+const int kSpinRounds = std::thread::hardware_concurrency() > 1 ? 256 : 0;
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+thread_local const Executor* current_executor = nullptr;
+thread_local std::size_t current_worker = 0;
+
+}
+
+void MainThreadQueue::post(Task task) {
+    std::lock_guard lock(mutex_);
+    tasks_.push_back(std::move(task));
+}
+
+std::size_t MainThreadQueue::drain() {
+    std::vector<Task> tasks;
+    {
+        std::lock_guard lock(mutex_);
+        tasks.swap(tasks_);
+    }
+    for (Task& task : tasks) task();
+    return tasks.size();
+}
+
+std::size_t MainThreadQueue::pending() const {
+    std::lock_guard lock(mutex_);
+    return tasks_.size();
+}
+
+Executor::Executor(std::size_t threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    queues_.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i) queues_.push_back(std::make_unique<Worker>());
+    workers_.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back([this, i] { workerLoop(i); });
+    }
+}
+
+Executor::~Executor() {
+    stopping_ = true;
+    {
+        std::lock_guard lock(sleepMutex_);
+    }
+    wake_.notify_all();
+    for (auto& t : workers_) t.join();
+}
+
+Executor& Executor::shared() {
+    static Executor executor;
+    return executor;
+}
+
+void Executor::post(Task task, TaskPriority priority) {
+    const auto p = static_cast<std::size_t>(priority);
+    if (current_executor == this) {
+        Worker& own = *queues_[current_worker];
+        std::lock_guard lock(own.mutex);
+        own.queues[p].push_back(std::move(task));
+    } else {
+        std::lock_guard lock(injectMutex_);
+        injected_[p].push_back(std::move(task));
+    }
+    ++pending_;
+    if (sleeping_ > 0) {
+        // Taking the lock orders this wake-up after a sleeper's check of pending_
+        { std::lock_guard lock(sleepMutex_); }
+        wake_.notify_one();
+    }
+}
+
+bool Executor::take(std::size_t self, Task& task) {
+    if (pending_ == 0) return false;
+    const std::size_t n = queues_.size();
+    for (std::size_t p = 0; p < kTaskPriorityCount; ++p) {
+        {
+            Worker& own = *queues_[self];
+            std::lock_guard lock(own.mutex);
+            if (!own.queues[p].empty()) {
+                task = std::move(own.queues[p].back());
+                own.queues[p].pop_back();
+                --pending_;
+                return true;
+            }
+        }
+        {
+            std::lock_guard lock(injectMutex_);
+            if (!injected_[p].empty()) {
+                task = std::move(injected_[p].front());
+                injected_[p].pop_front();
+                --pending_;
+                return true;
+            }
+        }
+        for (std::size_t k = 1; k < n; ++k) {
+            Worker& victim = *queues_[(self + k) % n];
+            std::lock_guard lock(victim.mutex);
+            if (!victim.queues[p].empty()) {
+                task = std::move(victim.queues[p].front());
+                victim.queues[p].pop_front();
+                --pending_;
+                ++stolen_;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool Executor::onWorker() const {
+    return current_executor == this;
+}
+
+bool Executor::runOne() {
+    Task task;
+    if (!take(current_worker, task)) return false;
+    task();
+    ++executed_;
+    return true;
+}
+
+void Executor::workerLoop(std::size_t index) {
+    current_executor = this;
+    current_worker = index;
+    trace_set_thread_name("executor");
+    while (true) {
+        bool ran = runOne();
+        for (int spin = 0; spin < kSpinRounds && !ran; ++spin) {
+            cpu_relax();
+            ran = runOne();
+        }
+        if (ran) continue;
+        if (stopping_ && pending_ == 0) return;
+
+        std::unique_lock lock(sleepMutex_);
+        ++sleeping_;
+        wake_.wait(lock, [this] { return pending_ > 0 || stopping_; });
+        --sleeping_;
+    }
+}
+
+ExecutorStats Executor::stats() const {
+    return ExecutorStats{executed_.load(), stolen_.load()};
+}
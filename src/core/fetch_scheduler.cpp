@@ -0,0 +1,152 @@
+#include "core/fetch_scheduler.h"
+#include "core/connection_pool.h"
+#include "core/trace.h"
+
+#include <algorithm>
+
+namespace {
+HttpResult cancelled_result() {
+    HttpResult r;
+    r.cancelled = true;
+    r.error = "cancelled";
+    return r;
+}
+}
+
+const char* fetch_priority_name(FetchPriority priority) {
+    switch (priority) {
+        case FetchPriority::Navigation: return "navigation";
+        case FetchPriority::Visible: return "visible";
+        case FetchPriority::Background: return "background";
+    }
+    return "unknown";
+}
+
+FetchScheduler::FetchScheduler(std::size_t maxActive, std::size_t maxPerHost, ConnectionPool* pool)
+    : maxActive_(std::max<std::size_t>(1, maxActive)), maxPerHost_(std::max<std::size_t>(1, maxPerHost)), pool_(pool) {}
+
+FetchScheduler::~FetchScheduler() {
+    std::vector<Job> dropped;
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+        for (auto& flag : running_) flag->store(true);
+        for (auto& lane : lanes_) {
+            for (auto& [origin, jobs] : lane.jobs) {
+                for (auto& job : jobs) dropped.push_back(std::move(job));
+            }
+            lane.jobs.clear();
+            lane.hosts.clear();
+        }
+    }
+    cv_.notify_all();
+    for (auto& job : dropped) job.done(cancelled_result());
+    for (auto& worker : workers_) worker.join();
+}
+
+std::future<HttpResult> FetchScheduler::submit(const std::string& url, FetchPriority priority,
+                                               std::shared_ptr<std::atomic<bool>> cancel, int timeout_ms) {
+    auto promise = std::make_shared<std::promise<HttpResult>>();
+    std::future<HttpResult> result = promise->get_future();
+    submit(url, priority, std::move(cancel), timeout_ms,
+           [promise](HttpResult r) { promise->set_value(std::move(r)); });
+    return result;
+}
+
+void FetchScheduler::submit(const std::string& url, FetchPriority priority, std::shared_ptr<std::atomic<bool>> cancel,
+                            int timeout_ms, std::move_only_function<void(HttpResult)> onDone) {
+    Job job;
+    job.url = url;
+    if (auto parsed = Url::parse(url)) job.origin = parsed->origin();
+    job.priority = priority;
+    job.timeoutMs = timeout_ms;
+    job.cancel = cancel ? std::move(cancel) : std::make_shared<std::atomic<bool>>(false);
+    job.queuedAt = Clock::now();
+    job.done = std::move(onDone);
+
+    {
+        std::unique_lock lock(mutex_);
+        if (stopping_) {
+            lock.unlock();
+            job.done(cancelled_result());
+            return;
+        }
+        Lane& lane = lanes_[static_cast<std::size_t>(priority)];
+        auto& queue = lane.jobs[job.origin];
+        if (queue.empty()) lane.hosts.push_back(job.origin);
+        queue.push_back(std::move(job));
+        ++stats_.byPriority[static_cast<std::size_t>(priority)].queued;
+        if (workers_.empty()) {
+            for (std::size_t i = 0; i < maxActive_; ++i) workers_.emplace_back([this] { workerLoop(); });
+        }
+    }
+    cv_.notify_one();
+}
+
+FetchMetrics FetchScheduler::metrics() const {
+    std::lock_guard lock(mutex_);
+    FetchMetrics m = stats_;
+    m.active = running_.size();
+    for (const auto& [origin, count] : active_) m.activePerHost.emplace_back(origin.str(), count);
+    std::sort(m.activePerHost.begin(), m.activePerHost.end());
+    return m;
+}
+
+std::optional<FetchScheduler::Job> FetchScheduler::pickLocked() {
+    if (running_.size() >= maxActive_) return std::nullopt;
+    for (Lane& lane : lanes_) {
+        for (std::size_t i = 0; i < lane.hosts.size(); ++i) {
+            Origin origin = lane.hosts[i];
+            auto busy = active_.find(origin);
+            if (busy != active_.end() && busy->second >= maxPerHost_) continue;
+
+            auto queue = lane.jobs.find(origin);
+            Job job = std::move(queue->second.front());
+            queue->second.pop_front();
+            // The host goes to the back of the rotation, or leaves it when drained
+            lane.hosts.erase(lane.hosts.begin() + static_cast<std::ptrdiff_t>(i));
+            if (queue->second.empty()) lane.jobs.erase(queue);
+            else lane.hosts.push_back(origin);
+            return job;
+        }
+    }
+    return std::nullopt;
+}
+
+void FetchScheduler::workerLoop() {
+    trace_set_thread_name("fetch");
+    std::unique_lock lock(mutex_);
+    while (true) {
+        std::optional<Job> job;
+        while (!stopping_ && !(job = pickLocked())) cv_.wait(lock);
+        if (stopping_) return;
+
+        auto wait = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - job->queuedAt);
+        FetchClassMetrics& cls = stats_.byPriority[static_cast<std::size_t>(job->priority)];
+        --cls.queued;
+        ++cls.started;
+        cls.totalWait += wait;
+        cls.maxWait = std::max(cls.maxWait, wait);
+
+        if (job->cancel->load()) {
+            lock.unlock();
+            job->done(cancelled_result());
+            lock.lock();
+            continue;
+        }
+
+        ++active_[job->origin];
+        running_.push_back(job->cancel);
+        lock.unlock();
+
+        HttpResult r = http_get(job->url, job->timeoutMs, pool_, job->cancel.get());
+
+        lock.lock();
+        if (--active_[job->origin] == 0) active_.erase(job->origin);
+        running_.erase(std::find(running_.begin(), running_.end(), job->cancel));
+        // Only the slot this worker held was freed, so it picks the next job itself: no wake-up needed
+        lock.unlock();
+        job->done(std::move(r));
+        lock.lock();
+    }
+}
@@ -1,44 +1,114 @@
 #include "core/html_parser.h"
 
+#include "core/alloc_tracker.h"
+#include "core/executor.h"
+#include "core/trace.h"
+
 #include <algorithm>
+#include <atomic>
 #include <cctype>
-#include <sstream>
+#include <cstring>
+#include <ctime>
 #include <string>
+#include <string_view>
 
 namespace {
 
-static std::string to_lower(std::string s) {
-    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c){ return std::tolower(c); });
-    return s;
+static char lower_ascii(char c) {
+    return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
 }
 
-static void erase_range(std::string& s, std::size_t pos, std::size_t len) {
-    if (pos < s.size()) s.erase(pos, std::min(len, s.size() - pos));
+// Case-insensitive compare of s[pos..] against a lowercase literal
+static bool starts_with_ci(std::string_view s, std::size_t pos, std::string_view lit) {
+    if (pos > s.size() || s.size() - pos < lit.size()) return false;
+    for (std::size_t k = 0; k < lit.size(); ++k) {
+        if (lower_ascii(s[pos + k]) != lit[k]) return false;
+    }
+    return true;
 }
 
-static void strip_blocks(std::string& s, const std::string& openTag, const std::string& closeTag) {
-    // Remove blocks like <script ...> ... </script> (case-insensitive)
-    std::string sl = to_lower(s);
-    std::string o = to_lower(openTag);
-    std::string c = to_lower(closeTag);
-    std::size_t p = 0;
-    while (true) {
-        p = sl.find(o, p);
-        if (p == std::string::npos) break;
-        std::size_t end = sl.find(c, p + o.size());
-        if (end == std::string::npos) {
-            // remove rest
-            erase_range(s, p, s.size() - p);
-            break;
-        } else {
-            // include close tag length
-            std::size_t len = (end - p) + c.size();
-            erase_range(s, p, len);
-            sl = to_lower(s);
-        }
+// Case-insensitive find of a lowercase literal starting with '<'. Only positions
+// holding '<' are compared, so the scan stays linear for the short tag needles used here.
+static std::size_t find_tag_ci(std::string_view s, std::string_view lit, std::size_t from) {
+    while (from < s.size()) {
+        const void* hit = std::memchr(s.data() + from, '<', s.size() - from);
+        if (!hit) return std::string_view::npos;
+        std::size_t p = static_cast<std::size_t>(static_cast<const char*>(hit) - s.data());
+        if (starts_with_ci(s, p, lit)) return p;
+        from = p + 1;
     }
+    return std::string_view::npos;
 }
 
+// Thread CPU time in nanoseconds; used to enforce ParseOptions::cpu_budget
+static long long thread_cpu_ns() {
+    timespec ts {};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<long long>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+// CPU budget shared by every thread working on one document. Each thread
+// charges its own CPU time through a BudgetMeter.
+class CpuBudget {
+public:
+    explicit CpuBudget(std::chrono::milliseconds budget)
+        : limit_ns_(std::chrono::duration_cast<std::chrono::nanoseconds>(budget).count()) {}
+
+    bool limited() const { return limit_ns_ > 0; }
+
+    // Add CPU time spent by a worker; returns true once the budget is exhausted
+    bool charge(long long ns) {
+        if (!limited()) return false;
+        return used_ns_.fetch_add(ns, std::memory_order_relaxed) + ns > limit_ns_;
+    }
+
+private:
+    long long limit_ns_;
+    std::atomic<long long> used_ns_ {0};
+};
+
+class BudgetMeter {
+public:
+    explicit BudgetMeter(CpuBudget& budget)
+        : budget_(budget), last_ns_(budget.limited() ? thread_cpu_ns() : 0) {}
+
+    bool exceeded() {
+        if (!budget_.limited()) return false;
+        long long now = thread_cpu_ns();
+        bool over = budget_.charge(now - last_ns_);
+        last_ns_ = now;
+        return over;
+    }
+
+private:
+    CpuBudget& budget_;
+    long long last_ns_;
+};
+
+// Memoised "next occurrence of c at or after pos". Positions only move forward
+// during a parse, so repeated lookups (e.g. unterminated quotes) cost O(n) in total.
+class NextChar {
+public:
+    NextChar(std::string_view s, char c) : s_(s), c_(c) {}
+
+    std::size_t find(std::size_t from) {
+        if (searched_ && from >= searched_from_ && (hit_ == std::string_view::npos || hit_ >= from)) {
+            return hit_;
+        }
+        searched_ = true;
+        searched_from_ = from;
+        hit_ = s_.find(c_, from);
+        return hit_;
+    }
+
+private:
+    std::string_view s_;
+    char c_;
+    bool searched_ = false;
+    std::size_t searched_from_ = 0;
+    std::size_t hit_ = std::string_view::npos;
+};
+
 static std::string strip_tags(const std::string& s) {
     std::string out;
     out.reserve(s.size());
@@ -51,22 +121,48 @@ static std::string strip_tags(const std::string& s) {
     return out;
 }
 
-// Replace occurrences of specific HTML tags with newlines (case-insensitive)
-static void replace_all_ci(std::string& s, const std::string& needle, const std::string& repl) {
-    if (needle.empty()) return;
-    std::string lower = to_lower(s);
-    std::string nlow = to_lower(needle);
-    std::size_t pos = 0;
-    while ((pos = lower.find(nlow, pos)) != std::string::npos) {
-        s.replace(pos, needle.size(), repl);
-        lower.replace(pos, needle.size(), repl);
-        pos += repl.size();
+// Decoding only shrinks the text, so one reservation covers the output
+static std::string decode_entities(const std::string& s) {
+    std::string out;
+    out.reserve(s.size());
+    for (std::size_t i = 0; i < s.size(); ++i) {
+        if (s[i] == '&') {
+            if (s.compare(i, 5, "&amp;") == 0) { out.push_back('&'); i += 4; }
+            else if (s.compare(i, 4, "&lt;") == 0) { out.push_back('<'); i += 3; }
+            else if (s.compare(i, 4, "&gt;") == 0) { out.push_back('>'); i += 3; }
+            else if (s.compare(i, 6, "&quot;") == 0) { out.push_back('"'); i += 5; }
+            else if (s.compare(i, 6, "&apos;") == 0) { out.push_back('\''); i += 5; }
+            else {
+                out.push_back('&');
+            }
+        } else {
+            out.push_back(s[i]);
+        }
     }
+    return out;
 }
 
-static void normalize_linebreak_tags(std::string& s) {
-    // line-break-like tags to map to '\n'
-    const char* brTags[] = {
+// Trim each line and drop empty ones, working on views into the input
+static std::string trim_lines(const std::string& s) {
+    std::string out;
+    out.reserve(s.size());
+    std::string_view rest(s);
+    while (!rest.empty()) {
+        std::size_t nl = rest.find('\n');
+        std::string_view line = rest.substr(0, nl);
+        rest = nl == std::string_view::npos ? std::string_view() : rest.substr(nl + 1);
+        auto begin = line.find_first_not_of(" \t\r");
+        if (begin == std::string_view::npos) continue;
+        auto end = line.find_last_not_of(" \t\r");
+        if (!out.empty()) out.push_back('\n');
+        out.append(line.substr(begin, end - begin + 1));
+    }
+    return out;
+}
+
+// Line-break-like tags that map to '\n' (matched exactly, case-insensitive)
+static bool is_linebreak_tag(std::string_view tag) {
+    static constexpr std::string_view brTags[] = {
         "<br>", "<br/>", "<br />",
         "<hr>", "<hr/>", "<hr />",
         "</p>", "<p>",
@@ -74,140 +170,337 @@ static void normalize_linebreak_tags(std::string& s) {
         "</h1>", "</h2>", "</h3>", "</h4>", "</h5>", "</h6>",
         "</li>", "</ul>", "</ol>"
     };
-    for (const char* t : brTags) {
-        replace_all_ci(s, t, "\n");
+    for (std::string_view t : brTags) {
+        if (tag.size() == t.size() && starts_with_ci(tag, 0, t)) return true;
     }
+    return false;
 }
 
-static std::string decode_entities(const std::string& s) {
-    std::ostringstream out;
-    for (std::size_t i = 0; i < s.size(); ++i) {
-        if (s[i] == '&') {
-            if (s.compare(i, 5, "&amp;") == 0) { out << '&'; i += 4; }
-            else if (s.compare(i, 4, "&lt;") == 0) { out << '<'; i += 3; }
-            else if (s.compare(i, 4, "&gt;") == 0) { out << '>'; i += 3; }
-            else if (s.compare(i, 6, "&quot;") == 0) { out << '"'; i += 5; }
-            else if (s.compare(i, 6, "&apos;") == 0) { out << '\''; i += 5; }
-            else {
-                out << '&';
-            }
-        } else {
-            out << s[i];
+enum class TagKind { Other, LineBreak, AnchorOpen, AnchorClose };
+
+struct TagScan {
+    std::size_t next;        ///< Index just past the tag (or skipped block)
+    TagKind kind;
+    std::size_t hrefBegin;   ///< href value span for AnchorOpen
+    std::size_t hrefEnd;
+};
+
+/**
+ * Classifies the markup starting at a '<'. Shared by the tokenizer and the
+ * parallel pre-scan so both agree exactly on where tags, comments and
+ * script/style blocks end.
+ */
+class TagScanner {
+public:
+    explicit TagScanner(std::string_view html)
+        : in_(html), dquote_(html, '"'), squote_(html, '\'') {}
+
+    TagScan scan(std::size_t i) {
+        if (starts_with_ci(in_, i, "<!--")) return skip(i + 4, "-->");
+        if (starts_with_ci(in_, i, "<script")) return skipBlock(i + 7, "</script>");
+        if (starts_with_ci(in_, i, "<style")) return skipBlock(i + 6, "</style>");
+
+        std::size_t close = in_.find('>', i);
+        if (close == npos) return {in_.size(), TagKind::Other, 0, 0}; // unterminated tag swallows the rest
+
+        std::string_view t = in_.substr(i, close - i + 1);
+        if (is_linebreak_tag(t)) return {close + 1, TagKind::LineBreak, 0, 0};
+        if (t.size() > 3 && starts_with_ci(t, 0, "<a") && std::isspace(static_cast<unsigned char>(t[2]))) {
+            return anchor(i, close);
         }
+        if (t.size() == 4 && starts_with_ci(t, 0, "</a>")) return {close + 1, TagKind::AnchorClose, 0, 0};
+        return {close + 1, TagKind::Other, 0, 0};
     }
-    return out.str();
-}
 
-static std::string trim_lines(const std::string& s) {
-    std::istringstream in(s);
-    std::ostringstream out;
-    std::string line;
-    bool first = true;
-    while (std::getline(in, line)) {
-        // trim spaces
-        auto begin = line.find_first_not_of(" \t\r");
-        auto end = line.find_last_not_of(" \t\r");
-        if (begin == std::string::npos) continue;
-        line = line.substr(begin, end - begin + 1);
-        if (!first) out << '\n';
-        out << line;
-        first = false;
+private:
+    static constexpr std::size_t npos = std::string_view::npos;
+
+    TagScan skip(std::size_t from, std::string_view terminator) {
+        std::size_t end = in_.find(terminator, from);
+        return {end == npos ? in_.size() : end + terminator.size(), TagKind::Other, 0, 0};
     }
-    return out.str();
-}
 
-// Extract links from HTML: find <a href="...">text</a> and record positions
-static std::vector<Link> extract_links(const std::string& html, const std::string& plainText) {
-    std::vector<Link> links;
-    std::string lower = to_lower(html);
-    
-    size_t pos = 0;
-    while (true) {
-        // Find next <a tag
-        pos = lower.find("<a ", pos);
-        if (pos == std::string::npos) break;
-        
-        // Find href attribute
-        size_t href_start = lower.find("href=", pos);
-        if (href_start == std::string::npos || href_start > lower.find('>', pos)) {
-            pos++;
-            continue;
+    TagScan skipBlock(std::size_t from, std::string_view closeTag) {
+        std::size_t end = find_tag_ci(in_, closeTag, from);
+        return {end == npos ? in_.size() : end + closeTag.size(), TagKind::Other, 0, 0};
+    }
+
+    // Parse <a ...>; it opens a link only if it carries an href
+    TagScan anchor(std::size_t i, std::size_t close) {
+        std::size_t href = npos;
+        for (std::size_t p = i + 2; p + 5 <= close; ++p) {
+            if (starts_with_ci(in_, p, "href=")) { href = p + 5; break; }
         }
-        
-        href_start += 5; // skip "href="
-        char quote = html[href_start];
-        size_t href_end;
+        if (href == npos || href >= in_.size()) return {close + 1, TagKind::Other, 0, 0};
+
+        std::size_t hrefEnd;
+        char quote = in_[href];
         if (quote == '"' || quote == '\'') {
-            href_start++;
-            href_end = html.find(quote, href_start);
+            ++href;
+            hrefEnd = (quote == '"' ? dquote_ : squote_).find(href);
         } else {
-            href_end = html.find_first_of(" >", href_start);
+            hrefEnd = in_.find_first_of(" >", href);
+        }
+        if (hrefEnd == npos) return {close + 1, TagKind::Other, 0, 0};
+
+        // A quoted value may run past the first '>'
+        std::size_t tagClose = hrefEnd < close ? close : in_.find('>', hrefEnd);
+        if (tagClose == npos) return {in_.size(), TagKind::Other, 0, 0};
+        return {tagClose + 1, TagKind::AnchorOpen, href, hrefEnd};
+    }
+
+    std::string_view in_;
+    NextChar dquote_;
+    NextChar squote_;
+};
+
+/**
+ * Single-pass body tokenizer. Produces the same text as the former
+ * normalize -> strip script/style -> strip tags -> decode -> trim pipeline,
+ * and records link spans directly as their text is emitted instead of
+ * searching for the link text in the finished output afterwards.
+ */
+class BodyTokenizer {
+public:
+    BodyTokenizer(std::string_view html, ParsedPage& page, CpuBudget& budget)
+        : in_(html), page_(page), meter_(budget), tags_(html) {
+        page_.text.reserve(html.size() / 2);
+    }
+
+    void run() {
+        constexpr std::size_t kBudgetStride = 64 * 1024;
+        std::size_t nextCheck = kBudgetStride;
+        std::size_t i = 0;
+        while (i < in_.size()) {
+            if (i >= nextCheck) {
+                if (meter_.exceeded()) { page_.truncated = true; break; }
+                nextCheck = i + kBudgetStride;
+            }
+            char ch = in_[i];
+            if (ch == '<') {
+                i = tag(i);
+            } else if (ch == '&') {
+                i = entity(i);
+            } else {
+                // A stray '>' outside a tag is dropped, like any tag delimiter
+                if (ch != '>') emit(ch);
+                ++i;
+            }
+        }
+        // A link still open at the end has no </a> and is dropped
+    }
+
+private:
+    static constexpr std::size_t npos = std::string_view::npos;
+
+    // Handle the tag starting at '<' and return the index just past it
+    std::size_t tag(std::size_t i) {
+        TagScan t = tags_.scan(i);
+        switch (t.kind) {
+            case TagKind::LineBreak:
+                emit('\n');
+                break;
+            case TagKind::AnchorOpen:
+                if (!linkOpen_) {
+                    linkOpen_ = true;
+                    linkUrl_.assign(in_.substr(t.hrefBegin, t.hrefEnd - t.hrefBegin));
+                    linkStart_ = npos;
+                }
+                break;
+            case TagKind::AnchorClose:
+                closeLink();
+                break;
+            case TagKind::Other:
+                break;
+        }
+        return t.next;
+    }
+
+    void closeLink() {
+        if (!linkOpen_) return;
+        linkOpen_ = false;
+        if (linkStart_ == npos) return; // no visible text
+        Link link;
+        link.start_pos = linkStart_;
+        link.end_pos = page_.text.size();
+        link.text = page_.text.substr(link.start_pos, link.end_pos - link.start_pos);
+        link.url = std::move(linkUrl_);
+        page_.links.push_back(std::move(link));
+    }
+
+    std::size_t entity(std::size_t i) {
+        struct Entity { std::string_view name; char ch; };
+        static constexpr Entity entities[] = {
+            {"&amp;", '&'}, {"&lt;", '<'}, {"&gt;", '>'}, {"&quot;", '"'}, {"&apos;", '\''}
+        };
+        for (const auto& e : entities) {
+            if (in_.compare(i, e.name.size(), e.name) == 0) {
+                emit(e.ch);
+                return i + e.name.size();
+            }
+        }
+        emit('&');
+        return i + 1;
+    }
+
+    // Append one decoded character, trimming each line and dropping empty ones
+    void emit(char c) {
+        std::string& out = page_.text;
+        if (c == '\n') {
+            lineHasContent_ = false;
+            pendingWs_.clear();
+            return;
+        }
+        if (c == ' ' || c == '\t' || c == '\r') {
+            if (lineHasContent_) pendingWs_.push_back(c);
+            return;
+        }
+        if (!lineHasContent_) {
+            if (!out.empty()) out.push_back('\n');
+            lineHasContent_ = true;
+        } else if (!pendingWs_.empty()) {
+            out += pendingWs_;
+            pendingWs_.clear();
+        }
+        if (linkOpen_ && linkStart_ == npos) linkStart_ = out.size();
+        out.push_back(c);
+    }
+
+    std::string_view in_;
+    ParsedPage& page_;
+    BudgetMeter meter_;
+    TagScanner tags_;
+
+    bool lineHasContent_ = false;
+    std::string pendingWs_;
+
+    bool linkOpen_ = false;
+    std::string linkUrl_;
+    std::size_t linkStart_ = npos;
+};
+
+/**
+ * Pre-scan for chunk boundaries. A boundary is placed just after a '\n' that
+ * sits in plain text (outside tags, comments, script/style blocks) and
+ * outside an open link. At such a point the tokenizer has no pending state,
+ * so tokenizing the chunks independently and joining their non-empty texts
+ * with '\n' reproduces the serial output exactly.
+ */
+static std::vector<std::size_t> find_split_points(std::string_view html, std::size_t targetChunk) {
+    TRACE_SCOPE("parse", "find_split_points");
+    std::vector<std::size_t> splits;
+    TagScanner tags(html);
+    bool linkOpen = false;
+    std::size_t nextTarget = targetChunk;
+    std::size_t i = 0;
+    while (i < html.size()) {
+        const void* hit = std::memchr(html.data() + i, '<', html.size() - i);
+        std::size_t lt = hit ? static_cast<std::size_t>(static_cast<const char*>(hit) - html.data()) : html.size();
+
+        // Plain text run [i, lt): split at the first newline past the target
+        while (!linkOpen && nextTarget < lt) {
+            std::size_t from = std::max(i, nextTarget);
+            const void* nl = std::memchr(html.data() + from, '\n', lt - from);
+            if (!nl) break;
+            std::size_t split = static_cast<std::size_t>(static_cast<const char*>(nl) - html.data()) + 1;
+            if (split >= html.size()) break;
+            splits.push_back(split);
+            nextTarget = split + targetChunk;
+        }
+        if (lt == html.size()) break;
+
+        TagScan t = tags.scan(lt);
+        if (t.kind == TagKind::AnchorOpen) linkOpen = true;
+        else if (t.kind == TagKind::AnchorClose) linkOpen = false;
+        i = t.next;
+    }
+    return splits;
+}
+
+static std::string parse_title(std::string_view html) {
+    TRACE_SCOPE("parse", "parse_title");
+    auto t1 = find_tag_ci(html, "<title", 0);
+    if (t1 == std::string_view::npos) return {};
+    auto t1_end = html.find('>', t1);
+    auto t2 = find_tag_ci(html, "</title>", t1_end == std::string_view::npos ? t1 : t1_end);
+    if (t1_end == std::string_view::npos || t2 == std::string_view::npos || t2 <= t1_end) return {};
+    std::string title(html.substr(t1_end + 1, t2 - (t1_end + 1)));
+    return trim_lines(decode_entities(strip_tags(title)));
+}
+
+static void parse_body_parallel(std::string_view html, ParsedPage& result, CpuBudget& budget,
+                                std::size_t threads, std::size_t minChunk) {
+    std::size_t chunks = std::min(threads * 2, html.size() / std::max<std::size_t>(minChunk, 1));
+    std::vector<std::size_t> bounds;
+    if (chunks > 1) {
+        BudgetMeter meter(budget);
+        bounds = find_split_points(html, html.size() / chunks);
+        meter.exceeded(); // charge the pre-scan
+    }
+    if (bounds.empty()) {
+        BodyTokenizer(html, result, budget).run();
+        return;
+    }
+    bounds.insert(bounds.begin(), 0);
+    bounds.push_back(html.size());
+
+    std::string_view all = html;
+    std::vector<std::future<ParsedPage>> parts;
+    parts.reserve(bounds.size() - 1);
+    for (std::size_t c = 0; c + 1 < bounds.size(); ++c) {
+        std::string_view chunk = all.substr(bounds[c], bounds[c + 1] - bounds[c]);
+        parts.push_back(Executor::shared().submit([chunk, &budget]{
+            TRACE_SCOPE("parse", "tokenize_chunk");
+            AllocPhaseScope phase(AllocPhase::Parse);
+            ParsedPage part;
+            BodyTokenizer(chunk, part, budget).run();
+            return part;
+        }, TaskPriority::Interactive));
+    }
+
+    // Stitch in order, shifting link spans by the text already emitted
+    TRACE_SCOPE("parse", "stitch_chunks");
+    bool stopped = false;
+    for (auto& fut : parts) {
+        ParsedPage part = Executor::shared().wait(fut);
+        if (stopped) continue; // still drain every future before returning
+        if (!part.text.empty()) {
+            std::size_t base = result.text.empty() ? 0 : result.text.size() + 1;
+            if (base) result.text.push_back('\n');
+            result.text += part.text;
+            for (auto& link : part.links) {
+                link.start_pos += base;
+                link.end_pos += base;
+                result.links.push_back(std::move(link));
+            }
         }
-        
-        if (href_end == std::string::npos) { pos++; continue; }
-        std::string url = html.substr(href_start, href_end - href_start);
-        
-        // Find closing >
-        size_t tag_close = html.find('>', href_end);
-        if (tag_close == std::string::npos) { pos++; continue; }
-        
-        // Find </a>
-        size_t end_tag = lower.find("</a>", tag_close);
-        if (end_tag == std::string::npos) { pos++; continue; }
-        
-        // Extract link text and strip inner tags
-        std::string link_text = html.substr(tag_close + 1, end_tag - (tag_close + 1));
-        link_text = strip_tags(link_text);
-        link_text = decode_entities(link_text);
-        link_text = trim_lines(link_text);
-        
-        // Find position in plain text (approximate: search for link text)
-        size_t text_pos = plainText.find(link_text);
-        if (text_pos != std::string::npos && !link_text.empty()) {
-            Link link;
-            link.text = link_text;
-            link.url = url;
-            link.start_pos = text_pos;
-            link.end_pos = text_pos + link_text.size();
-            links.push_back(link);
+        if (part.truncated) {
+            result.truncated = true;
+            stopped = true;
         }
-        
-        pos = end_tag + 4;
     }
-    
-    return links;
 }
 
 }
 
-ParsedPage parse_html_basic(const std::string& html) {
+ParsedPage parse_html_basic(std::string_view html, const ParseOptions& options) {
+    TRACE_SCOPE("parse", "parse_html_basic");
+    AllocPhaseScope phase(AllocPhase::Parse);
     ParsedPage result;
+    CpuBudget budget(options.cpu_budget);
 
     // Find <title> (case-insensitive)
-    std::string lower = to_lower(html);
-    auto t1 = lower.find("<title");
-    if (t1 != std::string::npos) {
-        auto t1_end = lower.find('>', t1);
-        auto t2 = lower.find("</title>", t1_end == std::string::npos ? t1 : t1_end);
-        if (t1_end != std::string::npos && t2 != std::string::npos && t2 > t1_end) {
-            std::string title = html.substr(t1_end + 1, t2 - (t1_end + 1));
-            result.title = trim_lines(decode_entities(strip_tags(title)));
-        }
+    result.title = parse_title(html);
+
+    std::size_t threads = options.threads;
+    if (threads == 0) threads = Executor::shared().size();
+    if (threads > 1 && html.size() >= 2 * options.min_chunk_size) {
+        parse_body_parallel(html, result, budget, threads, options.min_chunk_size);
+    } else {
+        // Text and links in one linear pass
+        TRACE_SCOPE("parse", "tokenize");
+        BodyTokenizer(html, result, budget).run();
     }
 
-    // Create a copy, normalize line-break-like tags, remove script/style blocks, then strip tags
-    std::string body = html;
-    normalize_linebreak_tags(body);
-    strip_blocks(body, "<script", "</script>");
-    strip_blocks(body, "<style", "</style>");
-    body = strip_tags(body);
-    body = decode_entities(body);
-    body = trim_lines(body);
-
-    result.text = body;
-    
-    // Extract links and their positions
-    result.links = extract_links(html, result.text);
-    
     return result;
 }
@@ -0,0 +1,280 @@
+#include "core/http_archive.h"
+#include "core/curl_session.h"
+#include "core/mapped_file.h"
+#include "core/url.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr char kMagic[4] = {'M', 'B', 'H', 'A'};
+constexpr std::size_t kHeaderSize = 32;
+constexpr std::size_t kEntryFixedSize = 24;   ///< status, flags, waitUs, totalUs
+
+void put_u32(std::string& out, std::uint32_t v) { out.append(reinterpret_cast<const char*>(&v), 4); }
+void put_u64(std::string& out, std::uint64_t v) { out.append(reinterpret_cast<const char*>(&v), 8); }
+
+std::uint32_t get_u32(const char* p) { std::uint32_t v; std::memcpy(&v, p, 4); return v; }
+std::uint64_t get_u64(const char* p) { std::uint64_t v; std::memcpy(&v, p, 8); return v; }
+
+void put_string(std::string& out, std::string_view s) {
+    put_u32(out, static_cast<std::uint32_t>(s.size()));
+    out.append(s);
+}
+
+// Bounds-checked reader over the mapped file
+struct Reader {
+    const char* p;
+    const char* end;
+
+    bool u32(std::uint32_t& v) {
+        if (end - p < 4) return false;
+        v = get_u32(p);
+        p += 4;
+        return true;
+    }
+    bool u64(std::uint64_t& v) {
+        if (end - p < 8) return false;
+        v = get_u64(p);
+        p += 8;
+        return true;
+    }
+    bool bytes(std::string& s, std::uint64_t n) {
+        if (static_cast<std::uint64_t>(end - p) < n) return false;
+        s.assign(p, n);
+        p += n;
+        return true;
+    }
+    bool string(std::string& s) {
+        std::uint32_t n;
+        return u32(n) && bytes(s, n);
+    }
+};
+
+std::string archive_key(const std::string& url) {
+    if (auto parsed = Url::parse(url)) return std::string(parsed->cacheKey());
+    return url.substr(0, url.find('#'));
+}
+
+// Process-wide recorder/replayer state behind http_get
+struct State {
+    std::mutex mutex;
+    bool recording = false;
+    HttpArchive recorded;
+    bool replaying = false;
+    HttpArchive replayed;
+    double timeScale = 1.0;
+    std::unordered_map<std::string, std::vector<std::size_t>> byUrl;   ///< Entry indices per URL, in order
+    std::unordered_map<std::string, std::size_t> served;               ///< Next recording to serve per URL
+};
+
+State& state() {
+    static State s;
+    return s;
+}
+
+}
+
+bool HttpArchive::save(const std::string& path) const {
+    std::string out(kMagic, 4);
+    put_u32(out, kVersion);
+    put_u32(out, static_cast<std::uint32_t>(entries_.size()));
+    put_u32(out, 0);
+    put_u64(out, 0);   // file size, patched below
+    put_u64(out, 0);
+    for (const ArchiveEntry& e : entries_) {
+        put_u32(out, static_cast<std::uint32_t>(e.status));
+        put_u32(out, 0);
+        put_u64(out, e.waitUs);
+        put_u64(out, e.totalUs);
+        put_string(out, e.url);
+        put_string(out, e.finalUrl);
+        put_string(out, e.contentType);
+        put_string(out, e.headers);
+        put_string(out, e.error);
+        put_u64(out, e.body.size());
+        out.append(e.body);
+    }
+    const std::uint64_t fileSize = out.size();
+    std::memcpy(out.data() + 16, &fileSize, 8);
+
+    std::error_code ec;
+    fs::path target(path);
+    if (target.has_parent_path()) fs::create_directories(target.parent_path(), ec);
+
+    // Write next to the target and rename, so a crash never leaves a partial archive
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+        if (!file) return false;
+        file.write(out.data(), static_cast<std::streamsize>(out.size()));
+        if (!file) return false;
+    }
+    fs::rename(tmp, path, ec);
+    return !ec;
+}
+
+bool HttpArchive::load(const std::string& path) {
+    entries_.clear();
+    MappedFile file;
+    if (!file.open(path)) return false;
+
+    const char* base = file.data();
+    const std::size_t size = file.size();
+    if (size < kHeaderSize || std::memcmp(base, kMagic, 4) != 0 || get_u32(base + 4) != kVersion) return false;
+    if (get_u64(base + 16) != size) return false;   // truncated or foreign file
+
+    const std::uint32_t count = get_u32(base + 8);
+    // Every entry takes at least its fixed fields and six lengths
+    if (count > (size - kHeaderSize) / (kEntryFixedSize + 28)) return false;
+
+    std::vector<ArchiveEntry> entries(count);
+    Reader in{base + kHeaderSize, base + size};
+    for (ArchiveEntry& e : entries) {
+        std::uint32_t status, flags;
+        std::uint64_t bodySize;
+        if (!in.u32(status) || !in.u32(flags) || !in.u64(e.waitUs) || !in.u64(e.totalUs)) return false;
+        if (!in.string(e.url) || !in.string(e.finalUrl) || !in.string(e.contentType)) return false;
+        if (!in.string(e.headers) || !in.string(e.error)) return false;
+        if (!in.u64(bodySize) || !in.bytes(e.body, bodySize)) return false;
+        e.status = static_cast<long>(status);
+    }
+    if (in.p != in.end) return false;
+
+    entries_ = std::move(entries);
+    return true;
+}
+
+void http_record_start() {
+    State& s = state();
+    std::lock_guard lock(s.mutex);
+    s.replaying = false;
+    s.replayed.clear();
+    s.byUrl.clear();
+    s.served.clear();
+    s.recorded.clear();
+    s.recording = true;
+    archive_detail::active.store(true, std::memory_order_relaxed);
+}
+
+bool http_record_stop(const std::string& path) {
+    State& s = state();
+    HttpArchive archive;
+    {
+        std::lock_guard lock(s.mutex);
+        if (!s.recording) return false;
+        s.recording = false;
+        archive_detail::active.store(false, std::memory_order_relaxed);
+        std::swap(archive, s.recorded);
+    }
+    return archive.save(path);
+}
+
+bool http_replay_start(const std::string& path, double timeScale) {
+    HttpArchive archive;
+    if (!archive.load(path)) return false;
+
+    State& s = state();
+    std::lock_guard lock(s.mutex);
+    s.recording = false;
+    s.recorded.clear();
+    s.replayed = std::move(archive);
+    s.timeScale = std::max(0.0, timeScale);
+    s.byUrl.clear();
+    s.served.clear();
+    const auto& entries = s.replayed.entries();
+    for (std::size_t i = 0; i < entries.size(); ++i) s.byUrl[archive_key(entries[i].url)].push_back(i);
+    s.replaying = true;
+    archive_detail::active.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+void http_replay_stop() {
+    State& s = state();
+    std::lock_guard lock(s.mutex);
+    if (!s.replaying) return;
+    s.replaying = false;
+    s.replayed.clear();
+    s.byUrl.clear();
+    s.served.clear();
+    archive_detail::active.store(false, std::memory_order_relaxed);
+}
+
+std::size_t http_recorded_count() {
+    State& s = state();
+    std::lock_guard lock(s.mutex);
+    return s.recording ? s.recorded.size() : 0;
+}
+
+namespace archive_detail {
+
+std::optional<HttpResult> replay(const std::string& url, int timeout_ms, const std::atomic<bool>* cancel) {
+    State& s = state();
+    HttpResult r;
+    std::chrono::microseconds delay {0};
+    {
+        std::lock_guard lock(s.mutex);
+        if (!s.replaying) return std::nullopt;
+        std::string key = archive_key(url);
+        auto it = s.byUrl.find(key);
+        if (it == s.byUrl.end()) {
+            r.error = "not in archive";
+            return r;
+        }
+        std::size_t& next = s.served[key];
+        const ArchiveEntry& e = s.replayed.entries()[it->second[std::min(next, it->second.size() - 1)]];
+        ++next;
+        r.status = e.status;
+        r.body = e.body;
+        r.error = e.error;
+        r.url = e.finalUrl;
+        r.content_type = e.contentType;
+        delay = std::chrono::microseconds(static_cast<std::int64_t>(static_cast<double>(e.totalUs) * s.timeScale));
+    }
+
+    // Reproduce the recorded duration, still honouring the timeout and the cancel flag
+    const auto start = std::chrono::steady_clock::now();
+    const auto timeout = std::chrono::milliseconds(timeout_ms);
+    const bool timesOut = timeout_ms > 0 && delay > timeout;
+    const auto deadline = start + (timesOut ? std::chrono::duration_cast<std::chrono::microseconds>(timeout) : delay);
+    for (auto now = start; now < deadline; now = std::chrono::steady_clock::now()) {
+        if (cancel && cancel->load()) {
+            HttpResult cancelled;
+            cancelled.cancelled = true;
+            cancelled.error = "cancelled";
+            return cancelled;
+        }
+        std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(deadline - now, CurlSession::kPollInterval));
+    }
+    if (timesOut) {
+        HttpResult timedOut;
+        timedOut.error = "Timeout was reached";
+        return timedOut;
+    }
+    return r;
+}
+
+bool recording() {
+    State& s = state();
+    std::lock_guard lock(s.mutex);
+    return s.recording;
+}
+
+void capture(ArchiveEntry entry) {
+    State& s = state();
+    std::lock_guard lock(s.mutex);
+    if (!s.recording) return;
+    entry.url = archive_key(entry.url);
+    s.recorded.add(std::move(entry));
+}
+
+}
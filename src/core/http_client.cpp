@@ -1,46 +1,211 @@
 #include "core/http_client.h"
+#include "core/alloc_tracker.h"
+#include "core/connection_pool.h"
+#include "core/http_archive.h"
+#include "core/curl_session.h"
+#include "core/trace.h"
 #include <curl/curl.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <utility>
 
 namespace {
+std::atomic<std::size_t> spool_threshold {0};
+
+// Collects a body in memory until it passes the spool threshold, then in an unlinked temp file
+class BodySink {
+public:
+    BodySink(std::string& body, std::size_t threshold) : body_(body), threshold_(threshold) {}
+
+    ~BodySink() {
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    BodySink(const BodySink&) = delete;
+    BodySink& operator=(const BodySink&) = delete;
+
+    bool write(const char* data, std::size_t n) {
+        if (fd_ >= 0) return writeAll(data, n);
+        body_.append(data, n);
+        if (threshold_ == 0 || body_.size() < threshold_) return true;
+        return spill();
+    }
+
+    bool spooled() const { return fd_ >= 0; }
+
+    /// Why a write failed, empty if none did
+    const std::string& error() const { return error_; }
+
+    /// Map the spooled file; nullptr (and error() set) if that fails
+    std::shared_ptr<const MappedFile> map() {
+        auto file = std::make_shared<MappedFile>();
+        if (!file->openDescriptor(fd_)) {
+            error_ = std::string("could not map spooled body: ") + std::strerror(errno);
+            return nullptr;
+        }
+        return file;
+    }
+
+private:
+    bool spill() {
+        fd_ = create_unlinked_temp_file();
+        if (fd_ < 0) {
+            error_ = std::string("could not create spool file: ") + std::strerror(errno);
+            return false;
+        }
+        std::string held;
+        held.swap(body_);
+        return writeAll(held.data(), held.size());
+    }
+
+    bool writeAll(const char* data, std::size_t n) {
+        while (n > 0) {
+            ssize_t w = ::write(fd_, data, n);
+            if (w < 0 && errno == EINTR) continue;
+            if (w <= 0) {
+                error_ = std::string("could not write spool file: ") + std::strerror(errno);
+                return false;
+            }
+            data += w;
+            n -= static_cast<std::size_t>(w);
+        }
+        return true;
+    }
+
+    std::string& body_;
+    std::size_t threshold_;
+    int fd_ = -1;
+    std::string error_;
+};
+
 static size_t write_cb(char* ptr, size_t size, size_t nmemb, void* userdata) {
+    auto* sink = static_cast<BodySink*>(userdata);
+    return sink->write(ptr, size * nmemb) ? size * nmemb : 0;
+}
+
+// Keeps the header block of the last response only (redirects start a new one)
+static size_t header_cb(char* ptr, size_t size, size_t nmemb, void* userdata) {
     auto* out = static_cast<std::string*>(userdata);
-    out->append(ptr, size * nmemb);
+    std::string_view line(ptr, size * nmemb);
+    if (line.starts_with("HTTP/")) out->clear();
+    out->append(line);
     return size * nmemb;
 }
 }
 
-HttpResult http_get(const std::string& url, int timeout_ms) {
+void http_set_spool_threshold(std::size_t bytes) {
+    spool_threshold.store(bytes, std::memory_order_relaxed);
+}
+
+std::size_t http_spool_threshold() {
+    return spool_threshold.load(std::memory_order_relaxed);
+}
+
+void http_global_init() {
+    static std::once_flag once;
+    std::call_once(once, [] { curl_global_init(CURL_GLOBAL_DEFAULT); });
+}
+
+HttpResult http_get(const std::string& url, int timeout_ms, ConnectionPool* pool,
+                    const std::atomic<bool>* cancel) {
+    TRACE_SCOPE("net", "http_get");
+    AllocPhaseScope phase(AllocPhase::Fetch);
+    if (archive_detail::active.load(std::memory_order_relaxed)) {
+        if (auto replayed = archive_detail::replay(url, timeout_ms, cancel)) return *std::move(replayed);
+    }
     HttpResult r;
+    http_global_init();
 
-    CURL* curl = curl_easy_init();
-    if (!curl) {
+    Origin origin;
+    if (pool) {
+        if (auto parsed = Url::parse(url)) origin = parsed->origin();
+    }
+    CurlSession session = pool ? pool->acquire(origin, cancel, std::chrono::milliseconds(timeout_ms)) : CurlSession();
+    if (cancel && cancel->load()) {
+        r.cancelled = true;
+        r.error = "cancelled";
+        return r;
+    }
+    if (!session.isOpen() && !session.open()) {
         r.error = "curl_easy_init failed";
         return r;
     }
+    CURL* curl = session.easy();
 
     curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
     curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_cb);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &r.body);
+    BodySink sink(r.body, spool_threshold.load(std::memory_order_relaxed));
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &sink);
     curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, timeout_ms);
     curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, timeout_ms);
     curl_easy_setopt(curl, CURLOPT_USERAGENT, "mini-browser/0.1");
+    const bool recording = archive_detail::active.load(std::memory_order_relaxed) && archive_detail::recording();
+    std::string headers;
+    if (recording) {
+        curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, header_cb);
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, &headers);
+    } else {
+        // Pooled sessions keep their options; drop a previous recording's callback
+        curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, nullptr);
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, nullptr);
+    }
+    if (pool) {
+        // Never reuse a connection the pool would already have expired
+        curl_easy_setopt(curl, CURLOPT_MAXAGE_CONN, static_cast<long>(pool->idleTimeout().count() / 1000 + 1));
+    }
 
     // HTTP/2 support if available
 #ifdef CURL_HTTP_VERSION_2TLS
     curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
 #endif
 
-    CURLcode code = curl_easy_perform(curl);
-    if (code != CURLE_OK) {
-        r.error = curl_easy_strerror(code);
+    CURLcode code = session.perform(cancel);
+    if (code == CURLE_ABORTED_BY_CALLBACK && cancel && cancel->load()) {
+        r.cancelled = true;
+        r.error = "cancelled";
+    } else if (code != CURLE_OK) {
+        r.error = sink.error().empty() ? curl_easy_strerror(code) : sink.error();
+    } else if (sink.spooled() && !(r.mapped = sink.map())) {
+        r.error = sink.error();
     } else {
         long status = 0;
         curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
         r.status = status;
+        char* effective = nullptr;
+        curl_easy_getinfo(curl, CURLINFO_EFFECTIVE_URL, &effective);
+        if (effective) r.url = effective;
+        char* type = nullptr;
+        curl_easy_getinfo(curl, CURLINFO_CONTENT_TYPE, &type);
+        if (type) r.content_type = type;
+    }
+
+    if (recording && !r.cancelled) {
+        ArchiveEntry entry;
+        entry.url = url;
+        entry.status = r.status;
+        entry.finalUrl = r.url;
+        entry.contentType = r.content_type;
+        entry.headers = std::move(headers);
+        entry.body = r.bodyView();
+        entry.error = r.error;
+        curl_off_t wait = 0, total = 0;
+        curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &wait);
+        curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &total);
+        entry.waitUs = static_cast<std::uint64_t>(wait);
+        entry.totalUs = static_cast<std::uint64_t>(total);
+        archive_detail::capture(std::move(entry));
     }
 
-    curl_easy_cleanup(curl);
+    if (pool && code == CURLE_OK) {
+        // Park under the final origin: that is where the page's links point
+        auto landed = Url::parse(r.url);
+        pool->release(landed ? landed->origin() : origin, std::move(session));
+    }
     return r;
 }
@@ -0,0 +1,393 @@
+#include "core/http_engine.h"
+#include "core/alloc_tracker.h"
+#include "core/curl_session.h"
+#include "core/executor.h"
+#include "core/trace.h"
+
+#include <curl/curl.h>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#else
+#include <poll.h>
+#endif
+
+#include <algorithm>
+#include <climits>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Reset easy handles kept for the next transfers
+constexpr std::size_t kSpareHandles = 64;
+
+size_t write_cb(char* ptr, size_t size, size_t nmemb, void* userdata) {
+    auto* out = static_cast<std::string*>(userdata);
+    out->append(ptr, size * nmemb);
+    return size * nmemb;
+}
+
+#ifdef __linux__
+// Readiness of the sockets curl asked for
+class Poller {
+public:
+    Poller() : fd_(::epoll_create1(EPOLL_CLOEXEC)) {}
+    ~Poller() {
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    bool ok() const { return fd_ >= 0; }
+
+    void watch(int fd, bool in, bool out, bool known) {
+        epoll_event ev {};
+        ev.events = (in ? EPOLLIN : 0u) | (out ? EPOLLOUT : 0u);
+        ev.data.fd = fd;
+        ::epoll_ctl(fd_, known ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &ev);
+    }
+
+    void unwatch(int fd) { ::epoll_ctl(fd_, EPOLL_CTL_DEL, fd, nullptr); }
+
+    template <class F>
+    void wait(int timeoutMs, F&& onEvent) {
+        int n = ::epoll_wait(fd_, events_, kMaxEvents, timeoutMs);
+        for (int i = 0; i < n; ++i) {
+            const std::uint32_t e = events_[i].events;
+            onEvent(events_[i].data.fd, (e & (EPOLLIN | EPOLLHUP)) != 0, (e & EPOLLOUT) != 0, (e & EPOLLERR) != 0);
+        }
+    }
+
+private:
+    static constexpr int kMaxEvents = 256;
+    int fd_;
+    epoll_event events_[kMaxEvents];
+};
+#else
+// poll() fallback for platforms without epoll: the interest set is rebuilt per wait
+class Poller {
+public:
+    bool ok() const { return true; }
+
+    void watch(int fd, bool in, bool out, bool) { interest_[fd] = static_cast<short>((in ? POLLIN : 0) | (out ? POLLOUT : 0)); }
+
+    void unwatch(int fd) { interest_.erase(fd); }
+
+    template <class F>
+    void wait(int timeoutMs, F&& onEvent) {
+        fds_.clear();
+        for (auto [fd, events] : interest_) fds_.push_back({fd, events, 0});
+        if (::poll(fds_.data(), fds_.size(), timeoutMs) <= 0) return;
+        for (const pollfd& p : fds_) {
+            if (p.revents) onEvent(p.fd, (p.revents & (POLLIN | POLLHUP)) != 0, (p.revents & POLLOUT) != 0, (p.revents & POLLERR) != 0);
+        }
+    }
+
+private:
+    std::unordered_map<int, short> interest_;
+    std::vector<pollfd> fds_;
+};
+#endif
+
+struct Transfer {
+    std::string url;
+    int timeoutMs;
+    HttpEngine::Callback done;
+    std::shared_ptr<std::atomic<bool>> cancel;
+    CURL* easy = nullptr;
+    HttpResult result;
+};
+
+HttpResult cancelled_result() {
+    HttpResult r;
+    r.cancelled = true;
+    r.error = "cancelled";
+    return r;
+}
+
+}
+
+struct HttpEngine::Impl {
+    explicit Impl(std::size_t maxConnections) {
+        http_global_init();
+        multi = curl_multi_init();
+        curl_multi_setopt(multi, CURLMOPT_SOCKETFUNCTION, socket_cb);
+        curl_multi_setopt(multi, CURLMOPT_SOCKETDATA, this);
+        curl_multi_setopt(multi, CURLMOPT_TIMERFUNCTION, timer_cb);
+        curl_multi_setopt(multi, CURLMOPT_TIMERDATA, this);
+        if (maxConnections) curl_multi_setopt(multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, static_cast<long>(maxConnections));
+        if (::pipe(wake) == 0) {
+            for (int fd : wake) ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+            poller.watch(wake[0], true, false, false);
+        }
+        io = std::thread([this] { loop(); });
+    }
+
+    ~Impl() {
+        shutdown();
+        for (CURL* easy : spare) curl_easy_cleanup(easy);
+        curl_multi_cleanup(multi);
+        ::close(wake[0]);
+        ::close(wake[1]);
+    }
+
+    CURLM* multi = nullptr;
+    Poller poller;
+    int wake[2] = {-1, -1};
+    std::thread io;
+    std::atomic<bool> stopping {false};
+
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Transfer>> incoming;
+
+    // I/O thread only
+    std::unordered_map<Transfer*, std::unique_ptr<Transfer>> active;
+    std::unordered_map<int, bool> sockets;   ///< fd -> registered with the poller
+    std::vector<CURL*> spare;
+    bool timerSet = false;
+    Clock::time_point timerAt;
+
+    std::atomic<std::size_t> started {0}, completed {0}, cancelled {0}, activeCount {0}, peakActive {0}, wakeups {0};
+
+    static int socket_cb(CURL*, curl_socket_t s, int what, void* userp, void*) {
+        auto* d = static_cast<Impl*>(userp);
+        if (what == CURL_POLL_REMOVE) {
+            if (d->sockets.erase(s)) d->poller.unwatch(s);
+        } else {
+            auto [it, added] = d->sockets.try_emplace(s, true);
+            d->poller.watch(s, what == CURL_POLL_IN || what == CURL_POLL_INOUT,
+                            what == CURL_POLL_OUT || what == CURL_POLL_INOUT, !added);
+        }
+        return 0;
+    }
+
+    static int timer_cb(CURLM*, long timeoutMs, void* userp) {
+        auto* d = static_cast<Impl*>(userp);
+        d->timerSet = timeoutMs >= 0;
+        if (d->timerSet) d->timerAt = Clock::now() + std::chrono::milliseconds(timeoutMs);
+        return 0;
+    }
+
+    // Set under `mutex`, so a fetch() either queues before it or sees it
+    void shutdown() {
+        {
+            std::lock_guard lock(mutex);
+            if (stopping) return;
+            stopping = true;
+        }
+        char c = 0;
+        (void)::write(wake[1], &c, 1);
+        io.join();
+    }
+
+    void loop();
+    void adopt();
+    void start(std::unique_ptr<Transfer> t);
+    void finish(Transfer* t, CURLcode code);
+    void readDone();
+    void checkCancels(bool all);
+};
+
+void HttpEngine::Impl::loop() {
+    trace_set_thread_name("http-engine");
+    AllocPhaseScope phase(AllocPhase::Fetch);
+    auto lastScan = Clock::now();
+    int running = 0;
+    while (true) {
+        adopt();
+        if (stopping) break;
+
+        // Cancel flags need a scan every poll interval, but only while transfers run;
+        // otherwise sleep until curl's timer or the wake pipe
+        int timeout = active.empty() ? -1 : static_cast<int>(CurlSession::kPollInterval.count());
+        if (timerSet) {
+            auto wait = std::chrono::ceil<std::chrono::milliseconds>(timerAt - Clock::now()).count();
+            timeout = static_cast<int>(std::clamp<long long>(wait, 0, timeout < 0 ? INT_MAX : timeout));
+        }
+        poller.wait(timeout, [&](int fd, bool in, bool out, bool err) {
+            if (fd == wake[0]) {
+                char buf[256];
+                while (::read(wake[0], buf, sizeof(buf)) > 0) {}
+                return;
+            }
+            const int mask = (in ? CURL_CSELECT_IN : 0) | (out ? CURL_CSELECT_OUT : 0) | (err ? CURL_CSELECT_ERR : 0);
+            curl_multi_socket_action(multi, fd, mask, &running);
+        });
+        ++wakeups;
+        if (timerSet && Clock::now() >= timerAt) {
+            timerSet = false;
+            curl_multi_socket_action(multi, CURL_SOCKET_TIMEOUT, 0, &running);
+        }
+        readDone();
+
+        if (Clock::now() - lastScan >= CurlSession::kPollInterval) {
+            checkCancels(false);
+            lastScan = Clock::now();
+        }
+    }
+    checkCancels(true);
+    // Fetches queued after the last adopt() but before shutdown() took the lock
+    adopt();
+}
+
+void HttpEngine::Impl::adopt() {
+    std::vector<std::unique_ptr<Transfer>> batch;
+    {
+        std::lock_guard lock(mutex);
+        batch.swap(incoming);
+    }
+    for (auto& t : batch) {
+        if (stopping || (t->cancel && t->cancel->load())) {
+            ++started;
+            ++completed;
+            ++cancelled;
+            t->done(cancelled_result());
+            continue;
+        }
+        start(std::move(t));
+    }
+}
+
+void HttpEngine::Impl::start(std::unique_ptr<Transfer> t) {
+    CURL* easy = nullptr;
+    if (!spare.empty()) {
+        easy = spare.back();
+        spare.pop_back();
+    } else {
+        easy = curl_easy_init();
+    }
+    ++started;
+    if (!easy) {
+        ++completed;
+        HttpResult r;
+        r.error = "curl_easy_init failed";
+        t->done(std::move(r));
+        return;
+    }
+    t->easy = easy;
+    curl_easy_setopt(easy, CURLOPT_URL, t->url.c_str());
+    curl_easy_setopt(easy, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, write_cb);
+    curl_easy_setopt(easy, CURLOPT_WRITEDATA, &t->result.body);
+    curl_easy_setopt(easy, CURLOPT_TIMEOUT_MS, static_cast<long>(t->timeoutMs));
+    curl_easy_setopt(easy, CURLOPT_CONNECTTIMEOUT_MS, static_cast<long>(t->timeoutMs));
+    curl_easy_setopt(easy, CURLOPT_USERAGENT, "mini-browser/0.1");
+    curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(easy, CURLOPT_PRIVATE, t.get());
+#ifdef CURL_HTTP_VERSION_2TLS
+    curl_easy_setopt(easy, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+#endif
+    Transfer* raw = t.get();
+    active.emplace(raw, std::move(t));
+    const std::size_t now = ++activeCount;
+    std::size_t peak = peakActive;
+    while (now > peak && !peakActive.compare_exchange_weak(peak, now)) {}
+    if (curl_multi_add_handle(multi, easy) != CURLM_OK) finish(raw, CURLE_FAILED_INIT);
+}
+
+void HttpEngine::Impl::finish(Transfer* raw, CURLcode code) {
+    auto node = active.extract(raw);
+    std::unique_ptr<Transfer> t = std::move(node.mapped());
+    // Removing an unfinished transfer aborts it and closes its connection
+    curl_multi_remove_handle(multi, t->easy);
+    HttpResult& r = t->result;
+    if (code == CURLE_ABORTED_BY_CALLBACK) {
+        r = cancelled_result();
+        ++cancelled;
+    } else if (code != CURLE_OK) {
+        r.error = curl_easy_strerror(code);
+    } else {
+        long status = 0;
+        curl_easy_getinfo(t->easy, CURLINFO_RESPONSE_CODE, &status);
+        r.status = status;
+        char* effective = nullptr;
+        curl_easy_getinfo(t->easy, CURLINFO_EFFECTIVE_URL, &effective);
+        if (effective) r.url = effective;
+        char* type = nullptr;
+        curl_easy_getinfo(t->easy, CURLINFO_CONTENT_TYPE, &type);
+        if (type) r.content_type = type;
+    }
+    if (spare.size() < kSpareHandles) {
+        curl_easy_reset(t->easy);
+        spare.push_back(t->easy);
+    } else {
+        curl_easy_cleanup(t->easy);
+    }
+    --activeCount;
+    ++completed;
+    t->done(std::move(r));
+}
+
+void HttpEngine::Impl::readDone() {
+    int queued = 0;
+    while (CURLMsg* msg = curl_multi_info_read(multi, &queued)) {
+        if (msg->msg != CURLMSG_DONE) continue;
+        Transfer* t = nullptr;
+        curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &t);
+        // finish() removes the handle, which may invalidate msg
+        const CURLcode code = msg->data.result;
+        if (t) finish(t, code);
+    }
+}
+
+void HttpEngine::Impl::checkCancels(bool all) {
+    std::vector<Transfer*> doomed;
+    for (auto& [raw, t] : active) {
+        if (all || (t->cancel && t->cancel->load(std::memory_order_relaxed))) doomed.push_back(raw);
+    }
+    for (Transfer* t : doomed) finish(t, CURLE_ABORTED_BY_CALLBACK);
+}
+
+HttpEngine::HttpEngine(std::size_t maxConnections) : impl_(std::make_unique<Impl>(maxConnections)) {}
+
+HttpEngine::~HttpEngine() {
+    // Before impl_ goes away, so callbacks run during shutdown can still call fetch()
+    impl_->shutdown();
+}
+
+HttpEngine& HttpEngine::shared() {
+    static HttpEngine engine;
+    return engine;
+}
+
+void HttpEngine::fetch(const std::string& url, Callback onDone, int timeout_ms, std::shared_ptr<std::atomic<bool>> cancel) {
+    Impl& d = *impl_;
+    auto t = std::make_unique<Transfer>();
+    t->url = url;
+    t->timeoutMs = timeout_ms;
+    t->done = std::move(onDone);
+    t->cancel = std::move(cancel);
+    {
+        std::lock_guard lock(d.mutex);
+        if (!d.stopping) d.incoming.push_back(std::move(t));
+    }
+    if (t) {
+        // Shutting down: the I/O thread will not look at the queue again
+        ++d.started;
+        ++d.completed;
+        ++d.cancelled;
+        t->done(cancelled_result());
+        return;
+    }
+    char c = 1;
+    (void)::write(d.wake[1], &c, 1);
+}
+
+HttpEngineStats HttpEngine::stats() const {
+    const Impl& d = *impl_;
+    return HttpEngineStats{d.started, d.completed, d.cancelled, d.activeCount, d.peakActive, d.wakeups};
+}
+
+void HttpEngine::Awaitable::await_suspend(std::coroutine_handle<> handle) {
+    // The callback may resume the coroutine before this returns: touch nothing after fetch()
+    engine_.fetch(url_, [this, handle](HttpResult r) {
+        result_ = std::move(r);
+        if (resumeOn_) resumeOn_->post([handle] { handle.resume(); }, TaskPriority::Interactive);
+        else handle.resume();
+    }, timeoutMs_, cancel_);
+}
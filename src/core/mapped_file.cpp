@@ -0,0 +1,118 @@
+#include "core/mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+int create_unlinked_temp_file() {
+    std::error_code ec;
+    std::filesystem::path dir = std::filesystem::temp_directory_path(ec);
+    std::string pattern = (ec ? std::string("/tmp") : dir.string()) + "/mini-browser-XXXXXX";
+    int fd = ::mkstemp(pattern.data());
+    if (fd >= 0) ::unlink(pattern.c_str());   // freed when the descriptor and any mapping are gone
+    return fd;
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)),
+      open_(std::exchange(other.open_, false)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        open_ = std::exchange(other.open_, false);
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    bool ok = openDescriptor(fd);
+    ::close(fd); // the mapping keeps the file alive
+    return ok;
+}
+
+bool MappedFile::openDescriptor(int fd) {
+    close();
+    struct stat st {};
+    if (fstat(fd, &st) != 0) return false;
+    size_ = static_cast<std::size_t>(st.st_size);
+    if (size_ > 0) {
+        void* p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            size_ = 0;
+            return false;
+        }
+        data_ = static_cast<const char*>(p);
+    }
+    open_ = true;
+    return true;
+}
+
+namespace {
+
+// Copy everything from `in` (at its current offset) to `out`; false on a read or write error
+bool copy_contents(int in, int out) {
+#ifdef __linux__
+    // In-kernel copy: no user-space buffer, and a reflink on filesystems that support it
+    while (true) {
+        ssize_t n = ::copy_file_range(in, nullptr, out, nullptr, std::size_t(1) << 30, 0);
+        if (n == 0) return true;
+        if (n > 0) continue;
+        if (errno == EINTR) continue;
+        if (errno != EXDEV && errno != ENOSYS && errno != EINVAL && errno != EOPNOTSUPP) return false;
+        break;   // not supported between these files: copy through a buffer below
+    }
+#endif
+    std::vector<char> buf(1 << 20);
+    while (true) {
+        ssize_t n = ::read(in, buf.data(), buf.size());
+        if (n == 0) return true;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        for (ssize_t done = 0; done < n;) {
+            ssize_t w = ::write(out, buf.data() + done, static_cast<std::size_t>(n - done));
+            if (w < 0 && errno == EINTR) continue;
+            if (w <= 0) return false;
+            done += w;
+        }
+    }
+}
+
+}
+
+bool MappedFile::openSnapshot(int fd) {
+    close();
+    int copy = create_unlinked_temp_file();
+    if (copy < 0) return false;
+    const bool ok = copy_contents(fd, copy) && openDescriptor(copy);
+    const int saved = errno;
+    ::close(copy);
+    errno = saved;
+    return ok;
+}
+
+void MappedFile::close() {
+    if (data_) munmap(const_cast<char*>(data_), size_);
+    data_ = nullptr;
+    size_ = 0;
+    open_ = false;
+}
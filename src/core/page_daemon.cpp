@@ -0,0 +1,752 @@
+#include "core/page_daemon.h"
+#include "core/charset.h"
+#include "core/connection_pool.h"
+#include "core/curl_session.h"
+#include "core/thread_pool.h"
+#include "core/trace.h"
+#include "core/url.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Same per-page limit the browser uses
+constexpr std::chrono::milliseconds kParseBudget {2000};
+
+constexpr std::uint32_t kCached = 1;
+constexpr std::uint32_t kTruncated = 2;
+constexpr std::uint32_t kSharedMemory = 4;
+
+constexpr std::size_t kMaxRequest = 64u << 10;   ///< Longest request frame (a URL) accepted
+constexpr std::size_t kMaxResponse = 1u << 30;   ///< Longest inline response a client accepts
+
+#ifdef MSG_NOSIGNAL
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;   // SO_NOSIGPIPE is set on the socket instead
+#endif
+
+void put_u32(std::string& out, std::uint32_t v) { out.append(reinterpret_cast<const char*>(&v), 4); }
+void put_u64(std::string& out, std::uint64_t v) { out.append(reinterpret_cast<const char*>(&v), 8); }
+
+std::uint32_t get_u32(const char* p) { std::uint32_t v; std::memcpy(&v, p, 4); return v; }
+std::uint64_t get_u64(const char* p) { std::uint64_t v; std::memcpy(&v, p, 8); return v; }
+
+void put_string(std::string& out, std::string_view s) {
+    put_u32(out, static_cast<std::uint32_t>(s.size()));
+    out.append(s);
+}
+
+// Bounds-checked reader over a received frame or mapped page
+struct Reader {
+    const char* p;
+    const char* end;
+
+    bool u32(std::uint32_t& v) {
+        if (end - p < 4) return false;
+        v = get_u32(p);
+        p += 4;
+        return true;
+    }
+    bool u64(std::uint64_t& v) {
+        if (end - p < 8) return false;
+        v = get_u64(p);
+        p += 8;
+        return true;
+    }
+    bool bytes(std::string& s, std::uint64_t n) {
+        if (static_cast<std::uint64_t>(end - p) < n) return false;
+        s.assign(p, n);
+        p += n;
+        return true;
+    }
+    bool string(std::string& s) {
+        std::uint32_t n;
+        return u32(n) && bytes(s, n);
+    }
+};
+
+std::string encode_page(const ParsedPage& page) {
+    std::string out;
+    std::size_t size = 16 + page.title.size() + page.text.size();
+    for (const Link& link : page.links) size += 24 + link.url.size() + link.text.size();
+    out.reserve(size);
+    put_string(out, page.title);
+    put_u64(out, page.text.size());
+    out.append(page.text);
+    put_u32(out, static_cast<std::uint32_t>(page.links.size()));
+    for (const Link& link : page.links) {
+        put_u64(out, link.start_pos);
+        put_u64(out, link.end_pos);
+        put_string(out, link.url);
+        put_string(out, link.text);
+    }
+    return out;
+}
+
+bool decode_page(std::string_view blob, ParsedPage& page) {
+    Reader in {blob.data(), blob.data() + blob.size()};
+    std::uint64_t textSize;
+    std::uint32_t linkCount;
+    if (!in.string(page.title) || !in.u64(textSize) || !in.bytes(page.text, textSize) || !in.u32(linkCount)) return false;
+    if (linkCount > static_cast<std::size_t>(in.end - in.p) / 24) return false;
+    page.links.resize(linkCount);
+    for (Link& link : page.links) {
+        std::uint64_t start, end;
+        if (!in.u64(start) || !in.u64(end) || !in.string(link.url) || !in.string(link.text)) return false;
+        if (start > end || end > page.text.size()) return false;
+        link.start_pos = start;
+        link.end_pos = end;
+    }
+    return in.p == in.end;
+}
+
+bool socket_address(const std::string& path, sockaddr_un& addr) {
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) return false;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+void set_nonblocking(int fd) {
+    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+// Whether a socket file is left over from a daemon that is gone: nothing accepts on it
+bool socket_is_stale(const sockaddr_un& addr) {
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return false;
+    const bool refused = ::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 && errno == ECONNREFUSED;
+    ::close(fd);
+    return refused;
+}
+
+void no_sigpipe(int fd) {
+#ifdef SO_NOSIGPIPE
+    int one = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#else
+    (void)fd;
+#endif
+}
+
+// Read-only shared memory object holding `data`; -1 on failure. The name is
+// unlinked at once, so the object lives exactly as long as its descriptors.
+int make_shared_page(const std::string& data) {
+    static std::atomic<unsigned> counter {0};
+    const std::string name = "/mbpd-" + std::to_string(::getpid()) + "-" + std::to_string(counter++);
+    int rw = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (rw < 0) return -1;
+    int ro = -1;
+    if (::ftruncate(rw, static_cast<off_t>(data.size())) == 0) {
+        void* p = ::mmap(nullptr, data.size(), PROT_WRITE, MAP_SHARED, rw, 0);
+        if (p != MAP_FAILED) {
+            std::memcpy(p, data.data(), data.size());
+            ::munmap(p, data.size());
+            ro = ::shm_open(name.c_str(), O_RDONLY, 0);
+        }
+    }
+    ::shm_unlink(name.c_str());
+    ::close(rw);
+    return ro;
+}
+
+std::string cache_key(const std::string& url) {
+    auto parsed = Url::parse(url);
+    if (!parsed || (parsed->scheme() != "http" && parsed->scheme() != "https")) return {};
+    return std::string(parsed->cacheKey());
+}
+
+// A fetched and parsed page, ready to be framed for any number of clients
+struct Entry {
+    std::string key;
+    std::uint32_t flags = 0;
+    long status = 0;
+    std::string url;
+    std::string contentType;
+    std::string error;
+    std::string page;            ///< Encoded page, when sent inline
+    int sharedFd = -1;           ///< Read-only shared memory with the encoded page
+    std::size_t sharedSize = 0;
+    Clock::time_point expires;
+
+    Entry() = default;
+    Entry(const Entry&) = delete;
+    Entry& operator=(const Entry&) = delete;
+    ~Entry() {
+        if (sharedFd >= 0) ::close(sharedFd);
+    }
+
+    std::size_t bytes() const {
+        return sizeof(Entry) + key.size() + url.size() + contentType.size() + error.size() + page.size() + sharedSize;
+    }
+};
+using EntryPtr = std::shared_ptr<const Entry>;
+
+std::string frame_response(std::uint32_t id, const Entry& e, bool cached) {
+    std::string out;
+    out.reserve(32 + e.url.size() + e.contentType.size() + e.error.size() + e.page.size());
+    put_u32(out, 0);   // length, patched below
+    put_u32(out, id);
+    put_u32(out, e.flags | (cached ? kCached : 0));
+    put_u32(out, static_cast<std::uint32_t>(e.status));
+    put_string(out, e.url);
+    put_string(out, e.contentType);
+    put_string(out, e.error);
+    if (e.flags & kSharedMemory) put_u64(out, e.sharedSize);
+    else out.append(e.page);
+    const std::uint32_t length = static_cast<std::uint32_t>(out.size() - 4);
+    std::memcpy(out.data(), &length, 4);
+    return out;
+}
+
+}
+
+struct PageDaemon::Impl {
+    struct Outgoing {
+        std::string bytes;
+        std::size_t sent = 0;
+        EntryPtr entry;          ///< Keeps a shared memory descriptor open until it is sent
+    };
+
+    struct Conn {
+        int fd;
+        std::string in;
+        std::deque<Outgoing> out;
+        bool dead = false;
+    };
+
+    struct Waiter {
+        std::uint64_t conn;
+        std::uint32_t id;
+    };
+
+    explicit Impl(PageDaemonOptions o) : options(o) {
+        options.sharedMemoryThreshold = std::max<std::size_t>(1, options.sharedMemoryThreshold);
+        options.workers = std::max<std::size_t>(1, options.workers);
+    }
+
+    PageDaemonOptions options;
+    std::string path;
+    int listenFd = -1;
+    int wake[2] = {-1, -1};
+    std::thread io;
+    std::atomic<bool> stopping {false};
+    std::atomic<bool> cancel {false};     ///< Aborts upstream fetches on stop
+    std::unique_ptr<ConnectionPool> connections;
+    std::unique_ptr<ThreadPool> workers;
+
+    // I/O thread only
+    std::unordered_map<std::uint64_t, Conn> conns;
+    std::uint64_t nextConn = 1;
+    std::list<EntryPtr> lru;   ///< Most recently used first
+    std::unordered_map<std::string, std::list<EntryPtr>::iterator> cache;
+    std::size_t cacheBytes = 0;
+    std::unordered_map<std::string, std::vector<Waiter>> inflight;
+
+    // Finished fetches, handed from workers to the I/O thread
+    std::mutex doneMutex;
+    std::vector<std::shared_ptr<Entry>> done;
+
+    // Read by stats() from any thread
+    std::atomic<std::size_t> requests {0}, hits {0}, coalesced {0}, fetches {0}, clients {0};
+    std::atomic<std::size_t> entryCount {0}, entryBytes {0};
+
+    void loop();
+    void acceptClients();
+    void readFrom(std::uint64_t id, Conn& conn);
+    void handle(std::uint64_t connId, std::uint32_t id, const std::string& url);
+    void finish(const std::shared_ptr<Entry>& entry);
+    void reply(std::uint64_t connId, std::uint32_t id, const EntryPtr& entry, bool cached);
+    void flush(Conn& conn);
+    void insert(const EntryPtr& entry);
+    void evict(std::unordered_map<std::string, std::list<EntryPtr>::iterator>::iterator it);
+    std::shared_ptr<Entry> fetchAndParse(const std::string& key);
+};
+
+std::shared_ptr<Entry> PageDaemon::Impl::fetchAndParse(const std::string& key) {
+    TRACE_SCOPE("daemon", "fetch_and_parse");
+    auto e = std::make_shared<Entry>();
+    e->key = key;
+    HttpResult r = http_get(key, options.timeoutMs, connections.get(), &cancel);
+    e->status = r.status;
+    e->url = r.url;
+    e->contentType = r.content_type;
+    e->error = r.error;
+
+    ParsedPage page;
+    if (r.error.empty()) {
+        // A body above the spool threshold is mapped, not in r.body
+        std::string_view body = r.bodyView();
+        Charset charset = detect_charset(r.content_type, body);
+        std::string decoded;
+        if (charset != Charset::Utf8 || !is_valid_utf8(body)) {
+            decoded = to_utf8(body, charset);
+            body = decoded;
+        }
+        page = parse_html_basic(strip_utf8_bom(body), ParseOptions{kParseBudget, 1});
+        if (auto base = Url::parse(r.url.empty() ? key : r.url)) resolve_links(page.links, *base);
+        if (page.truncated) e->flags |= kTruncated;
+    }
+    std::string encoded = encode_page(page);
+    if (encoded.size() >= options.sharedMemoryThreshold) {
+        e->sharedFd = make_shared_page(encoded);
+        if (e->sharedFd >= 0) {
+            e->sharedSize = encoded.size();
+            e->flags |= kSharedMemory;
+        }
+    }
+    if (e->sharedFd < 0) e->page = std::move(encoded);
+    e->expires = Clock::now() + options.ttl;
+    return e;
+}
+
+void PageDaemon::Impl::loop() {
+    trace_set_thread_name("daemon-io");
+    std::vector<pollfd> fds;
+    std::vector<std::uint64_t> ids;
+    while (!stopping) {
+        fds.clear();
+        ids.clear();
+        fds.push_back({wake[0], POLLIN, 0});
+        fds.push_back({listenFd, POLLIN, 0});
+        for (auto& [id, conn] : conns) {
+            fds.push_back({conn.fd, static_cast<short>(POLLIN | (conn.out.empty() ? 0 : POLLOUT)), 0});
+            ids.push_back(id);
+        }
+        if (::poll(fds.data(), fds.size(), -1) < 0 && errno != EINTR) break;
+        if (stopping) break;
+
+        if (fds[0].revents & POLLIN) {
+            char buf[256];
+            while (::read(wake[0], buf, sizeof(buf)) > 0) {}
+            std::vector<std::shared_ptr<Entry>> finished;
+            {
+                std::lock_guard lock(doneMutex);
+                finished.swap(done);
+            }
+            for (const auto& entry : finished) finish(entry);
+        }
+        if (fds[1].revents & POLLIN) acceptClients();
+
+        for (std::size_t i = 0; i < ids.size(); ++i) {
+            auto it = conns.find(ids[i]);
+            if (it == conns.end()) continue;
+            const short re = fds[i + 2].revents;
+            if (re & (POLLIN | POLLHUP | POLLERR)) readFrom(ids[i], it->second);
+            if ((re & POLLOUT) && !it->second.dead) flush(it->second);
+        }
+        for (auto it = conns.begin(); it != conns.end();) {
+            if (it->second.dead) {
+                ::close(it->second.fd);
+                it = conns.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+void PageDaemon::Impl::acceptClients() {
+    int fd;
+    while ((fd = ::accept(listenFd, nullptr, nullptr)) >= 0) {
+        set_nonblocking(fd);
+        no_sigpipe(fd);
+        conns.emplace(nextConn++, Conn{fd, {}, {}, false});
+        ++clients;
+    }
+}
+
+void PageDaemon::Impl::readFrom(std::uint64_t connId, Conn& conn) {
+    char buf[16384];
+    ssize_t n;
+    while ((n = ::read(conn.fd, buf, sizeof(buf))) > 0) conn.in.append(buf, static_cast<std::size_t>(n));
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+        conn.dead = true;
+        return;
+    }
+
+    std::size_t pos = 0;
+    while (conn.in.size() - pos >= 4) {
+        const std::uint32_t length = get_u32(conn.in.data() + pos);
+        if (length < 4 || length > kMaxRequest) {
+            conn.dead = true;   // not a client of ours
+            return;
+        }
+        if (conn.in.size() - pos - 4 < length) break;
+        const std::uint32_t id = get_u32(conn.in.data() + pos + 4);
+        std::string url = conn.in.substr(pos + 8, length - 4);
+        pos += 4 + length;
+        handle(connId, id, url);
+        if (conn.dead) return;
+    }
+    conn.in.erase(0, pos);
+}
+
+void PageDaemon::Impl::handle(std::uint64_t connId, std::uint32_t id, const std::string& url) {
+    ++requests;
+    std::string key = cache_key(url);
+    if (key.empty()) {
+        auto invalid = std::make_shared<Entry>();
+        invalid->error = "invalid URL";
+        invalid->page = encode_page(ParsedPage{});
+        reply(connId, id, invalid, false);
+        return;
+    }
+
+    if (auto it = cache.find(key); it != cache.end()) {
+        if ((*it->second)->expires > Clock::now()) {
+            lru.splice(lru.begin(), lru, it->second);
+            ++hits;
+            reply(connId, id, *it->second, true);
+            return;
+        }
+        evict(it);
+    }
+
+    auto [waiting, first] = inflight.try_emplace(key);
+    waiting->second.push_back(Waiter{connId, id});
+    if (!first) {
+        ++coalesced;
+        return;
+    }
+    ++fetches;
+    workers->submit([this, key] {
+        auto entry = fetchAndParse(key);
+        {
+            std::lock_guard lock(doneMutex);
+            done.push_back(std::move(entry));
+        }
+        char c = 1;
+        (void)::write(wake[1], &c, 1);
+    });
+}
+
+void PageDaemon::Impl::finish(const std::shared_ptr<Entry>& entry) {
+    auto node = inflight.extract(entry->key);
+    EntryPtr shared = entry;
+    if (entry->error.empty() && entry->status > 0 && entry->status < 400) insert(shared);
+    if (node.empty()) return;
+    for (const Waiter& w : node.mapped()) reply(w.conn, w.id, shared, false);
+}
+
+void PageDaemon::Impl::insert(const EntryPtr& entry) {
+    const std::size_t size = entry->bytes();
+    if (size > options.maxCacheBytes) return;
+    if (auto it = cache.find(entry->key); it != cache.end()) evict(it);
+    while (cacheBytes + size > options.maxCacheBytes && !lru.empty()) evict(cache.find(lru.back()->key));
+    lru.push_front(entry);
+    cache.emplace(entry->key, lru.begin());
+    cacheBytes += size;
+    entryCount = cache.size();
+    entryBytes = cacheBytes;
+}
+
+void PageDaemon::Impl::evict(std::unordered_map<std::string, std::list<EntryPtr>::iterator>::iterator it) {
+    cacheBytes -= (*it->second)->bytes();
+    lru.erase(it->second);
+    cache.erase(it);
+    entryCount = cache.size();
+    entryBytes = cacheBytes;
+}
+
+void PageDaemon::Impl::reply(std::uint64_t connId, std::uint32_t id, const EntryPtr& entry, bool cached) {
+    auto it = conns.find(connId);
+    if (it == conns.end() || it->second.dead) return;   // client went away while we fetched
+    Conn& conn = it->second;
+    conn.out.push_back(Outgoing{frame_response(id, *entry, cached), 0, entry});
+    if (conn.out.size() == 1) flush(conn);   // answer now rather than on the next poll round
+}
+
+void PageDaemon::Impl::flush(Conn& conn) {
+    while (!conn.out.empty()) {
+        Outgoing& out = conn.out.front();
+        const char* data = out.bytes.data() + out.sent;
+        const std::size_t left = out.bytes.size() - out.sent;
+        ssize_t n;
+        if (out.sent == 0 && out.entry->sharedFd >= 0) {
+            // The descriptor rides on the first byte of the frame
+            iovec iov {const_cast<char*>(data), left};
+            alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+            msghdr msg {};
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+            cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type = SCM_RIGHTS;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+            std::memcpy(CMSG_DATA(cmsg), &out.entry->sharedFd, sizeof(int));
+            n = ::sendmsg(conn.fd, &msg, kSendFlags);
+        } else {
+            n = ::send(conn.fd, data, left, kSendFlags);
+        }
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) conn.dead = true;
+            return;
+        }
+        out.sent += static_cast<std::size_t>(n);
+        if (out.sent < out.bytes.size()) return;
+        conn.out.pop_front();
+    }
+}
+
+PageDaemon::PageDaemon(PageDaemonOptions options) : impl_(std::make_unique<Impl>(options)) {}
+
+PageDaemon::~PageDaemon() {
+    stop();
+}
+
+bool PageDaemon::start(const std::string& socketPath) {
+    Impl& d = *impl_;
+    if (d.listenFd >= 0) return false;
+    sockaddr_un addr;
+    if (!socket_address(socketPath, addr)) return false;
+
+    // Replace a socket left behind by a daemon that did not stop cleanly, never a live one
+    struct stat st;
+    if (::lstat(socketPath.c_str(), &st) == 0) {
+        if (!S_ISSOCK(st.st_mode) || !socket_is_stale(addr)) return false;
+        ::unlink(socketPath.c_str());
+    }
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return false;
+    // Created owner-only, so other users never get a window to connect before the chmod
+    const mode_t previousMask = ::umask(077);
+    const bool bound = ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+    ::umask(previousMask);
+    if (!bound || ::listen(fd, 1024) != 0) {
+        ::close(fd);
+        return false;
+    }
+    ::chmod(socketPath.c_str(), 0600);
+    set_nonblocking(fd);
+    if (::pipe(d.wake) != 0) {
+        ::close(fd);
+        ::unlink(socketPath.c_str());
+        return false;
+    }
+    set_nonblocking(d.wake[0]);
+    set_nonblocking(d.wake[1]);
+
+    d.path = socketPath;
+    d.listenFd = fd;
+    d.stopping = false;
+    d.cancel = false;
+    d.connections = std::make_unique<ConnectionPool>(d.options.workers);
+    d.workers = std::make_unique<ThreadPool>(d.options.workers);
+    d.io = std::thread([&d] { d.loop(); });
+    return true;
+}
+
+void PageDaemon::stop() {
+    Impl& d = *impl_;
+    if (d.listenFd < 0) return;
+    d.stopping = true;
+    d.cancel = true;
+    char c = 0;
+    (void)::write(d.wake[1], &c, 1);
+    d.io.join();
+    d.workers.reset();       // cancelled fetches return within a poll interval
+    d.connections.reset();
+
+    for (auto& [id, conn] : d.conns) ::close(conn.fd);
+    d.conns.clear();
+    d.inflight.clear();
+    d.done.clear();
+    d.lru.clear();
+    d.cache.clear();
+    d.cacheBytes = 0;
+    d.entryCount = 0;
+    d.entryBytes = 0;
+    ::close(d.listenFd);
+    ::close(d.wake[0]);
+    ::close(d.wake[1]);
+    d.listenFd = d.wake[0] = d.wake[1] = -1;
+    ::unlink(d.path.c_str());
+}
+
+PageDaemonStats PageDaemon::stats() const {
+    const Impl& d = *impl_;
+    PageDaemonStats s;
+    s.requests = d.requests;
+    s.hits = d.hits;
+    s.coalesced = d.coalesced;
+    s.fetches = d.fetches;
+    s.clients = d.clients;
+    s.cacheEntries = d.entryCount;
+    s.cacheBytes = d.entryBytes;
+    return s;
+}
+
+PageClient::~PageClient() {
+    close();
+}
+
+PageClient::PageClient(PageClient&& other) noexcept
+    : fd_(std::exchange(other.fd_, -1)), socketPath_(std::move(other.socketPath_)), nextId_(other.nextId_) {}
+
+PageClient& PageClient::operator=(PageClient&& other) noexcept {
+    if (this != &other) {
+        close();
+        fd_ = std::exchange(other.fd_, -1);
+        socketPath_ = std::move(other.socketPath_);
+        nextId_ = other.nextId_;
+    }
+    return *this;
+}
+
+bool PageClient::connect(const std::string& socketPath) {
+    close();
+    socketPath_ = socketPath;
+    sockaddr_un addr;
+    if (!socket_address(socketPath, addr)) return false;
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return false;
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        return false;
+    }
+    no_sigpipe(fd);
+    fd_ = fd;
+    return true;
+}
+
+void PageClient::close() {
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+}
+
+DaemonPage PageClient::fetch(const std::string& url, int timeout_ms, const std::atomic<bool>* cancel) {
+    TRACE_SCOPE("daemon", "PageClient::fetch");
+    DaemonPage result;
+    if (fd_ < 0 && (socketPath_.empty() || !connect(socketPath_))) {
+        result.response.error = "page daemon not reachable";
+        return result;
+    }
+    auto fail = [&](const char* error) {
+        close();
+        result.response.error = error;
+        return result;
+    };
+
+    const std::uint32_t id = nextId_++;
+    std::string request;
+    put_u32(request, static_cast<std::uint32_t>(4 + url.size()));
+    put_u32(request, id);
+    request.append(url);
+    for (std::size_t sent = 0; sent < request.size();) {
+        ssize_t n = ::send(fd_, request.data() + sent, request.size() - sent, kSendFlags);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return fail("page daemon connection lost");
+        sent += static_cast<std::size_t>(n);
+    }
+
+    // Read one frame, picking up a shared memory descriptor if one comes with it
+    const auto deadline = Clock::now() + std::chrono::milliseconds(timeout_ms) + kParseBudget;
+    std::string in;
+    int sharedFd = -1;
+    auto closeShared = [&] {
+        if (sharedFd >= 0) ::close(sharedFd);
+        sharedFd = -1;
+    };
+    char buf[65536];
+    while (in.size() < 4 || in.size() - 4 < get_u32(in.data())) {
+        if (cancel && cancel->load()) {
+            closeShared();
+            close();   // the answer would still arrive; drop the connection instead
+            result.response.cancelled = true;
+            result.response.error = "cancelled";
+            return result;
+        }
+        if (Clock::now() >= deadline) {
+            closeShared();
+            return fail("page daemon timed out");
+        }
+        pollfd pfd {fd_, POLLIN, 0};
+        if (::poll(&pfd, 1, static_cast<int>(CurlSession::kPollInterval.count())) <= 0) continue;
+
+        iovec iov {buf, sizeof(buf)};
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+        msghdr msg {};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        ssize_t n = ::recvmsg(fd_, &msg, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            closeShared();
+            return fail("page daemon closed the connection");
+        }
+        for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+                closeShared();
+                std::memcpy(&sharedFd, CMSG_DATA(cmsg), sizeof(int));
+            }
+        }
+        in.append(buf, static_cast<std::size_t>(n));
+        if (in.size() >= 4 && get_u32(in.data()) > kMaxResponse) {
+            closeShared();
+            return fail("page daemon sent an oversized response");
+        }
+    }
+
+    Reader frame {in.data() + 4, in.data() + in.size()};
+    std::uint32_t gotId, flags, status;
+    bool ok = frame.u32(gotId) && frame.u32(flags) && frame.u32(status) && gotId == id
+           && frame.string(result.response.url) && frame.string(result.response.content_type)
+           && frame.string(result.response.error);
+    if (ok && (flags & kSharedMemory)) {
+        // The page is read straight from the daemon's shared memory object
+        std::uint64_t size = 0;
+        struct stat st {};
+        ok = frame.u64(size) && sharedFd >= 0 && ::fstat(sharedFd, &st) == 0 && static_cast<std::uint64_t>(st.st_size) >= size
+          && size > 0;
+        if (ok) {
+            void* p = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, sharedFd, 0);
+            ok = p != MAP_FAILED && decode_page(std::string_view(static_cast<const char*>(p), size), result.page);
+            if (p != MAP_FAILED) ::munmap(p, size);
+        }
+        result.sharedMemory = true;
+    } else if (ok) {
+        ok = decode_page(std::string_view(frame.p, static_cast<std::size_t>(frame.end - frame.p)), result.page);
+    }
+    closeShared();
+    if (!ok) {
+        result = DaemonPage{};
+        return fail("malformed page daemon response");
+    }
+    result.response.status = status;
+    result.page.truncated = (flags & kTruncated) != 0;
+    result.cached = (flags & kCached) != 0;
+    return result;
+}
+
+std::string default_daemon_socket() {
+    if (const char* dir = std::getenv("XDG_RUNTIME_DIR"); dir && *dir) return std::string(dir) + "/mini-browser.sock";
+    return "/tmp/mini-browser-" + std::to_string(::getuid()) + ".sock";
+}
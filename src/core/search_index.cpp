@@ -0,0 +1,637 @@
+#include "core/search_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr char kMagic[4] = {'M', 'B', 'I', 'X'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::size_t kHeaderSize = 64;
+constexpr std::size_t kTermEntrySize = 24;
+constexpr std::size_t kMaxTermLength = 40;
+constexpr std::uint32_t kTitleWeight = 3;
+constexpr std::uint32_t kDead = 0xFFFFFFFFu;
+
+// BM25 parameters
+constexpr double kK1 = 1.2;
+constexpr double kB = 0.75;
+
+// ---- little helpers for the on-disk format ----
+
+void put_u32(std::string& out, std::uint32_t v) { out.append(reinterpret_cast<const char*>(&v), 4); }
+void put_u64(std::string& out, std::uint64_t v) { out.append(reinterpret_cast<const char*>(&v), 8); }
+
+void put_varint(std::string& out, std::uint32_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<char>((v & 0x7F) | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<char>(v));
+}
+
+void put_bytes(std::string& out, std::string_view s) {
+    put_varint(out, static_cast<std::uint32_t>(s.size()));
+    out.append(s);
+}
+
+std::uint32_t get_u32(const char* p) { std::uint32_t v; std::memcpy(&v, p, 4); return v; }
+std::uint64_t get_u64(const char* p) { std::uint64_t v; std::memcpy(&v, p, 8); return v; }
+
+// Readers never run past `end`: a corrupt segment yields false, not an out-of-bounds read
+bool get_varint(const char*& p, const char* end, std::uint32_t& v) {
+    v = 0;
+    for (int shift = 0; p < end && shift < 35; shift += 7) {
+        auto byte = static_cast<unsigned char>(*p++);
+        v |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+bool get_bytes(const char*& p, const char* end, std::string_view& s) {
+    std::uint32_t len;
+    if (!get_varint(p, end, len) || len > static_cast<std::size_t>(end - p)) return false;
+    s = std::string_view(p, len);
+    p += len;
+    return true;
+}
+
+bool is_word_byte(unsigned char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c >= 0x80;
+}
+
+// Calls fn(term) for every term; terms point into `scratch`, which is reused
+template <class F>
+void for_each_term(std::string_view text, std::string& scratch, F&& fn) {
+    std::size_t i = 0;
+    const std::size_t n = text.size();
+    while (i < n) {
+        while (i < n && !is_word_byte(static_cast<unsigned char>(text[i]))) ++i;
+        std::size_t start = i;
+        while (i < n && is_word_byte(static_cast<unsigned char>(text[i]))) ++i;
+        std::size_t len = std::min(i - start, kMaxTermLength);
+        if (len < 2) continue;
+        scratch.assign(text.data() + start, len);
+        for (char& c : scratch) {
+            if (c >= 'A' && c <= 'Z') c = static_cast<char>(c + ('a' - 'A'));
+        }
+        fn(std::string_view(scratch));
+    }
+}
+
+std::string segment_name(std::uint32_t number) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "seg-%08u.mbi", number);
+    return buf;
+}
+
+// Segment numbers present in dir, ascending
+std::vector<std::uint32_t> list_segments(const std::string& dir) {
+    std::vector<std::uint32_t> numbers;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        std::string name = entry.path().filename().string();
+        unsigned number = 0;
+        char tail = 0;
+        if (name.size() == 16 && std::sscanf(name.c_str(), "seg-%8u.mb%c", &number, &tail) == 2 && tail == 'i') {
+            numbers.push_back(number);
+        }
+    }
+    std::sort(numbers.begin(), numbers.end());
+    return numbers;
+}
+
+/**
+ * Exclusive flock on dir/lock, held while segments are numbered, written or
+ * compacted: browser instances sharing an index take turns instead of
+ * picking the same segment number and renaming over each other's files.
+ */
+class IndexDirLock {
+public:
+    explicit IndexDirLock(const std::string& dir)
+        : fd_(::open((fs::path(dir) / "lock").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600)) {
+        while (fd_ >= 0 && ::flock(fd_, LOCK_EX) < 0 && errno == EINTR) {
+        }
+    }
+    ~IndexDirLock() {
+        if (fd_ >= 0) ::close(fd_);   // releases the lock
+    }
+    IndexDirLock(const IndexDirLock&) = delete;
+    IndexDirLock& operator=(const IndexDirLock&) = delete;
+
+private:
+    int fd_;
+};
+
+std::uint32_t next_segment_number(const std::string& dir) {
+    auto numbers = list_segments(dir);
+    return numbers.empty() ? 1 : numbers.back() + 1;
+}
+
+/**
+ * Serializes one segment. Documents are added first, then terms in
+ * ascending order, each followed by its postings in ascending doc order.
+ */
+class SegmentBuilder {
+public:
+    void addDoc(std::string_view url, std::string_view title, std::uint32_t length) {
+        docOffsets_.push_back(docs_.size());
+        put_u32(docs_, length);
+        put_bytes(docs_, url);
+        put_bytes(docs_, title);
+        totalLength_ += length;
+    }
+
+    void beginTerm(std::string_view term) {
+        term_ = term;
+        termStart_ = postings_.size();
+        lastDoc_ = 0;
+        docFreq_ = 0;
+    }
+
+    void addPosting(std::uint32_t doc, std::uint32_t tf) {
+        put_varint(postings_, doc - lastDoc_);
+        put_varint(postings_, tf);
+        lastDoc_ = doc;
+        ++docFreq_;
+    }
+
+    void endTerm() {
+        if (docFreq_ == 0) return;
+        put_u64(terms_, termStart_);
+        put_u32(terms_, static_cast<std::uint32_t>(blob_.size()));
+        put_u32(terms_, docFreq_);
+        put_u32(terms_, static_cast<std::uint32_t>(term_.size()));
+        put_u32(terms_, static_cast<std::uint32_t>(postings_.size() - termStart_));
+        blob_.append(term_);
+        ++termCount_;
+    }
+
+    bool write(const std::string& path) const {
+        const std::uint64_t docIndexOffset = kHeaderSize + docs_.size();
+        const std::uint64_t termIndexOffset = docIndexOffset + 8 * docOffsets_.size();
+        const std::uint64_t blobOffset = termIndexOffset + terms_.size();
+        const std::uint64_t postingsOffset = blobOffset + blob_.size();
+        const std::uint64_t fileSize = postingsOffset + postings_.size();
+
+        std::string header(kMagic, 4);
+        put_u32(header, kVersion);
+        put_u32(header, static_cast<std::uint32_t>(docOffsets_.size()));
+        put_u32(header, termCount_);
+        put_u64(header, totalLength_);
+        put_u64(header, docIndexOffset);
+        put_u64(header, termIndexOffset);
+        put_u64(header, blobOffset);
+        put_u64(header, postingsOffset);
+        put_u64(header, fileSize);
+
+        std::string docIndex;
+        docIndex.reserve(8 * docOffsets_.size());
+        for (std::uint64_t off : docOffsets_) put_u64(docIndex, kHeaderSize + off);
+
+        // Write next to the target and rename, so readers never see a partial segment
+        std::string tmp = path + ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            if (!out) return false;
+            out.write(header.data(), static_cast<std::streamsize>(header.size()));
+            out.write(docs_.data(), static_cast<std::streamsize>(docs_.size()));
+            out.write(docIndex.data(), static_cast<std::streamsize>(docIndex.size()));
+            out.write(terms_.data(), static_cast<std::streamsize>(terms_.size()));
+            out.write(blob_.data(), static_cast<std::streamsize>(blob_.size()));
+            out.write(postings_.data(), static_cast<std::streamsize>(postings_.size()));
+            if (!out) return false;
+        }
+        std::error_code ec;
+        fs::rename(tmp, path, ec);
+        return !ec;
+    }
+
+private:
+    std::string docs_;
+    std::vector<std::uint64_t> docOffsets_;
+    std::uint64_t totalLength_ = 0;
+
+    std::string terms_;
+    std::string blob_;
+    std::string postings_;
+    std::uint32_t termCount_ = 0;
+
+    std::string term_;
+    std::uint64_t termStart_ = 0;
+    std::uint32_t lastDoc_ = 0;
+    std::uint32_t docFreq_ = 0;
+};
+
+struct TermEntry {
+    std::uint64_t postings;
+    std::uint32_t docFreq;
+    std::uint32_t bytes;
+};
+
+}
+
+void tokenize_terms(std::string_view text, std::vector<std::string>& out) {
+    std::string scratch;
+    for_each_term(text, scratch, [&](std::string_view term) { out.emplace_back(term); });
+}
+
+// ---------------------------------------------------------------- IndexWriter
+
+void IndexWriter::add(const std::string& url, const std::string& title, std::string_view text) {
+    const auto doc = static_cast<std::uint32_t>(docs_.size());
+    std::unordered_map<std::string, std::uint32_t> counts;
+    std::uint32_t length = 0;
+    std::string scratch;
+    if (text.size() > kMaxTextBytes) {
+        // Back up to a word break so no term is indexed half cut. A run longer than
+        // kMaxTermLength (CJK text has no ASCII breaks) is clipped to its start anyway,
+        // so there it is enough not to split a UTF-8 sequence
+        std::size_t cut = kMaxTextBytes;
+        const std::size_t stop = kMaxTextBytes - kMaxTermLength;
+        while (cut > stop && is_word_byte(static_cast<unsigned char>(text[cut]))) --cut;
+        if (cut == stop && is_word_byte(static_cast<unsigned char>(text[cut]))) {
+            cut = kMaxTextBytes;
+            while (cut > stop && (static_cast<unsigned char>(text[cut]) & 0xC0) == 0x80) --cut;
+        }
+        text = text.substr(0, cut);
+    }
+    for_each_term(title, scratch, [&](std::string_view t) {
+        counts[std::string(t)] += kTitleWeight;
+        length += kTitleWeight;
+    });
+    for_each_term(text, scratch, [&](std::string_view t) {
+        ++counts[std::string(t)];
+        ++length;
+    });
+    for (auto& [term, tf] : counts) {
+        postings_[term].push_back({doc, tf});
+    }
+    docs_.push_back({url, title, length});
+}
+
+bool IndexWriter::flush(const std::string& dir) {
+    if (docs_.empty()) return true;
+
+    std::vector<const std::string*> terms;
+    terms.reserve(postings_.size());
+    for (const auto& entry : postings_) terms.push_back(&entry.first);
+    std::sort(terms.begin(), terms.end(), [](const std::string* a, const std::string* b) { return *a < *b; });
+
+    SegmentBuilder builder;
+    for (const auto& d : docs_) builder.addDoc(d.url, d.title, d.length);
+    for (const std::string* term : terms) {
+        builder.beginTerm(*term);
+        for (const Posting& p : postings_[*term]) builder.addPosting(p.doc, p.tf);
+        builder.endTerm();
+    }
+
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+    IndexDirLock lock(dir);
+    bool ok = builder.write((fs::path(dir) / segment_name(next_segment_number(dir))).string());
+    docs_.clear();
+    postings_.clear();
+    return ok;
+}
+
+// ---------------------------------------------------------------- IndexReader
+
+IndexReader::IndexReader(const std::string& dir) {
+    for (std::uint32_t number : list_segments(dir)) {
+        Segment seg;
+        seg.number = number;
+        if (!seg.file.open((fs::path(dir) / segment_name(number)).string())) continue;
+        const char* base = seg.file.data();
+        const std::size_t size = seg.file.size();
+        if (size < kHeaderSize || std::memcmp(base, kMagic, 4) != 0 || get_u32(base + 4) != kVersion) continue;
+        if (get_u64(base + 56) != size) continue; // truncated or foreign file
+
+        seg.docCount = get_u32(base + 8);
+        seg.termCount = get_u32(base + 12);
+        const std::uint64_t docIndex = get_u64(base + 24);
+        const std::uint64_t termIndex = get_u64(base + 32);
+        const std::uint64_t termBlob = get_u64(base + 40);
+        const std::uint64_t postings = get_u64(base + 48);
+        // Sections follow each other in this order; tables must fit before the next one
+        if (docIndex < kHeaderSize || termIndex < docIndex || termBlob < termIndex || postings < termBlob || postings > size) continue;
+        if (8 * std::uint64_t(seg.docCount) > termIndex - docIndex) continue;
+        if (kTermEntrySize * std::uint64_t(seg.termCount) > termBlob - termIndex) continue;
+
+        seg.docIndex = base + docIndex;
+        seg.termIndex = base + termIndex;
+        seg.termBlob = base + termBlob;
+        seg.postings = base + postings;
+        docCount_ += seg.docCount;
+        totalLength_ += get_u64(base + 16);
+        segments_.push_back(std::move(seg));
+    }
+}
+
+namespace {
+
+// Entry i of a term table; false if its term or postings lie outside their sections
+bool term_at(const char* termIndex, std::uint32_t i, std::string_view blob, std::uint64_t postingsSize,
+             std::string_view& term, TermEntry& entry) {
+    const char* e = termIndex + std::size_t(i) * kTermEntrySize;
+    const std::uint32_t start = get_u32(e + 8);
+    const std::uint32_t len = get_u32(e + 16);
+    entry = {get_u64(e), get_u32(e + 12), get_u32(e + 20)};
+    if (start > blob.size() || len > blob.size() - start) return false;
+    if (entry.postings > postingsSize || entry.bytes > postingsSize - entry.postings) return false;
+    term = blob.substr(start, len);
+    return true;
+}
+
+// Binary search of the sorted term table; a corrupt entry on the way ends the search
+bool find_term(const char* termIndex, std::uint32_t count, std::string_view blob, std::uint64_t postingsSize,
+               std::string_view term, TermEntry& out) {
+    std::uint32_t lo = 0, hi = count;
+    while (lo < hi) {
+        std::uint32_t mid = lo + (hi - lo) / 2;
+        std::string_view t;
+        if (!term_at(termIndex, mid, blob, postingsSize, t, out)) return false;
+        int cmp = t.compare(term);
+        if (cmp == 0) return true;
+        if (cmp < 0) lo = mid + 1; else hi = mid;
+    }
+    return false;
+}
+
+// Next (doc, tf) of a postings list, with doc ids checked against the segment's documents
+bool next_posting(const char*& p, const char* end, std::uint32_t docCount, std::uint32_t& doc, std::uint32_t& tf) {
+    std::uint32_t delta;
+    if (!get_varint(p, end, delta) || !get_varint(p, end, tf)) return false;
+    doc += delta;
+    return doc < docCount;
+}
+
+struct DocRecord {
+    std::uint32_t length;
+    std::string_view url;
+    std::string_view title;
+};
+
+// Start of a doc record, or nullptr if its offset points outside the docs section (which ends at the doc index)
+const char* doc_record(const char* base, const char* docIndex, std::uint32_t doc) {
+    const std::uint64_t off = get_u64(docIndex + std::size_t(doc) * 8);
+    return off >= kHeaderSize && off + 4 <= std::uint64_t(docIndex - base) ? base + off : nullptr;
+}
+
+bool read_doc(const char* base, const char* docIndex, std::uint32_t doc, DocRecord& r) {
+    const char* p = doc_record(base, docIndex, doc);
+    if (!p) return false;
+    r.length = get_u32(p);
+    p += 4;
+    return get_bytes(p, docIndex, r.url) && get_bytes(p, docIndex, r.title);
+}
+
+}
+
+std::vector<SearchHit> IndexReader::search(std::string_view query, std::size_t limit) const {
+    std::vector<std::string> terms;
+    tokenize_terms(query, terms);
+    std::sort(terms.begin(), terms.end());
+    terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+    if (terms.empty() || docCount_ == 0 || limit == 0) return {};
+
+    const double n = static_cast<double>(docCount_);
+    const double avgLength = std::max(1.0, static_cast<double>(totalLength_) / n);
+
+    // Dense per-segment accumulators; `touched` remembers which docs scored
+    std::vector<std::vector<double>> scores(segments_.size());
+    std::vector<std::vector<std::uint32_t>> touched(segments_.size());
+    std::vector<TermEntry> entries(segments_.size());
+    std::vector<bool> present(segments_.size());
+    for (const std::string& term : terms) {
+        std::uint64_t df = 0;
+        for (std::size_t s = 0; s < segments_.size(); ++s) {
+            const Segment& seg = segments_[s];
+            present[s] = find_term(seg.termIndex, seg.termCount, seg.blob(), seg.postingsSize(), term, entries[s]);
+            if (present[s]) df += entries[s].docFreq;
+        }
+        if (df == 0) continue;
+        const double idf = std::log(1.0 + (n - static_cast<double>(df) + 0.5) / (static_cast<double>(df) + 0.5));
+
+        for (std::size_t s = 0; s < segments_.size(); ++s) {
+            if (!present[s]) continue;
+            const Segment& seg = segments_[s];
+            if (scores[s].empty()) scores[s].assign(seg.docCount, 0.0);
+            const char* p = seg.postings + entries[s].postings;
+            const char* end = p + entries[s].bytes;
+            std::uint32_t doc = 0, freq = 0;
+            for (std::uint32_t k = 0; k < entries[s].docFreq && next_posting(p, end, seg.docCount, doc, freq); ++k) {
+                const char* record = doc_record(seg.file.data(), seg.docIndex, doc);
+                if (!record) break;
+                const double tf = freq;
+                const double length = get_u32(record);
+                const double norm = kK1 * (1.0 - kB + kB * length / avgLength);
+                if (scores[s][doc] == 0.0) touched[s].push_back(doc);
+                scores[s][doc] += idf * tf * (kK1 + 1.0) / (tf + norm);
+            }
+        }
+    }
+
+    std::vector<std::pair<double, std::uint64_t>> ranked;
+    for (std::size_t s = 0; s < segments_.size(); ++s) {
+        for (std::uint32_t doc : touched[s]) ranked.emplace_back(scores[s][doc], (std::uint64_t(s) << 32) | doc);
+    }
+
+    // Over-fetch so dropping older copies of a URL still leaves `limit` hits
+    const std::size_t keep = std::min(ranked.size(), limit * 4);
+    auto byScore = [](const auto& a, const auto& b) { return a.first != b.first ? a.first > b.first : a.second < b.second; };
+    std::partial_sort(ranked.begin(), ranked.begin() + static_cast<std::ptrdiff_t>(keep), ranked.end(), byScore);
+    ranked.resize(keep);
+
+    std::unordered_map<std::string_view, std::size_t> byUrl; // url -> index in hits
+    std::vector<SearchHit> hits;
+    std::vector<std::size_t> hitSegment;
+    for (const auto& [score, key] : ranked) {
+        const auto s = static_cast<std::size_t>(key >> 32);
+        const Segment& seg = segments_[s];
+        DocRecord rec;
+        if (!read_doc(seg.file.data(), seg.docIndex, static_cast<std::uint32_t>(key), rec)) continue;
+        auto it = byUrl.find(rec.url);
+        if (it != byUrl.end()) {
+            if (hitSegment[it->second] >= s) continue;
+            // A newer copy replaces the older one, keeping the newer score
+            hits[it->second] = {std::string(rec.url), std::string(rec.title), score};
+            hitSegment[it->second] = s;
+            continue;
+        }
+        byUrl.emplace(rec.url, hits.size());
+        hits.push_back({std::string(rec.url), std::string(rec.title), score});
+        hitSegment.push_back(s);
+    }
+    std::stable_sort(hits.begin(), hits.end(), [](const SearchHit& a, const SearchHit& b) { return a.score > b.score; });
+    if (hits.size() > limit) hits.resize(limit);
+    return hits;
+}
+
+// ---------------------------------------------------------------- compaction
+
+bool compact_index(const std::string& dir) {
+    IndexDirLock lock(dir);
+    IndexReader reader(dir);
+    const auto& segs = reader.segments_;
+    if (segs.size() <= 1) return true;
+
+    // Newest copy of each URL stays alive; ids are assigned in (segment, doc) order
+    std::unordered_map<std::string_view, std::pair<std::size_t, std::uint32_t>> latest;
+    for (std::size_t s = 0; s < segs.size(); ++s) {
+        for (std::uint32_t d = 0; d < segs[s].docCount; ++d) {
+            DocRecord rec;
+            if (read_doc(segs[s].file.data(), segs[s].docIndex, d, rec)) latest[rec.url] = {s, d};
+        }
+    }
+
+    SegmentBuilder builder;
+    std::vector<std::vector<std::uint32_t>> remap(segs.size());
+    std::uint32_t nextId = 0;
+    for (std::size_t s = 0; s < segs.size(); ++s) {
+        remap[s].assign(segs[s].docCount, kDead);
+        for (std::uint32_t d = 0; d < segs[s].docCount; ++d) {
+            DocRecord rec;
+            if (!read_doc(segs[s].file.data(), segs[s].docIndex, d, rec) || latest[rec.url] != std::make_pair(s, d)) continue;
+            remap[s][d] = nextId++;
+            builder.addDoc(rec.url, rec.title, rec.length);
+        }
+    }
+
+    // K-way merge of the sorted term tables
+    std::vector<std::uint32_t> cursor(segs.size(), 0);
+    // Segment s's current term, skipping corrupt entries; false once its table is exhausted
+    auto current = [&](std::size_t s, std::string_view& term, TermEntry& entry) {
+        for (; cursor[s] < segs[s].termCount; ++cursor[s]) {
+            if (term_at(segs[s].termIndex, cursor[s], segs[s].blob(), segs[s].postingsSize(), term, entry)) return true;
+        }
+        return false;
+    };
+    while (true) {
+        std::string_view smallest;
+        bool any = false;
+        for (std::size_t s = 0; s < segs.size(); ++s) {
+            std::string_view t;
+            TermEntry entry;
+            if (!current(s, t, entry)) continue;
+            if (!any || t < smallest) { smallest = t; any = true; }
+        }
+        if (!any) break;
+
+        builder.beginTerm(smallest);
+        for (std::size_t s = 0; s < segs.size(); ++s) {
+            std::string_view t;
+            TermEntry entry;
+            if (!current(s, t, entry) || t != smallest) continue;
+            const char* p = segs[s].postings + entry.postings;
+            const char* end = p + entry.bytes;
+            std::uint32_t doc = 0, tf = 0;
+            for (std::uint32_t k = 0; k < entry.docFreq && next_posting(p, end, segs[s].docCount, doc, tf); ++k) {
+                if (remap[s][doc] != kDead) builder.addPosting(remap[s][doc], tf);
+            }
+            ++cursor[s];
+        }
+        builder.endTerm();
+    }
+
+    std::uint32_t number = segs.back().number + 1;
+    if (!builder.write((fs::path(dir) / segment_name(number)).string())) return false;
+    for (const auto& seg : segs) {
+        std::error_code ec;
+        fs::remove(fs::path(dir) / segment_name(seg.number), ec);
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------- SearchIndex
+
+SearchIndex::SearchIndex(std::string dir) : dir_(std::move(dir)) {
+    std::error_code ec;
+    fs::create_directories(dir_, ec);
+    reader_ = std::make_shared<const IndexReader>(dir_);
+    worker_ = std::thread([this]{ workerLoop(); });
+}
+
+SearchIndex::~SearchIndex() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    worker_.join();
+}
+
+void SearchIndex::addAsync(std::string url, std::string title, std::shared_ptr<const std::string> text) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back({std::move(url), std::move(title), std::move(text)});
+    }
+    cv_.notify_one();
+}
+
+std::vector<SearchHit> SearchIndex::search(std::string_view query, std::size_t limit) const {
+    std::shared_ptr<const IndexReader> reader;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        reader = reader_;
+    }
+    return reader->search(query, limit);
+}
+
+void SearchIndex::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    flushRequested_ = true;
+    cv_.notify_one();
+    idle_.wait(lock, [this]{ return !flushRequested_ && queue_.empty() && !busy_; });
+}
+
+void SearchIndex::writeBatch(IndexWriter& writer) {
+    writer.flush(dir_);
+    auto reader = std::make_shared<const IndexReader>(dir_);
+    if (reader->segmentCount() > kMaxSegments && compact_index(dir_)) {
+        reader = std::make_shared<const IndexReader>(dir_);
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    reader_ = std::move(reader);
+}
+
+void SearchIndex::workerLoop() {
+    IndexWriter writer;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        bool woken = cv_.wait_for(lock, kIdleFlush, [this]{ return stopping_ || flushRequested_ || !queue_.empty(); });
+
+        busy_ = true;
+        while (!queue_.empty()) {
+            Page page = std::move(queue_.front());
+            queue_.pop_front();
+            lock.unlock();
+            writer.add(page.url, page.title, *page.text);
+            page.text.reset();
+            if (writer.pending() >= kBatchSize) writeBatch(writer);
+            lock.lock();
+        }
+        // Partial batches go out when idle, on request, or at shutdown
+        if (writer.pending() > 0 && (!woken || flushRequested_ || stopping_)) {
+            lock.unlock();
+            writeBatch(writer);
+            lock.lock();
+        }
+        busy_ = false;
+        flushRequested_ = false;
+        idle_.notify_all();
+        if (stopping_) return;
+    }
+}
@@ -0,0 +1,193 @@
+#include "core/session_snapshot.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr char kMagic[4] = {'M', 'B', 'S', 'S'};
+constexpr std::size_t kHeaderSize = 64;
+constexpr std::size_t kLinkSize = 24;
+constexpr std::uint32_t kTruncated = 1;
+
+void put_u32(std::string& out, std::uint32_t v) { out.append(reinterpret_cast<const char*>(&v), 4); }
+void put_u64(std::string& out, std::uint64_t v) { out.append(reinterpret_cast<const char*>(&v), 8); }
+
+std::uint32_t get_u32(const char* p) { std::uint32_t v; std::memcpy(&v, p, 4); return v; }
+std::uint64_t get_u64(const char* p) { std::uint64_t v; std::memcpy(&v, p, 8); return v; }
+
+// Appends each distinct string to the table once and hands out its id
+class StringTable {
+public:
+    explicit StringTable(std::string& out) : out_(out) {}
+
+    // Always appends: the fixed ids (URL, title, text) may repeat other strings
+    std::uint32_t add(std::string_view s) {
+        offsets_.push_back(out_.size());
+        put_u32(out_, static_cast<std::uint32_t>(s.size()));
+        out_.append(s);
+        return static_cast<std::uint32_t>(offsets_.size() - 1);
+    }
+
+    std::uint32_t intern(std::string_view s) {
+        auto [it, inserted] = ids_.try_emplace(s, 0);
+        if (inserted) it->second = add(s);
+        return it->second;
+    }
+
+    const std::vector<std::uint64_t>& offsets() const { return offsets_; }
+
+private:
+    std::string& out_;
+    std::vector<std::uint64_t> offsets_;
+    std::unordered_map<std::string_view, std::uint32_t> ids_;   ///< Views into the caller's strings
+};
+
+}
+
+bool save_session(const std::string& path, const SessionState& state) {
+    const ParsedPage& page = state.page;
+
+    std::string body;   // everything after the header; offsets are fixed up by kHeaderSize
+    std::size_t textBytes = state.url.size() + page.title.size() + page.text.size();
+    body.reserve(textBytes + page.links.size() * (kLinkSize + 64) + 256);
+
+    StringTable strings(body);
+    strings.add(state.url);
+    strings.add(page.title);
+    strings.add(page.text);
+    std::vector<std::uint32_t> linkIds;
+    linkIds.reserve(page.links.size() * 2);
+    for (const Link& link : page.links) {
+        linkIds.push_back(strings.intern(link.url));
+        linkIds.push_back(strings.intern(link.text));
+    }
+    std::vector<std::uint32_t> historyIds;
+    for (const std::string& url : state.history) historyIds.push_back(strings.intern(url));
+
+    const std::uint64_t stringIndexOffset = kHeaderSize + body.size();
+    for (std::uint64_t off : strings.offsets()) put_u64(body, kHeaderSize + off);
+    const std::uint64_t linksOffset = kHeaderSize + body.size();
+    for (std::size_t i = 0; i < page.links.size(); ++i) {
+        put_u64(body, page.links[i].start_pos);
+        put_u64(body, page.links[i].end_pos);
+        put_u32(body, linkIds[2 * i]);
+        put_u32(body, linkIds[2 * i + 1]);
+    }
+    for (std::uint32_t id : historyIds) put_u32(body, id);
+    const std::uint64_t fileSize = kHeaderSize + body.size();
+
+    std::string header(kMagic, 4);
+    put_u32(header, SessionSnapshot::kVersion);
+    put_u32(header, page.truncated ? kTruncated : 0);
+    put_u32(header, static_cast<std::uint32_t>(strings.offsets().size()));
+    put_u32(header, static_cast<std::uint32_t>(page.links.size()));
+    put_u32(header, static_cast<std::uint32_t>(historyIds.size()));
+    put_u64(header, static_cast<std::uint64_t>(state.status));
+    put_u64(header, state.scrollAnchor);
+    put_u64(header, stringIndexOffset);
+    put_u64(header, linksOffset);
+    put_u64(header, fileSize);
+
+    std::error_code ec;
+    fs::path target(path);
+    if (target.has_parent_path()) fs::create_directories(target.parent_path(), ec);
+
+    // Write next to the target and rename, so a crash never leaves a partial snapshot
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        out.write(header.data(), static_cast<std::streamsize>(header.size()));
+        out.write(body.data(), static_cast<std::streamsize>(body.size()));
+        if (!out) return false;
+    }
+    fs::rename(tmp, path, ec);
+    return !ec;
+}
+
+bool SessionSnapshot::open(const std::string& path) {
+    *this = SessionSnapshot();
+    MappedFile file;
+    if (!file.open(path)) return false;
+
+    const char* base = file.data();
+    const std::size_t size = file.size();
+    if (size < kHeaderSize || std::memcmp(base, kMagic, 4) != 0 || get_u32(base + 4) != kVersion) return false;
+    if (get_u64(base + 56) != size) return false;   // truncated or foreign file
+
+    const std::uint32_t stringCount = get_u32(base + 12);
+    const std::uint32_t linkCount = get_u32(base + 16);
+    const std::uint32_t historyCount = get_u32(base + 20);
+    const std::uint64_t stringIndexOffset = get_u64(base + 40);
+    const std::uint64_t linksOffset = get_u64(base + 48);
+    if (stringCount < 3 || stringIndexOffset < kHeaderSize || stringIndexOffset > size) return false;
+    if (linksOffset != stringIndexOffset + 8ull * stringCount) return false;
+    if (linksOffset + kLinkSize * linkCount + 4ull * historyCount != size) return false;
+
+    // Every string must lie inside the string table
+    for (std::uint32_t i = 0; i < stringCount; ++i) {
+        std::uint64_t off = get_u64(base + stringIndexOffset + 8ull * i);
+        if (off < kHeaderSize || off + 4 > stringIndexOffset) return false;
+        if (off + 4 + get_u32(base + off) > stringIndexOffset) return false;
+    }
+
+    const std::size_t textSize = get_u32(base + get_u64(base + stringIndexOffset + 16));
+    for (std::uint32_t i = 0; i < linkCount; ++i) {
+        const char* rec = base + linksOffset + kLinkSize * i;
+        std::uint64_t start = get_u64(rec), end = get_u64(rec + 8);
+        if (start > end || end > textSize || get_u32(rec + 16) >= stringCount || get_u32(rec + 20) >= stringCount) {
+            return false;
+        }
+    }
+    const char* historyIds = base + linksOffset + kLinkSize * linkCount;
+    for (std::uint32_t i = 0; i < historyCount; ++i) {
+        if (get_u32(historyIds + 4ull * i) >= stringCount) return false;
+    }
+
+    stringIndex_ = base + stringIndexOffset;
+    stringCount_ = stringCount;
+    links_ = base + linksOffset;
+    historyIds_ = historyIds;
+    linkCount_ = linkCount;
+    historyCount_ = historyCount;
+    truncated_ = (get_u32(base + 8) & kTruncated) != 0;
+    status_ = static_cast<long>(get_u64(base + 24));
+    scrollAnchor_ = get_u64(base + 32);
+    file_ = std::move(file);
+    return true;
+}
+
+std::string_view SessionSnapshot::string(std::uint32_t id) const {
+    if (id >= stringCount_) return {};
+    const char* p = file_.data() + get_u64(stringIndex_ + 8ull * id);
+    return {p + 4, get_u32(p)};
+}
+
+Link SessionSnapshot::link(std::size_t i) const {
+    const char* rec = links_ + kLinkSize * i;
+    Link link;
+    link.start_pos = get_u64(rec);
+    link.end_pos = get_u64(rec + 8);
+    link.url = string(get_u32(rec + 16));
+    link.text = string(get_u32(rec + 20));
+    return link;
+}
+
+std::string_view SessionSnapshot::history(std::size_t i) const {
+    return string(get_u32(historyIds_ + 4 * i));
+}
+
+ParsedPage SessionSnapshot::page() const {
+    ParsedPage page;
+    page.title = title();
+    page.text = text();
+    page.truncated = truncated_;
+    page.links.reserve(linkCount_);
+    for (std::size_t i = 0; i < linkCount_; ++i) page.links.push_back(link(i));
+    return page;
+}
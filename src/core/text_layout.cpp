@@ -0,0 +1,300 @@
+#include "core/text_layout.h"
+#include "core/alloc_tracker.h"
+#include "core/charset.h"
+#include "core/executor.h"
+#include "core/trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace {
+
+bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+}
+
+// Width of UTF-8 text, decoded a block at a time so measuring never allocates
+float measure_utf8(std::string_view text, const GlyphMetrics& metrics) {
+    char32_t block[64];
+    std::size_t n = 0;
+    float w = 0.f;
+    for (std::size_t i = 0; i < text.size();) {
+        const auto c = static_cast<unsigned char>(text[i]);
+        if (c < 0x80) {
+            block[n] = c;
+            ++i;
+        } else {
+            i += decode_utf8(text, i, block[n]);
+        }
+        if (++n == std::size(block)) {
+            w += metrics.measure(std::u32string_view(block, n));
+            n = 0;
+        }
+    }
+    return w + metrics.measure(std::u32string_view(block, n));
+}
+
+// Lines and runs for a range of whole paragraphs
+struct Piece {
+    std::vector<LayoutLine> lines;
+    std::vector<LayoutRun> runs;
+};
+
+Piece layout_piece(std::string_view text, std::size_t begin, std::size_t end, const GlyphMetrics& metrics,
+                   float width) {
+    TRACE_SCOPE("layout", "layout_piece");
+    AllocPhaseScope phase(AllocPhase::Layout);
+    Piece piece;
+    const float space = metrics.advance(U' ');
+    std::size_t j = begin;
+    while (true) {
+        std::size_t lineEnd = text.find('\n', j);
+        if (lineEnd == std::string_view::npos || lineEnd > end) lineEnd = end;
+
+        LayoutLine line {piece.runs.size(), 0, j};
+        float x = 0.f;
+        while (true) {
+            while (j < lineEnd && is_space(text[j])) ++j;
+            if (j >= lineEnd) break;
+            std::size_t q = j;
+            while (q < lineEnd && !is_space(text[q])) ++q;
+            const float w = measure_utf8(text.substr(j, q - j), metrics);
+
+            if (line.runCount > 0) {
+                // Run offsets are 32-bit relative to the line, so a line also ends before 4 GB
+                if (x + space + w <= width && q - line.byteStart <= UINT32_MAX) {
+                    x += space;
+                } else {
+                    piece.lines.push_back(line);
+                    line = LayoutLine{piece.runs.size(), 0, j};
+                    x = 0.f;
+                }
+            }
+            piece.runs.push_back(LayoutRun{static_cast<std::uint32_t>(j - line.byteStart),
+                                           static_cast<std::uint32_t>(q - j), x, w});
+            ++line.runCount;
+            x += w;
+            j = q;
+        }
+        piece.lines.push_back(line);
+
+        // A trailing '\n' ends the piece; the paragraph after it starts the next one
+        if (lineEnd >= end) break;
+        j = lineEnd + 1;
+        if (j >= end) break;
+    }
+    return piece;
+}
+
+// The pieces of one parallel layout, claimed in order by the caller and by helper tasks
+struct PieceWork {
+    std::string_view text;
+    const GlyphMetrics* metrics;
+    float width;
+    std::vector<std::size_t> bounds;
+    std::vector<Piece> pieces;
+    std::atomic<std::size_t> next {0};
+    std::atomic<std::size_t> done {0};
+
+    // Lay out unclaimed pieces until none are left; a helper that starts late finds none
+    void help() {
+        for (std::size_t p; (p = next.fetch_add(1, std::memory_order_relaxed)) < pieces.size();) {
+            pieces[p] = layout_piece(text, bounds[p], bounds[p + 1], *metrics, width);
+            done.fetch_add(1, std::memory_order_release);
+            done.notify_all();
+        }
+    }
+};
+
+// Piece boundaries just after a '\n', roughly `target` bytes apart
+std::vector<std::size_t> split_points(std::string_view text, std::size_t pieces) {
+    std::vector<std::size_t> bounds {0};
+    const std::size_t target = text.size() / pieces;
+    for (std::size_t k = 1; k < pieces; ++k) {
+        std::size_t nl = text.find('\n', std::max(bounds.back(), k * target));
+        if (nl == std::string_view::npos || nl + 1 >= text.size()) break;
+        bounds.push_back(nl + 1);
+    }
+    bounds.push_back(text.size());
+    return bounds;
+}
+
+}
+
+TableGlyphMetrics::TableGlyphMetrics(float fallbackAdvance, float lineHeight)
+    : fallback_(fallbackAdvance), lineHeight_(lineHeight) {
+    latin1_.fill(fallbackAdvance);
+}
+
+void TableGlyphMetrics::set(char32_t c, float advance) {
+    if (c < 256) {
+        latin1_[c] = advance;
+        latin1Set_[c] = true;
+    } else {
+        other_[c] = advance;
+    }
+}
+
+bool TableGlyphMetrics::has(char32_t c) const {
+    return c < 256 ? latin1Set_[c] : other_.contains(c);
+}
+
+float TableGlyphMetrics::advance(char32_t c) const {
+    if (c < 256) return latin1_[c];
+    auto it = other_.find(c);
+    return it == other_.end() ? fallback_ : it->second;
+}
+
+float TableGlyphMetrics::measure(std::u32string_view run) const {
+    float w = 0.f;
+    for (char32_t c : run) w += c < 256 ? latin1_[c] : advance(c);
+    return w;
+}
+
+std::size_t TextLayout::lineAt(float y) const {
+    if (lines_.empty() || y < 0.f || lineHeight_ <= 0.f) return 0;
+    return std::min(static_cast<std::size_t>(y / lineHeight_), lines_.size() - 1);
+}
+
+std::size_t TextLayout::lineOf(std::size_t byteOffset) const {
+    auto it = std::upper_bound(lines_.begin(), lines_.end(), byteOffset,
+                               [](std::size_t off, const LayoutLine& l) { return off < l.byteStart; });
+    return it == lines_.begin() ? 0 : static_cast<std::size_t>(it - lines_.begin()) - 1;
+}
+
+VisibleLines TextLayout::visibleLines(float scrollY, float viewHeight) const {
+    VisibleLines view;
+    const float lh = std::max(1.f, lineHeight_);
+    view.first = std::min(lines_.size(), static_cast<std::size_t>(std::max(0.f, scrollY) / lh));
+    // One extra line for each edge a line may straddle
+    view.last = std::min(lines_.size(), view.first + static_cast<std::size_t>(std::max(0.f, viewHeight) / lh) + 2);
+    auto byLine = [](const LinkBox& b, std::size_t line) { return b.line < line; };
+    view.firstBox = static_cast<std::size_t>(std::lower_bound(linkBoxes_.begin(), linkBoxes_.end(), view.first, byLine) - linkBoxes_.begin());
+    view.lastBox = static_cast<std::size_t>(std::lower_bound(linkBoxes_.begin() + static_cast<std::ptrdiff_t>(view.firstBox),
+                                                             linkBoxes_.end(), view.last, byLine) - linkBoxes_.begin());
+    return view;
+}
+
+std::size_t TextLayout::firstOffsetFrom(const std::vector<std::size_t>& offsets, std::size_t line) const {
+    auto it = std::partition_point(offsets.begin(), offsets.end(), [&](std::size_t off) { return lineOf(off) < line; });
+    return static_cast<std::size_t>(it - offsets.begin());
+}
+
+std::size_t TextLayout::runOf(std::size_t byteOffset) const {
+    if (lines_.empty()) return npos;
+    const LayoutLine& line = lines_[lineOf(byteOffset)];
+    const std::size_t rel = byteOffset - std::min(byteOffset, line.byteStart);
+    auto first = runs_.begin() + static_cast<std::ptrdiff_t>(line.firstRun);
+    auto it = std::upper_bound(first, first + static_cast<std::ptrdiff_t>(line.runCount), rel,
+                               [](std::size_t off, const LayoutRun& r) { return off < r.start; });
+    if (it != first) return static_cast<std::size_t>(it - runs_.begin()) - 1;
+    // Before the line's first word: the last run of an earlier line
+    return line.firstRun == 0 ? npos : line.firstRun - 1;
+}
+
+std::size_t TextLayout::lineOfRun(std::size_t run) const {
+    auto it = std::upper_bound(lines_.begin(), lines_.end(), run,
+                               [](std::size_t r, const LayoutLine& l) { return r < l.firstRun; });
+    return it == lines_.begin() ? 0 : static_cast<std::size_t>(it - lines_.begin()) - 1;
+}
+
+float TextLayout::xOf(std::size_t byteOffset, std::string_view text, const GlyphMetrics& metrics) const {
+    const std::size_t r = runOf(byteOffset);
+    if (r == npos) return 0.f;
+    const LayoutRun& run = runs_[r];
+    const std::size_t start = runStart(lineOfRun(r), r);
+    if (byteOffset >= start + run.length) return run.x + run.width;
+    return run.x + measure_utf8(text.substr(start, byteOffset - start), metrics);
+}
+
+std::size_t TextLayout::linkAt(float x, float y) const {
+    if (y < 0.f || lineHeight_ <= 0.f) return npos;
+    const std::size_t line = static_cast<std::size_t>(y / lineHeight_);
+    auto first = std::lower_bound(linkBoxes_.begin(), linkBoxes_.end(), line,
+                                  [](const LinkBox& box, std::size_t l) { return box.line < l; });
+    for (auto it = first; it != linkBoxes_.end() && it->line == line; ++it) {
+        if (x >= it->x && x <= it->x + it->width) return it->link;
+    }
+    return npos;
+}
+
+TextLayout layout_text(std::string_view text, const std::vector<Link>& links, const GlyphMetrics& metrics,
+                       const LayoutOptions& options) {
+    TRACE_SCOPE("layout", "layout_text");
+    AllocPhaseScope phase(AllocPhase::Layout);
+    TextLayout layout;
+    layout.width_ = options.width;
+    layout.lineHeight_ = metrics.lineHeight();
+    if (text.empty()) return layout;
+
+    std::size_t threads = options.threads;
+    if (threads == 0) threads = Executor::shared().size();
+    const std::size_t minChunk = std::max<std::size_t>(options.min_chunk_size, 1);
+    if (threads > 1 && text.size() >= 2 * minChunk) {
+        auto work = std::make_shared<PieceWork>();
+        work->text = text;
+        work->metrics = &metrics;
+        work->width = options.width;
+        work->bounds = split_points(text, std::min(threads * 2, text.size() / minChunk));
+        work->pieces.resize(work->bounds.size() - 1);
+        const std::size_t count = work->pieces.size();
+        for (std::size_t h = 1; h < std::min(threads, count); ++h) {
+            Executor::shared().post([work] { work->help(); }, TaskPriority::Interactive);
+        }
+        // The caller lays out pieces too, so when every worker is busy (say, parsing the next
+        // page) it waits only for pieces a worker already started, never for the queue
+        work->help();
+        for (std::size_t d; (d = work->done.load(std::memory_order_acquire)) < count;) {
+            work->done.wait(d, std::memory_order_acquire);
+        }
+
+        // Stitch in order; offsets are already absolute, run indices shift by what came before
+        TRACE_SCOPE("layout", "stitch_pieces");
+        for (Piece& piece : work->pieces) {
+            const std::size_t runBase = layout.runs_.size();
+            layout.runs_.insert(layout.runs_.end(), piece.runs.begin(), piece.runs.end());
+            for (LayoutLine& line : piece.lines) {
+                line.firstRun += runBase;
+                layout.lines_.push_back(line);
+            }
+        }
+    } else {
+        Piece piece = layout_piece(text, 0, text.size(), metrics, options.width);
+        layout.runs_ = std::move(piece.runs);
+        layout.lines_ = std::move(piece.lines);
+    }
+
+    // One box per line a link touches
+    TRACE_SCOPE("layout", "place_links");
+    const auto& runs = layout.runs_;
+    const auto& lines = layout.lines_;
+    for (std::size_t i = 0; i < links.size(); ++i) {
+        const Link& link = links[i];
+        if (link.end_pos <= link.start_pos) continue;
+        std::size_t r = layout.runOf(link.start_pos);
+        std::size_t line = r == TextLayout::npos ? 0 : layout.lineOfRun(r);
+        if (r == TextLayout::npos || link.start_pos >= layout.runStart(line, r) + runs[r].length) ++r;   // starts in whitespace
+        if (r >= runs.size()) continue;
+        while (line + 1 < lines.size() && r >= lines[line + 1].firstRun) ++line;
+        if (layout.runStart(line, r) >= link.end_pos) continue;
+
+        float x0 = link.start_pos > layout.runStart(line, r) ? layout.xOf(link.start_pos, text, metrics) : runs[r].x;
+        float x1 = x0;
+        for (; r < runs.size(); ++r) {
+            std::size_t runLine = line;
+            while (runLine + 1 < lines.size() && r >= lines[runLine + 1].firstRun) ++runLine;
+            const std::size_t start = layout.runStart(runLine, r);
+            if (start >= link.end_pos) break;
+            for (; line < runLine; ++line) {
+                if (lines[line].runCount > 0) layout.linkBoxes_.push_back(LinkBox{i, line, x0, x1 - x0});
+                x0 = x1 = runs[r].x;
+            }
+            x1 = link.end_pos < start + runs[r].length ? layout.xOf(link.end_pos, text, metrics) : runs[r].x + runs[r].width;
+        }
+        layout.linkBoxes_.push_back(LinkBox{i, line, x0, x1 - x0});
+    }
+    std::stable_sort(layout.linkBoxes_.begin(), layout.linkBoxes_.end(),
+                     [](const LinkBox& a, const LinkBox& b) { return a.line < b.line; });
+    return layout;
+}
@@ -0,0 +1,248 @@
+#include "core/text_search.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+struct FoldTable {
+    std::array<unsigned char, 256> lower {};
+    constexpr FoldTable() {
+        for (int c = 0; c < 256; ++c) {
+            lower[c] = static_cast<unsigned char>(c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c);
+        }
+    }
+};
+
+constexpr FoldTable kFold;
+
+inline unsigned char fold(char c) {
+    return kFold.lower[static_cast<unsigned char>(c)];
+}
+
+// Scan granularity between cancellation checks
+constexpr std::size_t kCancelStride = 1 << 20;
+
+// Needles shorter than this barely skip under Horspool; scan for their first byte instead
+constexpr std::size_t kShortNeedle = 4;
+
+constexpr std::uint64_t kOnes = 0x0101010101010101ULL;
+constexpr std::uint64_t kHighs = 0x8080808080808080ULL;
+
+// SWAR: high bit set in each byte of x equal to the byte broadcast in pattern
+// (bits above a real hit may be spurious; callers verify every candidate)
+inline std::uint64_t byte_hits(std::uint64_t x, std::uint64_t pattern) {
+    std::uint64_t v = x ^ pattern;
+    return (v - kOnes) & ~v & kHighs;
+}
+
+}
+
+CaseInsensitiveSearcher::CaseInsensitiveSearcher(std::string_view needle) {
+    needle_.reserve(needle.size());
+    for (char c : needle) needle_.push_back(static_cast<char>(fold(c)));
+
+    const std::size_t m = needle_.size();
+    skip_.fill(static_cast<std::uint32_t>(std::max<std::size_t>(m, 1)));
+    // Index by raw haystack bytes so the hot loop never folds: fill both cases
+    for (std::size_t i = 0; i + 1 < m; ++i) {
+        unsigned char c = static_cast<unsigned char>(needle_[i]);
+        auto shift = static_cast<std::uint32_t>(m - 1 - i);
+        skip_[c] = shift;
+        if (c >= 'a' && c <= 'z') skip_[c - ('a' - 'A')] = shift;
+    }
+}
+
+bool CaseInsensitiveSearcher::matchesAt(std::string_view haystack, std::size_t pos) const {
+    const std::size_t m = needle_.size();
+    if (m == 0 || pos > haystack.size() || haystack.size() - pos < m) return false;
+    const char* h = haystack.data() + pos;
+    for (std::size_t k = 0; k < m; ++k) {
+        if (fold(h[k]) != static_cast<unsigned char>(needle_[k])) return false;
+    }
+    return true;
+}
+
+std::size_t CaseInsensitiveSearcher::find(std::string_view haystack, std::size_t from) const {
+    const std::size_t m = needle_.size();
+    const std::size_t n = haystack.size();
+    if (m == 0 || n < m || from > n - m) return std::string_view::npos;
+
+    const char* h = haystack.data();
+    if (m < kShortNeedle) return findShort(haystack, from);
+
+    const unsigned char last = static_cast<unsigned char>(needle_[m - 1]);
+    std::size_t i = from;
+    while (i <= n - m) {
+        unsigned char c = static_cast<unsigned char>(h[i + m - 1]);
+        if (kFold.lower[c] == last && matchesAt(haystack, i)) return i;
+        i += skip_[c];
+    }
+    return std::string_view::npos;
+}
+
+std::size_t CaseInsensitiveSearcher::findShort(std::string_view haystack, std::size_t from) const {
+    const std::size_t m = needle_.size();
+    const std::size_t last = haystack.size() - m; // last valid start
+    const char* h = haystack.data();
+    unsigned char lo = static_cast<unsigned char>(needle_[0]);
+    unsigned char up = (lo >= 'a' && lo <= 'z') ? static_cast<unsigned char>(lo - ('a' - 'A')) : lo;
+    const std::uint64_t loPat = kOnes * lo;
+    const std::uint64_t upPat = kOnes * up;
+
+    std::size_t i = from;
+    // Eight candidate start positions per step
+    while (i + 8 <= last + 1) {
+        std::uint64_t word;
+        std::memcpy(&word, h + i, sizeof(word));
+        std::uint64_t hits = byte_hits(word, loPat) | byte_hits(word, upPat);
+        while (hits) {
+            std::size_t pos = i + (static_cast<std::size_t>(__builtin_ctzll(hits)) >> 3);
+            if (matchesAt(haystack, pos)) return pos;
+            hits &= hits - 1;
+        }
+        i += 8;
+    }
+    for (; i <= last; ++i) {
+        if (matchesAt(haystack, i)) return i;
+    }
+    return std::string_view::npos;
+}
+
+namespace {
+
+// Calls onMatch(pos) for every match, in order. The text is searched one
+// kCancelStride window of start positions at a time and stop() is polled
+// between windows, so a needle that never matches is still cancellable.
+template <class Stop, class OnMatch>
+void scan_cancellable(const CaseInsensitiveSearcher& searcher, std::string_view text, Stop&& stop, OnMatch&& onMatch) {
+    const std::size_t m = searcher.size();
+    if (m == 0) return;
+    for (std::size_t start = 0; start + m <= text.size(); start += kCancelStride) {
+        if (start > 0 && stop()) return;
+        // Long enough for a match starting at the window's last position
+        const std::string_view window = text.substr(start, kCancelStride + m - 1);
+        for (std::size_t pos = 0; (pos = searcher.find(window, pos)) != std::string_view::npos; ++pos) {
+            onMatch(start + pos);
+        }
+    }
+}
+
+}
+
+std::vector<std::size_t> find_all_ci(std::string_view haystack, std::string_view needle,
+                                     const std::atomic<bool>* cancel) {
+    std::vector<std::size_t> matches;
+    CaseInsensitiveSearcher searcher(needle);
+    scan_cancellable(searcher, haystack, [&] { return cancel && cancel->load(std::memory_order_relaxed); },
+                     [&](std::size_t pos) { matches.push_back(pos); });
+    return matches;
+}
+
+TextFinder::~TextFinder() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        latest_.store(++generation_);
+    }
+    cv_.notify_all();
+    if (worker_.joinable()) worker_.join();
+}
+
+void TextFinder::setText(std::shared_ptr<const std::string> text) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    text_ = std::move(text);
+    latest_.store(++generation_);
+    hasJob_ = false;
+    last_.reset();
+    fresh_ = false;
+}
+
+void TextFinder::cancel() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    latest_.store(++generation_);
+    hasJob_ = false;
+    fresh_ = false; // an undelivered older result is stale now
+}
+
+void TextFinder::search(const std::string& query) {
+    Job job;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        latest_.store(++generation_);
+        hasJob_ = false;
+        fresh_ = false;
+        if (query.empty() || !text_) {
+            auto empty = std::make_shared<FindResult>();
+            empty->query = query;
+            last_ = std::move(empty);
+            fresh_ = true;
+            return;
+        }
+        job.generation = generation_;
+        job.text = text_;
+        job.query = query;
+        job.previous = last_;
+        if (text_->size() >= kBackgroundThreshold) {
+            job_ = std::move(job);
+            hasJob_ = true;
+            if (!worker_.joinable()) worker_ = std::thread([this]{ workerLoop(); });
+            cv_.notify_one();
+            return;
+        }
+    }
+    publish(job.generation, run(job));
+}
+
+bool TextFinder::poll(FindResult& out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!fresh_ || !last_) return false;
+    out = *last_;
+    fresh_ = false;
+    return true;
+}
+
+void TextFinder::workerLoop() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]{ return stopping_ || hasJob_; });
+            if (stopping_) return;
+            job = std::move(job_);
+            hasJob_ = false;
+        }
+        FindResult result = run(job);
+        if (!superseded(job.generation)) publish(job.generation, std::move(result));
+    }
+}
+
+void TextFinder::publish(std::uint64_t generation, FindResult result) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (generation != generation_) return;
+    last_ = std::make_shared<const FindResult>(std::move(result));
+    fresh_ = true;
+}
+
+FindResult TextFinder::run(const Job& job) const {
+    FindResult result;
+    result.query = job.query;
+    result.length = job.query.size();
+    std::string_view text(*job.text);
+    CaseInsensitiveSearcher searcher(job.query);
+
+    // Typing one more character only narrows the previous match set
+    const FindResult* prev = job.previous.get();
+    if (prev && !prev->query.empty() && prev->query.size() <= job.query.size() &&
+        CaseInsensitiveSearcher(prev->query).matchesAt(job.query, 0)) {
+        for (std::size_t i = 0; i < prev->matches.size(); ++i) {
+            if (i % 65536 == 0 && superseded(job.generation)) break;
+            if (searcher.matchesAt(text, prev->matches[i])) result.matches.push_back(prev->matches[i]);
+        }
+        return result;
+    }
+
+    scan_cancellable(searcher, text, [&] { return superseded(job.generation); },
+                     [&](std::size_t pos) { result.matches.push_back(pos); });
+    return result;
+}
@@ -0,0 +1,148 @@
+#include "core/trace.h"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+// A thread stops recording after this many spans (~24 MB) rather than grow without bound
+constexpr std::size_t kMaxEventsPerThread = 1 << 20;
+
+struct Event {
+    const char* category;
+    const char* name;
+    std::uint64_t startNs;
+    std::uint64_t durationNs;
+};
+
+// Written by its thread only; the mutex is uncontended except while exporting
+struct ThreadBuffer {
+    std::mutex mutex;
+    std::vector<Event> events;
+    const char* threadName = nullptr;
+    std::uint32_t tid = 0;
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;   ///< Outlive their threads until exported
+};
+
+Registry& registry() {
+    static Registry r;
+    return r;
+}
+
+thread_local const char* t_threadName = nullptr;
+thread_local std::shared_ptr<ThreadBuffer> t_buffer;   ///< Created by the thread's first span
+
+ThreadBuffer& this_thread_buffer() {
+    if (!t_buffer) {
+        auto b = std::make_shared<ThreadBuffer>();
+        b->threadName = t_threadName;
+        Registry& r = registry();
+        std::lock_guard lock(r.mutex);
+        b->tid = static_cast<std::uint32_t>(r.buffers.size() + 1);
+        r.buffers.push_back(b);
+        t_buffer = std::move(b);
+    }
+    return *t_buffer;
+}
+
+void write_json_string(std::FILE* out, const char* s) {
+    std::fputc('"', out);
+    for (; *s; ++s) {
+        unsigned char c = static_cast<unsigned char>(*s);
+        if (c == '"' || c == '\\') std::fputc('\\', out);
+        if (c < 0x20) std::fprintf(out, "\\u%04x", c);
+        else std::fputc(c, out);
+    }
+    std::fputc('"', out);
+}
+
+}
+
+std::uint64_t trace_detail::now_ns() {
+    // Function-local so spans recorded during static initialization see it
+    static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+}
+
+void trace_detail::record(const char* category, const char* name, std::uint64_t startNs, std::uint64_t endNs) {
+    ThreadBuffer& b = this_thread_buffer();
+    std::lock_guard lock(b.mutex);
+    if (b.events.size() < kMaxEventsPerThread) b.events.push_back(Event{category, name, startNs, endNs - startNs});
+}
+
+void trace_start() {
+    trace_detail::enabled.store(true, std::memory_order_relaxed);
+}
+
+void trace_stop() {
+    trace_detail::enabled.store(false, std::memory_order_relaxed);
+}
+
+void trace_clear() {
+    Registry& r = registry();
+    std::lock_guard lock(r.mutex);
+    for (auto& b : r.buffers) {
+        std::lock_guard bufferLock(b->mutex);
+        b->events.clear();
+    }
+}
+
+std::size_t trace_event_count() {
+    Registry& r = registry();
+    std::lock_guard lock(r.mutex);
+    std::size_t n = 0;
+    for (auto& b : r.buffers) {
+        std::lock_guard bufferLock(b->mutex);
+        n += b->events.size();
+    }
+    return n;
+}
+
+void trace_set_thread_name(const char* name) {
+    t_threadName = name;
+    if (!t_buffer) return;   // threads that never record cost nothing
+    std::lock_guard lock(t_buffer->mutex);
+    t_buffer->threadName = name;
+}
+
+bool trace_write(const std::string& path) {
+    std::FILE* out = std::fopen(path.c_str(), "w");
+    if (!out) return false;
+
+    std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", out);
+    bool first = true;
+    auto separator = [&] {
+        if (!first) std::fputs(",\n", out);
+        first = false;
+    };
+    Registry& r = registry();
+    std::lock_guard lock(r.mutex);
+    for (auto& b : r.buffers) {
+        std::lock_guard bufferLock(b->mutex);
+        if (b->threadName) {
+            separator();
+            std::fprintf(out, "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", b->tid);
+            write_json_string(out, b->threadName);
+            std::fputs("}}", out);
+        }
+        for (const Event& e : b->events) {
+            separator();
+            std::fputs("{\"ph\":\"X\",\"cat\":", out);
+            write_json_string(out, e.category);
+            std::fputs(",\"name\":", out);
+            write_json_string(out, e.name);
+            std::fprintf(out, ",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", b->tid,
+                         static_cast<double>(e.startNs) / 1000.0, static_cast<double>(e.durationNs) / 1000.0);
+        }
+    }
+    std::fputs("]}\n", out);
+    return std::fclose(out) == 0;
+}
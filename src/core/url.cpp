@@ -0,0 +1,430 @@
+#include "core/url.h"
+#include "core/alloc_tracker.h"
+#include "core/html_parser.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <mutex>
+#include <unordered_set>
+
+namespace {
+// Generic URI reference split (RFC 3986 appendix B); components are views into the input
+struct Reference {
+    std::string_view scheme, authority, path, query, fragment;
+    bool hasScheme = false;
+    bool hasAuthority = false;
+    bool hasQuery = false;
+    bool hasFragment = false;
+};
+
+bool is_alpha(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+bool is_scheme_char(char c) {
+    return is_alpha(c) || (c >= '0' && c <= '9') || c == '+' || c == '-' || c == '.';
+}
+
+char to_lower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+bool equals_ci(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (to_lower(a[i]) != b[i]) return false;
+    }
+    return true;
+}
+
+// Hrefs are often written with stray whitespace around them
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && static_cast<unsigned char>(s.front()) <= ' ') s.remove_prefix(1);
+    while (!s.empty() && static_cast<unsigned char>(s.back()) <= ' ') s.remove_suffix(1);
+    return s;
+}
+
+Reference split_reference(std::string_view s) {
+    Reference r;
+    std::size_t i = 0;
+    const std::size_t n = s.size();
+
+    if (n > 0 && is_alpha(s[0])) {
+        std::size_t j = 1;
+        while (j < n && is_scheme_char(s[j])) ++j;
+        if (j < n && s[j] == ':') {
+            r.scheme = s.substr(0, j);
+            r.hasScheme = true;
+            i = j + 1;
+        }
+    }
+    if (n - i >= 2 && s[i] == '/' && s[i + 1] == '/') {
+        i += 2;
+        std::size_t end = s.find_first_of("/?#", i);
+        if (end == std::string_view::npos) end = n;
+        r.authority = s.substr(i, end - i);
+        r.hasAuthority = true;
+        i = end;
+    }
+    std::size_t end = s.find_first_of("?#", i);
+    if (end == std::string_view::npos) end = n;
+    r.path = s.substr(i, end - i);
+    i = end;
+    if (i < n && s[i] == '?') {
+        end = s.find('#', i + 1);
+        if (end == std::string_view::npos) end = n;
+        r.query = s.substr(i + 1, end - i - 1);
+        r.hasQuery = true;
+        i = end;
+    }
+    if (i < n && s[i] == '#') {
+        r.fragment = s.substr(i + 1);
+        r.hasFragment = true;
+    }
+    return r;
+}
+
+// Percent-encode a filesystem path for a file: URL; '/' and characters legal in a path segment stay
+void append_path_encoded(std::string& out, std::string_view path) {
+    static constexpr char kHex[] = "0123456789ABCDEF";
+    for (char ch : path) {
+        const auto c = static_cast<unsigned char>(ch);
+        if (is_alpha(ch) || (c >= '0' && c <= '9') || std::string_view("-._~!$&'()*+,;=:@/").find(ch) != std::string_view::npos) {
+            out.push_back(ch);
+        } else {
+            out.push_back('%');
+            out.push_back(kHex[c >> 4]);
+            out.push_back(kHex[c & 0xF]);
+        }
+    }
+}
+
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    c = to_lower(c);
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// Malformed escapes are kept as written
+std::string percent_decode(std::string_view s) {
+    std::string out;
+    out.reserve(s.size());
+    for (std::size_t i = 0; i < s.size(); ++i) {
+        int hi = 0, lo = 0;
+        if (s[i] == '%' && i + 2 < s.size() && (hi = hex_value(s[i + 1])) >= 0 && (lo = hex_value(s[i + 2])) >= 0) {
+            out.push_back(static_cast<char>(hi * 16 + lo));
+            i += 2;
+        } else {
+            out.push_back(s[i]);
+        }
+    }
+    return out;
+}
+
+// Address-bar text that names a local file: "/abs", "~/in/home", "./rel" or "../rel"
+std::optional<std::string> local_path_input(std::string_view text) {
+    if (text.starts_with("~/")) {
+        const char* home = std::getenv("HOME");
+        if (!home) return std::nullopt;
+        return std::string(home) + std::string(text.substr(1));
+    }
+    if (text.starts_with("./") || text.starts_with("../")) {
+        std::error_code ec;
+        std::filesystem::path cwd = std::filesystem::current_path(ec);
+        if (ec) return std::nullopt;
+        return cwd.string() + "/" + std::string(text);
+    }
+    if (text.starts_with("/") && !text.starts_with("//")) return std::string(text);
+    return std::nullopt;
+}
+
+int default_port(std::string_view scheme) {
+    if (scheme == "http" || scheme == "ws") return 80;
+    if (scheme == "https" || scheme == "wss") return 443;
+    if (scheme == "ftp") return 21;
+    return -1;
+}
+
+// Drop the last segment (and its leading '/') written after pathStart
+void pop_segment(std::string& out, std::size_t pathStart) {
+    std::size_t slash = out.rfind('/');
+    if (slash == std::string::npos || slash < pathStart) slash = pathStart;
+    out.resize(slash);
+}
+
+// RFC 3986 section 5.2.4, appending the result to out
+void append_without_dot_segments(std::string& out, std::string_view in) {
+    const std::size_t pathStart = out.size();
+    while (!in.empty()) {
+        if (in.starts_with("../")) {
+            in.remove_prefix(3);
+        } else if (in.starts_with("./")) {
+            in.remove_prefix(2);
+        } else if (in.starts_with("/./")) {
+            in.remove_prefix(2);
+        } else if (in == "/.") {
+            in = "/";
+        } else if (in.starts_with("/../")) {
+            in.remove_prefix(3);
+            pop_segment(out, pathStart);
+        } else if (in == "/..") {
+            in = "/";
+            pop_segment(out, pathStart);
+        } else if (in == "." || in == "..") {
+            in = {};
+        } else {
+            std::size_t next = in.find('/', in[0] == '/' ? 1 : 0);
+            if (next == std::string_view::npos) next = in.size();
+            out.append(in.substr(0, next));
+            in.remove_prefix(next);
+        }
+    }
+}
+
+struct TransparentHash {
+    using is_transparent = void;
+    std::size_t operator()(std::string_view s) const noexcept { return std::hash<std::string_view>{}(s); }
+};
+
+struct TransparentEqual {
+    using is_transparent = void;
+    bool operator()(std::string_view a, std::string_view b) const noexcept { return a == b; }
+};
+}
+
+Origin Origin::intern(std::string_view key) {
+    // Node-based set: element addresses stay valid for the life of the process
+    static std::mutex mutex;
+    static std::unordered_set<std::string, TransparentHash, TransparentEqual> table;
+
+    std::lock_guard lock(mutex);
+    auto it = table.find(key);
+    if (it == table.end()) it = table.emplace(key).first;
+    return Origin(&*it);
+}
+
+/**
+ * @class UrlBuilder
+ * @brief Assembles the normalized href and component spans of a Url
+ */
+class UrlBuilder {
+public:
+    /**
+     * @brief Build a Url from raw components
+     *
+     * @param pathIsNormal path already came from a normalized Url (skip dot removal)
+     * @param hint URL whose interned origin is reused when it matches
+     */
+    static std::optional<Url> build(std::string_view scheme, const Reference& parts, std::string_view path,
+                                    bool pathIsNormal, const Url* hint) {
+        Url u;
+        std::string& href = u.href_;
+        href.reserve(scheme.size() + parts.authority.size() + path.size() + parts.query.size()
+                     + parts.fragment.size() + 8);
+
+        for (char c : scheme) href += to_lower(c);
+        u.scheme_ = span(0, href.size());
+        href += ':';
+
+        int explicitPort = -1;
+        if (parts.hasAuthority) {
+            u.hasAuthority_ = true;
+            href += "//";
+            std::string_view authority = parts.authority;
+            std::size_t at = authority.rfind('@');
+            if (at != std::string_view::npos) {
+                std::size_t start = href.size();
+                href.append(authority.substr(0, at));
+                u.userinfo_ = span(start, href.size());
+                href += '@';
+                authority.remove_prefix(at + 1);
+            }
+
+            std::string_view host = authority;
+            std::string_view port;
+            std::size_t colon = std::string_view::npos;
+            if (!authority.empty() && authority[0] == '[') {
+                std::size_t close = authority.find(']');
+                if (close == std::string_view::npos) return std::nullopt;
+                if (close + 1 < authority.size()) {
+                    if (authority[close + 1] != ':') return std::nullopt;
+                    colon = close + 1;
+                }
+            } else {
+                colon = authority.rfind(':');
+            }
+            if (colon != std::string_view::npos) {
+                host = authority.substr(0, colon);
+                port = authority.substr(colon + 1);
+            }
+
+            std::size_t start = href.size();
+            for (char c : host) href += to_lower(c);
+            u.host_ = span(start, href.size());
+
+            if (!port.empty()) {
+                if (port.size() > 5) return std::nullopt;
+                int value = 0;
+                for (char c : port) {
+                    if (c < '0' || c > '9') return std::nullopt;
+                    value = value * 10 + (c - '0');
+                }
+                if (value > 65535) return std::nullopt;
+                explicitPort = value;
+            }
+        }
+
+        const int defaultPort = default_port(u.scheme());
+        u.port_ = explicitPort >= 0 ? explicitPort : defaultPort;
+        if (explicitPort >= 0 && explicitPort != defaultPort) {
+            href += ':';
+            href.append(port_digits(explicitPort));
+        }
+        const std::size_t authorityEnd = href.size();
+
+        std::size_t start = href.size();
+        if (path.empty() && u.hasAuthority_ && defaultPort >= 0) {
+            href += '/';
+        } else if (pathIsNormal) {
+            href.append(path);
+        } else {
+            append_without_dot_segments(href, path);
+        }
+        u.path_ = span(start, href.size());
+
+        if (parts.hasQuery) {
+            href += '?';
+            start = href.size();
+            href.append(parts.query);
+            u.query_ = span(start, href.size());
+            u.hasQuery_ = true;
+        }
+        if (parts.hasFragment) {
+            href += '#';
+            start = href.size();
+            href.append(parts.fragment);
+            u.fragment_ = span(start, href.size());
+            u.hasFragment_ = true;
+        }
+
+        if (u.hasAuthority_ && u.host_.len > 0) {
+            std::string key;
+            std::string_view origin;
+            if (u.userinfo_.len == 0) {
+                origin = std::string_view(href).substr(0, authorityEnd);
+            } else {
+                key.append(u.scheme()).append("://").append(u.host());
+                if (explicitPort >= 0 && explicitPort != defaultPort) key.append(":").append(port_digits(explicitPort));
+                origin = key;
+            }
+            u.origin_ = (hint && hint->origin_.str() == origin) ? hint->origin_ : Origin::intern(origin);
+        }
+        return u;
+    }
+
+    static std::optional<Url> resolve(const Url& base, std::string_view reference, std::string& scratch) {
+        Reference r = split_reference(trim(reference));
+
+        if (r.hasScheme) return build(r.scheme, r, r.path, false, &base);
+
+        if (r.hasAuthority) return build(base.scheme(), r, r.path, false, &base);
+
+        // Same authority as the base; reuse its already-normalized text
+        Reference parts = r;
+        parts.hasAuthority = base.hasAuthority_;
+        if (base.hasAuthority_) {
+            std::size_t from = base.scheme_.len + 3;
+            std::size_t to = base.path_.pos;
+            parts.authority = std::string_view(base.href_).substr(from, to - from);
+        }
+
+        if (r.path.empty()) {
+            if (!r.hasQuery) {
+                parts.hasQuery = base.hasQuery_;
+                parts.query = base.query();
+            }
+            return build(base.scheme(), parts, base.path(), true, &base);
+        }
+        if (r.path[0] == '/') return build(base.scheme(), parts, r.path, false, &base);
+
+        // Merge (section 5.2.3): base path up to its last '/', then the reference
+        scratch.clear();
+        std::string_view basePath = base.path();
+        if (base.hasAuthority_ && basePath.empty()) {
+            scratch += '/';
+        } else {
+            std::size_t slash = basePath.rfind('/');
+            if (slash != std::string_view::npos) scratch.append(basePath.substr(0, slash + 1));
+        }
+        scratch.append(r.path);
+        return build(base.scheme(), parts, scratch, false, &base);
+    }
+
+    static void resolveAll(std::vector<Link>& links, const Url& base) {
+        std::string scratch;
+        for (auto& link : links) {
+            auto resolved = resolve(base, link.url, scratch);
+            if (resolved) link.url = std::move(resolved->href_);
+        }
+    }
+
+private:
+    static Url::Span span(std::size_t begin, std::size_t end) {
+        return Url::Span{static_cast<std::uint32_t>(begin), static_cast<std::uint32_t>(end - begin)};
+    }
+
+    static std::string port_digits(int port) {
+        return std::to_string(port);
+    }
+};
+
+std::optional<Url> Url::parse(std::string_view text) {
+    Reference r = split_reference(trim(text));
+    if (!r.hasScheme) return std::nullopt;
+    return UrlBuilder::build(r.scheme, r, r.path, false, nullptr);
+}
+
+std::optional<Url> Url::fromUserInput(std::string_view text) {
+    text = trim(text);
+    if (text.empty()) return std::nullopt;
+    if (auto path = local_path_input(text)) return fromFilePath(*path);
+
+    Reference r = split_reference(text);
+    // "localhost:8080" splits as scheme "localhost"; only trust schemes that look intended
+    if (r.hasScheme && (r.hasAuthority || equals_ci(r.scheme, "about") || equals_ci(r.scheme, "data")
+                        || equals_ci(r.scheme, "file")
+                        || equals_ci(r.scheme, "mailto"))) {
+        return UrlBuilder::build(r.scheme, r, r.path, false, nullptr);
+    }
+    std::string withScheme = "https://";
+    withScheme.append(text);
+    return parse(withScheme);
+}
+
+std::optional<Url> Url::fromFilePath(std::string_view path) {
+    if (!path.starts_with("/")) return std::nullopt;
+    std::string href = "file://";
+    append_path_encoded(href, path);
+    return parse(href);
+}
+
+std::optional<std::string> Url::filePath() const {
+    if (scheme() != "file" || !(host().empty() || host() == "localhost")) return std::nullopt;
+    return percent_decode(path());
+}
+
+std::optional<Url> Url::resolve(std::string_view reference) const {
+    std::string scratch;
+    return UrlBuilder::resolve(*this, reference, scratch);
+}
+
+bool link_may_open(const std::optional<Url>& page, const Url& target) {
+    if (target.scheme() == "http" || target.scheme() == "https") return true;
+    return target.scheme() == "file" && page && page->scheme() == "file";
+}
+
+void resolve_links(std::vector<Link>& links, const Url& base) {
+    AllocPhaseScope phase(AllocPhase::Links);
+    UrlBuilder::resolveAll(links, base);
+}
@@ -0,0 +1,73 @@
+#include "core/crawler.h"
+#include "core/http_archive.h"
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+namespace {
+void usage() {
+    std::cerr << "usage: crawl [options] <seed-url>...\n"
+                 "  --allow <origin>     also follow links to this origin (repeatable; default: the seeds' origins)\n"
+                 "  --depth <n>          link hops from a seed (default 10)\n"
+                 "  --pages <n>          stop after this many fetches (default 1000)\n"
+                 "  --concurrency <n>    fetches in flight (default 8)\n"
+                 "  --per-host <n>       fetches in flight per origin (default 2)\n"
+                 "  --delay <ms>         minimum time between requests to one origin (default 0)\n"
+                 "  --out <dir>          write extracted text and index.tsv here\n"
+                 "  --record <file>      save every HTTP exchange to an archive\n"
+                 "  --replay <file>      fetch from an archive instead of the network\n"
+                 "  --replay-scale <x>   multiply recorded response times (default 1, 0: no delay)\n";
+}
+}
+
+int main(int argc, char** argv) {
+    CrawlOptions options;
+    std::string recordPath, replayPath;
+    double replayScale = 1.0;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--allow" && hasValue) options.allowedOrigins.push_back(argv[++i]);
+        else if (arg == "--depth" && hasValue) options.maxDepth = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--pages" && hasValue) options.maxPages = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--concurrency" && hasValue) options.concurrency = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--per-host" && hasValue) options.maxPerHost = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--delay" && hasValue) options.hostDelay = std::chrono::milliseconds(std::strtol(argv[++i], nullptr, 10));
+        else if (arg == "--out" && hasValue) options.outputDir = argv[++i];
+        else if (arg == "--record" && hasValue) recordPath = argv[++i];
+        else if (arg == "--replay" && hasValue) replayPath = argv[++i];
+        else if (arg == "--replay-scale" && hasValue) replayScale = std::strtod(argv[++i], nullptr);
+        else if (arg.starts_with("--")) { usage(); return 2; }
+        else options.seeds.emplace_back(arg);
+    }
+    if (options.seeds.empty()) { usage(); return 2; }
+    if (!replayPath.empty()) {
+        if (!http_replay_start(replayPath, replayScale)) {
+            std::cerr << "crawl: cannot load archive " << replayPath << "\n";
+            return 1;
+        }
+    } else if (!recordPath.empty()) {
+        http_record_start();
+    }
+
+    CrawlStats stats = crawl(options, [](const std::string& url, std::size_t depth, const ParsedPage& page) {
+        std::cout << depth << "  " << url << "  (" << page.text.size() << " bytes of text)\n";
+    });
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "\nFetched " << stats.pagesFetched << " pages (" << stats.pagesFailed << " failed, "
+              << stats.bytesFetched / 1024 << " KB) in " << stats.elapsed.count() / 1000.0 << " s: "
+              << stats.pagesPerSecond() << " pages/s\n"
+              << "Links: " << stats.linksSeen << " seen, " << stats.duplicateLinks << " duplicate, "
+              << stats.offOriginLinks << " out of scope\n"
+              << "Frontier peak: " << stats.frontierPeak << " URLs, " << stats.frontierPeakBytes / 1024.0 << " KB\n"
+              << "Visited set: " << stats.visitedCount << " URLs, " << stats.visitedBytes / 1024.0 << " KB\n";
+    if (replayPath.empty() && !recordPath.empty() && !http_record_stop(recordPath)) {
+        std::cerr << "crawl: cannot write archive " << recordPath << "\n";
+        return 1;
+    }
+    return 0;
+}
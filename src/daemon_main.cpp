@@ -0,0 +1,56 @@
+#include "core/page_daemon.h"
+
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+namespace {
+void usage() {
+    std::cerr << "usage: paged [options]\n"
+                 "  --socket <path>      listen here (default " << default_daemon_socket() << ")\n"
+                 "  --workers <n>        concurrent upstream fetches (default 8)\n"
+                 "  --cache-mb <n>       parsed pages kept in memory (default 256)\n"
+                 "  --ttl <s>            seconds a cached page is served (default 60)\n"
+                 "  --shm-kb <n>         pages at least this large go through shared memory (default 64)\n";
+}
+}
+
+int main(int argc, char** argv) {
+    PageDaemonOptions options;
+    std::string socketPath = default_daemon_socket();
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--socket" && hasValue) socketPath = argv[++i];
+        else if (arg == "--workers" && hasValue) options.workers = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--cache-mb" && hasValue) options.maxCacheBytes = std::strtoull(argv[++i], nullptr, 10) << 20;
+        else if (arg == "--ttl" && hasValue) options.ttl = std::chrono::seconds(std::strtol(argv[++i], nullptr, 10));
+        else if (arg == "--shm-kb" && hasValue) options.sharedMemoryThreshold = std::strtoull(argv[++i], nullptr, 10) << 10;
+        else { usage(); return 2; }
+    }
+
+    // Handle SIGINT/SIGTERM on this thread only; every thread started below inherits the mask
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    PageDaemon daemon(options);
+    if (!daemon.start(socketPath)) {
+        std::cerr << "paged: cannot listen on " << socketPath << "\n";
+        return 1;
+    }
+    std::cout << "paged: listening on " << socketPath << std::endl;
+    int signal = 0;
+    sigwait(&signals, &signal);
+    daemon.stop();
+
+    PageDaemonStats stats = daemon.stats();
+    std::cout << "\npaged: " << stats.requests << " requests from " << stats.clients << " clients, "
+              << stats.hits << " cache hits, " << stats.coalesced << " coalesced, "
+              << stats.fetches << " upstream fetches\n";
+    return 0;
+}
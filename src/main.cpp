@@ -1,7 +1,59 @@
 #include "browser/browser.h"
+#include "core/http_archive.h"
+#include "core/http_client.h"
+#include "core/trace.h"
 
-int main () {
-    Browser browser;
-    browser.run();
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+int main (int argc, char** argv) {
+    // --trace <file> (or MINI_BROWSER_TRACE=<file>) records a Chrome trace written at exit
+    // --record <file> saves every HTTP exchange; --replay <file> serves them back without a network
+    std::string tracePath, recordPath, replayPath;
+    double replayScale = 1.0;
+    // --spool-mb <n> (or MINI_BROWSER_SPOOL_MB): larger response bodies go to a mapped temp file; 0 keeps all in memory
+    long spoolMb = 8;
+    if (const char* env = std::getenv("MINI_BROWSER_SPOOL_MB")) spoolMb = std::strtol(env, nullptr, 10);
+    if (const char* env = std::getenv("MINI_BROWSER_TRACE")) tracePath = env;
+    if (const char* env = std::getenv("MINI_BROWSER_RECORD")) recordPath = env;
+    if (const char* env = std::getenv("MINI_BROWSER_REPLAY")) replayPath = env;
+    if (const char* env = std::getenv("MINI_BROWSER_REPLAY_SCALE")) replayScale = std::strtod(env, nullptr);
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--trace" && i + 1 < argc) tracePath = argv[++i];
+        else if (arg.starts_with("--trace=")) tracePath = arg.substr(8);
+        else if (arg == "--record" && i + 1 < argc) recordPath = argv[++i];
+        else if (arg == "--replay" && i + 1 < argc) replayPath = argv[++i];
+        else if (arg == "--replay-scale" && i + 1 < argc) replayScale = std::strtod(argv[++i], nullptr);
+        else if (arg == "--spool-mb" && i + 1 < argc) spoolMb = std::strtol(argv[++i], nullptr, 10);
+    }
+    if (!tracePath.empty()) trace_start();
+    if (spoolMb > 0) http_set_spool_threshold(static_cast<std::size_t>(spoolMb) * 1024 * 1024);
+    if (!replayPath.empty()) {
+        if (!http_replay_start(replayPath, replayScale)) {
+            std::cerr << "Could not load HTTP archive " << replayPath << "\n";
+            return 1;
+        }
+    } else if (!recordPath.empty()) {
+        http_record_start();
+    }
+
+    {
+        Browser browser;
+        browser.run();
+    }
+
+    if (replayPath.empty() && !recordPath.empty()) {
+        std::size_t count = http_recorded_count();
+        if (http_record_stop(recordPath)) std::cout << "Recorded " << count << " requests to " << recordPath << "\n";
+        else std::cerr << "Could not write HTTP archive to " << recordPath << "\n";
+    }
+    if (!tracePath.empty()) {
+        trace_stop();
+        if (trace_write(tracePath)) std::cout << "Trace written to " << tracePath << "\n";
+        else std::cerr << "Could not write trace to " << tracePath << "\n";
+    }
     return 0;
-}
\ No newline at end of file
+}
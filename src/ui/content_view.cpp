@@ -1,102 +1,159 @@
 #include "ui/content_view.h"
+#include "core/alloc_tracker.h"
+#include "core/charset.h"
+#include "core/trace.h"
+#include "ui/resources.h"
 
 #include <algorithm>
-#include <sstream>
 
 ContentView::ContentView()
-    : statusText_(font_), bodyText_(font_) {
-    // Load the same font used by the search bar; fallback to a system font if needed
-    if (!font_.openFromFile("assets/HelveticaNeue.ttc")) {
-        // Try a common macOS font
-        font_.openFromFile("/System/Library/Fonts/SFNS.ttf");
-    }
-
-    statusText_.setFont(font_);
+    : font_(Resources::instance().uiFont()), metrics_(font_, kBodySize), statusText_(font_), findText_(font_) {
     statusText_.setCharacterSize(14);
     statusText_.setFillColor(sf::Color(50, 50, 50));
     statusText_.setPosition({viewport_.position.x, viewport_.position.y - 18.f});
 
-    bodyText_.setFont(font_);
-    bodyText_.setCharacterSize(14);
-    bodyText_.setFillColor(sf::Color::Black);
-    bodyText_.setPosition({viewport_.position.x, viewport_.position.y});
+    findBox_.setFillColor(sf::Color(255, 248, 200));
+    findBox_.setOutlineColor(sf::Color(180, 180, 180));
+    findBox_.setOutlineThickness(1.f);
+    findText_.setCharacterSize(13);
+    findText_.setFillColor(sf::Color::Black);
+    underline_.setFillColor(sf::Color::Blue);
 }
 
 void ContentView::setViewport(const sf::FloatRect& viewport) {
     viewport_ = viewport;
     statusText_.setPosition({viewport_.position.x, viewport_.position.y - 18.f});
-    bodyText_.setPosition({viewport_.position.x, viewport_.position.y});
     rewrap();
 }
 
 void ContentView::setStatus(const std::string& statusText) {
-    statusText_.setString(statusText);
+    statusText_.setString(sf::String::fromUtf8(statusText.begin(), statusText.end()));
 }
 
-void ContentView::setContent(const std::string& text, const std::vector<Link>& links) {
-    raw_ = text;
+void ContentView::setContent(std::shared_ptr<const std::string> text, const std::vector<Link>& links) {
+    AllocPhaseScope phase(AllocPhase::Layout);
+    // Layout and painting decode straight from the text, so it must be well-formed
+    text_ = is_valid_utf8(*text) ? std::move(text) : std::make_shared<const std::string>(to_utf8(*text, Charset::Utf8));
+    metrics_.prepare(*text_);
     links_ = links;
+    scrollY_ = 0.f;
+    anchor_ = std::string::npos;
+    hoverUrl_.clear();
+    hoverFired_ = true;
+    finder_.setText(text_);
     rewrap();
+    // Re-run the open query against the new page
+    if (findOpen_) finder_.search(findQuery_);
 }
 
 bool ContentView::handleEvent(const sf::Event& event) {
+    if (const auto* e = event.getIf<sf::Event::KeyPressed>()) {
+        using Sc = sf::Keyboard::Scancode;
+        if (e->scancode == Sc::F && (e->control || e->system)) {
+            openFind();
+            return true;
+        }
+        if (findOpen_) {
+            if (e->scancode == Sc::Escape) {
+                closeFind();
+            } else if (e->scancode == Sc::Enter) {
+                stepFind(!e->shift);
+            } else if (e->scancode == Sc::Backspace && !findQuery_.empty()) {
+                // Drop the last UTF-8 sequence
+                std::size_t cut = findQuery_.size() - 1;
+                while (cut > 0 && (static_cast<unsigned char>(findQuery_[cut]) & 0xC0) == 0x80) --cut;
+                findQuery_.erase(cut);
+                finder_.search(findQuery_);
+                refreshFindLabel();
+            }
+            return true;
+        }
+    }
+
+    if (const auto* e = event.getIf<sf::Event::TextEntered>()) {
+        char32_t u = e->unicode;
+        if (findOpen_ && u >= 32 && u != 127) {
+            sf::String ch(u);
+            auto utf8 = ch.toUtf8();
+            findQuery_.append(utf8.begin(), utf8.end());
+            finder_.search(findQuery_);
+            refreshFindLabel();
+            return true;
+        }
+    }
+
     // Link click detection
     if (const auto* e = event.getIf<sf::Event::MouseButtonPressed>()) {
         if (e->button == sf::Mouse::Button::Left) {
             sf::Vector2f mousePos(static_cast<float>(e->position.x), static_cast<float>(e->position.y));
-            for (const auto& rlink : renderedLinks_) {
-                if (rlink.bounds.contains(mousePos)) {
-                    if (onLinkClick_) onLinkClick_(rlink.url);
-                    return true;
-                }
+            std::size_t link = linkAt(mousePos);
+            if (link != TextLayout::npos) {
+                if (onLinkClick_) onLinkClick_(links_[link].url);
+                return true;
             }
         }
     }
 
+    // Hover tracking; the dwell is checked every frame in draw()
+    if (const auto* e = event.getIf<sf::Event::MouseMoved>()) {
+        sf::Vector2f mousePos(static_cast<float>(e->position.x), static_cast<float>(e->position.y));
+        std::size_t link = linkAt(mousePos);
+        const std::string* hovered = link == TextLayout::npos ? nullptr : &links_[link].url;
+        if (!hovered) {
+            hoverUrl_.clear();
+        } else if (*hovered != hoverUrl_) {
+            hoverUrl_ = *hovered;
+            hoverClock_.restart();
+            hoverFired_ = false;
+        }
+        return false;
+    }
+
     if (const auto* e = event.getIf<sf::Event::MouseWheelScrolled>()) {
         // Scroll by lines
         float deltaLines = e->delta; // positive up
-        float lineStep = static_cast<float>(bodyText_.getCharacterSize()) * 1.4f;
+        float lineStep = static_cast<float>(kBodySize) * 1.4f;
         scrollY_ -= deltaLines * lineStep; // invert so wheel up scrolls up
         scrollY_ = std::max(0.f, scrollY_);
+        anchor_ = std::string::npos;
         return true;
     }
     return false;
 }
 
 void ContentView::draw(sf::RenderWindow& window) {
-    // Set a view/clipping by drawing into the default view and adjusting text position with scroll
-    // Simple clip: we won't implement stencil; just offset Y, content may overflow.
-    sf::Vector2f basePos(viewport_.position.x, viewport_.position.y - scrollY_);
-    bodyText_.setPosition(basePos);
+    TRACE_SCOPE("draw", "ContentView::draw");
+    updateFind();
 
     window.draw(statusText_);
-    window.draw(bodyText_);
-
-    // Render links as underlined blue text (approximate by searching wrapped_)
-    renderedLinks_.clear();
-    for (const auto& link : links_) {
-        if (link.text.empty()) continue;
-        // Find first occurrence of link.text in wrapped_
-        std::size_t start = wrapped_.find(link.text);
-        if (start == std::string::npos) continue;
-        std::size_t end = start + link.text.size();
-
-        sf::Vector2f startPos = bodyText_.findCharacterPos(start);
-        sf::Vector2f endPos = bodyText_.findCharacterPos(end);
-
-        // Underline (single-line assumption). If wrapped across lines, this is imperfect.
-        sf::RectangleShape underline;
-        underline.setPosition({startPos.x, startPos.y + static_cast<float>(bodyText_.getCharacterSize())});
-        underline.setSize({std::max(1.f, endPos.x - startPos.x), 1.f});
-        underline.setFillColor(sf::Color::Blue);
-        window.draw(underline);
-
-        // Clickable bounds (a little taller than text height)
-        RenderedLink rlink;
-        rlink.url = link.url;
-        rlink.bounds = sf::FloatRect(startPos, {std::max(1.f, endPos.x - startPos.x), static_cast<float>(bodyText_.getCharacterSize()) * 1.4f});
-        renderedLinks_.push_back(rlink);
+    if (findOpen_) drawFindHighlights(window);
+
+    // Only the lines inside the viewport are painted
+    const VisibleLines view = layout_.visibleLines(scrollY_, viewport_.size.y);
+    if (glyphsStale_ || view.first != glyphsFirst_ || view.last != glyphsLast_) buildGlyphs(view.first, view.last);
+
+    const sf::Vector2f origin = textOrigin();
+    sf::RenderStates states(&font_.getTexture(kBodySize));
+    states.transform.translate(origin);
+    window.draw(glyphs_, states);
+
+    // Underline the visible parts of links
+    const float lh = lineHeight();
+    for (std::size_t i = view.firstBox; i < view.lastBox; ++i) {
+        const LinkBox& box = layout_.linkBoxes()[i];
+        underline_.setPosition({origin.x + box.x, origin.y + static_cast<float>(box.line) * lh + static_cast<float>(kBodySize)});
+        underline_.setSize({std::max(1.f, box.width), 1.f});
+        window.draw(underline_);
+    }
+
+    if (!hoverFired_ && !hoverUrl_.empty() && hoverClock_.getElapsedTime().asMilliseconds() >= kHoverDwell.count()) {
+        hoverFired_ = true;
+        if (onLinkHover_) onLinkHover_(hoverUrl_);
+    }
+
+    if (findOpen_) {
+        window.draw(findBox_);
+        window.draw(findText_);
     }
 }
 
@@ -110,44 +167,161 @@ void ContentView::onResize(const sf::Vector2u& size) {
 }
 
 void ContentView::rewrap() {
-    // Respect existing newlines from the parser and wrap each line independently
-    if (raw_.empty()) { wrapped_.clear(); bodyText_.setString(""); return; }
-
-    // Approximate: character width ~ 0.6 * characterSize; adjust for your font
-    const float charW = bodyText_.getCharacterSize() * 0.6f;
-    const std::size_t maxCols = static_cast<std::size_t>(std::max(1.f, viewport_.size.x / charW));
-
-    std::ostringstream out;
-    std::size_t shown = 0;
-    const std::size_t limit = 4000; // preview cap to avoid huge draw cost
-
-    std::istringstream lines(raw_);
-    std::string line;
-    bool firstLine = true;
-    while (std::getline(lines, line)) {
-        if (!firstLine) out << '\n';
-        firstLine = false;
-
-        std::istringstream words(line);
-        std::string word;
-        std::size_t col = 0;
-        while (words >> word) {
-            if (shown + word.size() > limit) { break; }
-            if (col == 0) {
-                out << word;
-                col = word.size();
-            } else if (col + 1 + word.size() <= maxCols) {
-                out << ' ' << word;
-                col += 1 + word.size();
-            } else {
-                out << '\n' << word;
-                col = word.size();
+    TRACE_SCOPE("layout", "ContentView::rewrap");
+    AllocPhaseScope phase(AllocPhase::Layout);
+    // Layout itself never touches SFML; large pages are split across cores
+    layout_ = layout_text(*text_, links_, metrics_, LayoutOptions{viewport_.size.x, 0});
+    glyphsStale_ = true;
+    if (anchor_ != std::string::npos) scrollToAnchor(anchor_);
+    if (findOpen_) refreshFindLabel();
+}
+
+void ContentView::buildGlyphs(std::size_t first, std::size_t last) {
+    TRACE_SCOPE("draw", "ContentView::buildGlyphs");
+    glyphs_.clear();
+    glyphsFirst_ = first;
+    glyphsLast_ = last;
+    glyphsStale_ = false;
+
+    // Same quads sf::Text builds, placed where the layout put each run; only the
+    // lines on screen are decoded
+    const float lh = lineHeight();
+    const sf::Color color = sf::Color::Black;
+    const auto& lines = layout_.lines();
+    const auto& runs = layout_.runs();
+    for (std::size_t l = first; l < last; ++l) {
+        const float baseline = static_cast<float>(l) * lh + static_cast<float>(kBodySize);
+        for (std::size_t r = lines[l].firstRun; r < lines[l].firstRun + lines[l].runCount; ++r) {
+            float x = runs[r].x;
+            const std::string_view word = std::string_view(*text_).substr(layout_.runStart(l, r), runs[r].length);
+            char32_t c;
+            for (std::size_t i = 0, n; (n = decode_utf8(word, i, c)) != 0; i += n) {
+                const sf::Glyph& glyph = font_.getGlyph(c, kBodySize, false);
+                constexpr float pad = 1.f;
+                const float left = x + glyph.bounds.position.x - pad;
+                const float top = baseline + glyph.bounds.position.y - pad;
+                const float right = x + glyph.bounds.position.x + glyph.bounds.size.x + pad;
+                const float bottom = baseline + glyph.bounds.position.y + glyph.bounds.size.y + pad;
+                const float u1 = static_cast<float>(glyph.textureRect.position.x) - pad;
+                const float v1 = static_cast<float>(glyph.textureRect.position.y) - pad;
+                const float u2 = static_cast<float>(glyph.textureRect.position.x + glyph.textureRect.size.x) + pad;
+                const float v2 = static_cast<float>(glyph.textureRect.position.y + glyph.textureRect.size.y) + pad;
+                glyphs_.append({{left, top}, color, {u1, v1}});
+                glyphs_.append({{right, top}, color, {u2, v1}});
+                glyphs_.append({{left, bottom}, color, {u1, v2}});
+                glyphs_.append({{left, bottom}, color, {u1, v2}});
+                glyphs_.append({{right, top}, color, {u2, v1}});
+                glyphs_.append({{right, bottom}, color, {u2, v2}});
+                x += metrics_.advance(c);
             }
-            shown += word.size() + 1;
         }
-        if (shown >= limit) break;
     }
+}
+
+sf::Vector2f ContentView::textOrigin() const {
+    return {viewport_.position.x, viewport_.position.y - scrollY_};
+}
+
+std::size_t ContentView::linkAt(sf::Vector2f point) const {
+    const sf::Vector2f origin = textOrigin();
+    return layout_.linkAt(point.x - origin.x, point.y - origin.y);
+}
+
+std::size_t ContentView::scrollAnchor() const {
+    if (anchor_ != std::string::npos) return anchor_;
+    const auto& lines = layout_.lines();
+    if (lines.empty()) return 0;
+    const std::size_t topLine = static_cast<std::size_t>(std::max(0.f, scrollY_) / std::max(1.f, lineHeight()));
+    return topLine >= lines.size() ? text_->size() : lines[topLine].byteStart;
+}
+
+void ContentView::scrollToAnchor(std::size_t textOffset) {
+    anchor_ = textOffset;
+    scrollY_ = static_cast<float>(layout_.lineOf(textOffset)) * lineHeight();
+}
+
+void ContentView::openFind() {
+    findOpen_ = true;
+    if (!findQuery_.empty()) finder_.search(findQuery_);
+    refreshFindLabel();
+}
+
+void ContentView::closeFind() {
+    findOpen_ = false;
+    finder_.cancel();
+    findResult_ = FindResult{};
+    findCurrent_ = 0;
+}
+
+void ContentView::updateFind() {
+    if (!findOpen_ || !finder_.poll(findResult_)) return;
+
+    // Start from the first match at or below the top of the view
+    findCurrent_ = layout_.firstOffsetFrom(findResult_.matches, layout_.visibleLines(scrollY_, viewport_.size.y).first);
+    if (findCurrent_ >= findResult_.matches.size()) findCurrent_ = 0;
+    scrollToMatch();
+    refreshFindLabel();
+}
+
+void ContentView::stepFind(bool forward) {
+    const std::size_t count = findResult_.matches.size();
+    if (count == 0) return;
+    findCurrent_ = forward ? (findCurrent_ + 1) % count : (findCurrent_ + count - 1) % count;
+    scrollToMatch();
+    refreshFindLabel();
+}
+
+void ContentView::scrollToMatch() {
+    if (findCurrent_ >= findResult_.matches.size()) return;
+    const float lh = lineHeight();
+    const float y = static_cast<float>(layout_.lineOf(findResult_.matches[findCurrent_])) * lh;
+    if (y < scrollY_ || y + lh > scrollY_ + viewport_.size.y) {
+        scrollY_ = std::max(0.f, y - viewport_.size.y / 3.f);
+        anchor_ = std::string::npos;
+    }
+}
+
+void ContentView::refreshFindLabel() {
+    std::string label = "Find: " + findQuery_;
+    if (!findQuery_.empty() && findResult_.query == findQuery_) {
+        const std::size_t count = findResult_.matches.size();
+        label += count == 0 ? "   no matches"
+                            : "   " + std::to_string(findCurrent_ + 1) + "/" + std::to_string(count);
+    }
+    findText_.setString(sf::String::fromUtf8(label.begin(), label.end()));
 
-    wrapped_ = out.str();
-    bodyText_.setString(wrapped_);
+    const float width = 260.f;
+    sf::Vector2f pos(viewport_.position.x + viewport_.size.x - width, viewport_.position.y - 22.f);
+    findBox_.setPosition(pos);
+    findBox_.setSize({width, 20.f});
+    findText_.setPosition({pos.x + 6.f, pos.y + 2.f});
+}
+
+void ContentView::drawFindHighlights(sf::RenderWindow& window) {
+    if (findResult_.matches.empty() || findResult_.query != findQuery_) return;
+
+    const float lh = lineHeight();
+    const VisibleLines view = layout_.visibleLines(scrollY_, viewport_.size.y);
+    const auto& matches = findResult_.matches;
+
+    const sf::Vector2f origin = textOrigin();
+    const auto& lines = layout_.lines();
+    const auto& runs = layout_.runs();
+    if (lines.empty()) return;
+    sf::RectangleShape& box = highlight_;
+    for (std::size_t i = layout_.firstOffsetFrom(matches, view.first); i < matches.size(); ++i) {
+        const std::size_t m = matches[i];
+        const std::size_t line = layout_.lineOf(m);
+        if (line >= view.last) break; // matches are ascending
+
+        // Highlight the first line of a match only
+        const LayoutLine& l = lines[line];
+        const float a = layout_.xOf(m, *text_, metrics_);
+        float b = l.runCount ? runs[l.firstRun + l.runCount - 1].x + runs[l.firstRun + l.runCount - 1].width : a;
+        if (layout_.lineOf(m + findResult_.length - 1) == line) b = layout_.xOf(m + findResult_.length, *text_, metrics_);
+        box.setPosition({origin.x + a, origin.y + static_cast<float>(line) * lh});
+        box.setSize({std::max(2.f, b - a), lh});
+        box.setFillColor(i == findCurrent_ ? sf::Color(255, 150, 50) : sf::Color(255, 235, 80));
+        window.draw(box);
+    }
 }
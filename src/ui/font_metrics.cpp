@@ -0,0 +1,21 @@
+#include "ui/font_metrics.h"
+#include "core/charset.h"
+
+FontMetrics::FontMetrics(const sf::Font& font, unsigned characterSize)
+    : TableGlyphMetrics(static_cast<float>(characterSize) * 0.6f, font.getLineSpacing(characterSize)),
+      font_(font), size_(characterSize) {
+    // Printable ASCII up front; most pages need nothing else
+    for (char32_t c = U' '; c < 0x7F; ++c) set(c, font_.getGlyph(c, size_, false).advance);
+}
+
+void FontMetrics::prepare(std::string_view text) {
+    for (std::size_t i = 0; i < text.size();) {
+        if (static_cast<unsigned char>(text[i]) < 0x80) {
+            ++i;
+            continue;
+        }
+        char32_t c;
+        i += decode_utf8(text, i, c);
+        if (!has(c)) set(c, font_.getGlyph(c, size_, false).advance);
+    }
+}
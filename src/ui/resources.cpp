@@ -0,0 +1,42 @@
+#include "ui/resources.h"
+
+namespace {
+// Bundled font first, then common system fonts
+const char* const kUiFontCandidates[] = {
+    "assets/HelveticaNeue.ttc",
+    "/System/Library/Fonts/HelveticaNeue.ttc",
+    "/System/Library/Fonts/SFNS.ttf",
+    "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf",
+    "/usr/share/fonts/TTF/DejaVuSans.ttf",
+};
+}
+
+Resources& Resources::instance() {
+    static Resources resources;
+    return resources;
+}
+
+const sf::Font* Resources::font(const std::string& path) {
+    std::lock_guard lock(mutex_);
+    auto it = fonts_.find(path);
+    if (it == fonts_.end()) {
+        auto face = std::make_unique<sf::Font>();
+        if (!face->openFromFile(path)) face.reset();
+        it = fonts_.emplace(path, std::move(face)).first;
+    }
+    return it->second.get();
+}
+
+const sf::Font& Resources::uiFont() {
+    if (uiFont_) return *uiFont_;
+    for (const char* path : kUiFontCandidates) {
+        if (const sf::Font* face = font(path)) {
+            uiFont_ = face;
+            return *face;
+        }
+    }
+    // No usable font: text renders empty rather than crashing
+    static const sf::Font empty;
+    uiFont_ = &empty;
+    return empty;
+}
@@ -1,9 +1,9 @@
 #include "ui/searchbar.h"
+#include "ui/resources.h"
 
 SearchBar::SearchBar()
   : background({780.f, 30.f}),
-    font("assets/HelveticaNeue.ttc"),
-    text(font)
+    text(Resources::instance().uiFont())
 {
     background.setFillColor(sf::Color(200, 200, 200));
     background.setPosition({10, 10});
@@ -20,11 +20,12 @@ void SearchBar::draw(sf::RenderWindow &window) {
 }
 
 void SearchBar::setText(const std::string &str) {
-    text.setString(str);
+    text.setString(sf::String::fromUtf8(str.begin(), str.end()));
 }
 
 std::string SearchBar::getText() const {
-    return text.getString();
+    auto utf8 = text.getString().toUtf8();
+    return std::string(utf8.begin(), utf8.end());
 }
 
 bool SearchBar::handleEvent(const sf::Event& event) {
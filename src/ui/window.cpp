@@ -1,16 +1,21 @@
 #include "ui/window.h"
+#include "core/alloc_tracker.h"
+#include "core/trace.h"
 
 Window::Window() : window(sf::VideoMode({800, 600}), "mini browser") {
     window.setFramerateLimit(60);
 }
 
 void Window::run(SearchBar &searchBar, ContentView &content) {
+    trace_set_thread_name("ui");
     content.onResize(window.getSize());
     while (window.isOpen())
     {
+        TRACE_SCOPE("ui", "frame");
         // check all the window's events that were triggered since the last iteration of the loop
         while (const std::optional event = window.pollEvent())
         {
+            TRACE_SCOPE("ui", "event");
             // "close requested" event: we close the window
             if (event->is<sf::Event::Closed>())
                 window.close();
@@ -24,18 +29,27 @@ void Window::run(SearchBar &searchBar, ContentView &content) {
                 content.onResize(sz);
             }
 
-            // Forward events to the search bar for text input and focus
-            searchBar.handleEvent(*event);
+            // Forward events to the search bar for text input and focus;
+            // while the find bar is open it owns the keyboard
+            bool keyboard = event->is<sf::Event::TextEntered>() || event->is<sf::Event::KeyPressed>();
+            if (!(keyboard && content.isFindOpen()))
+                searchBar.handleEvent(*event);
 
-            // Forward events to content for scrolling
+            // Forward events to content for scrolling, links and find
             content.handleEvent(*event);
         }
 
         draw(searchBar, content);
+        if (onFrame) {
+            TRACE_SCOPE("ui", "onFrame");
+            onFrame();
+        }
     }
 }
 
 void Window::draw(SearchBar &searchBar, ContentView &content) {
+    TRACE_SCOPE("draw", "Window::draw");
+    AllocPhaseScope phase(AllocPhase::Draw);
     window.clear(sf::Color::White);
     searchBar.draw(window);
     content.draw(window);
@@ -0,0 +1,245 @@
+#ifndef LOCAL_SERVER_H
+#define LOCAL_SERVER_H
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @class LocalServer
+ * @brief Loopback HTTP/1.1 stand-in server for tests and benchmarks
+ *
+ * Serves keep-alive GET/HEAD requests from a single poll() thread. A
+ * handshake delay can be injected: the first response on every new
+ * connection is held back by that long, imitating DNS/TCP/TLS setup cost
+ * that a reused connection does not pay again. Responses can also be
+ * throttled to imitate a slow link.
+ */
+class LocalServer {
+public:
+    struct Request {
+        std::string method;
+        std::string path;
+    };
+
+    struct Response {
+        int status = 200;
+        std::string body;
+        std::string contentType = "text/html";
+    };
+
+    using Handler = std::function<Response(const Request&)>;
+
+    /**
+     * @brief Start listening on 127.0.0.1 with an ephemeral port
+     *
+     * @param handler Produces the response for each request
+     * @param handshakeDelay Extra latency before a connection's first response
+     */
+    explicit LocalServer(Handler handler, std::chrono::milliseconds handshakeDelay = std::chrono::milliseconds(0))
+        : handler_(std::move(handler)), handshakeDelay_(handshakeDelay) {
+        listenFd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        ::setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        ::bind(listenFd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        ::listen(listenFd_, 1024);
+        socklen_t len = sizeof(addr);
+        ::getsockname(listenFd_, reinterpret_cast<sockaddr*>(&addr), &len);
+        port_ = ntohs(addr.sin_port);
+        set_nonblocking(listenFd_);
+        ::pipe(wakePipe_);
+        thread_ = std::thread([this] { loop(); });
+    }
+
+    ~LocalServer() {
+        stopping_ = true;
+        char c = 0;
+        (void)::write(wakePipe_[1], &c, 1);
+        thread_.join();
+        for (auto& conn : conns_) ::close(conn.fd);
+        ::close(listenFd_);
+        ::close(wakePipe_[0]);
+        ::close(wakePipe_[1]);
+    }
+
+    LocalServer(const LocalServer&) = delete;
+    LocalServer& operator=(const LocalServer&) = delete;
+
+    int port() const { return port_; }
+
+    /// Base URL, e.g. "http://127.0.0.1:41234"
+    std::string url() const { return "http://127.0.0.1:" + std::to_string(port_); }
+
+    /// Connections accepted so far
+    std::size_t connections() const { return connections_.load(); }
+
+    /// Requests answered so far
+    std::size_t requests() const { return requests_.load(); }
+
+    /// Response bytes written to sockets so far
+    std::size_t bytesSent() const { return bytesSent_.load(); }
+
+    /**
+     * @brief Send at most chunk bytes per connection every interval
+     *
+     * Call before the first request; chunk 0 (the default) sends at full speed.
+     */
+    void setThrottle(std::size_t chunk, std::chrono::milliseconds interval) {
+        throttleChunk_ = chunk;
+        throttleInterval_ = interval;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Conn {
+        int fd;
+        Clock::time_point readyAt;   ///< Nothing may be sent before this (handshake, throttle)
+        std::string in;
+        std::string out;
+        bool closeAfterWrite = false;
+    };
+
+    static void set_nonblocking(int fd) {
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+
+    static const char* reason(int status) {
+        switch (status) {
+            case 200: return "OK";
+            case 301: return "Moved Permanently";
+            case 302: return "Found";
+            case 404: return "Not Found";
+            case 500: return "Internal Server Error";
+            default: return "Status";
+        }
+    }
+
+    // Answer every complete request buffered on a connection
+    void serve(Conn& conn) {
+        std::size_t end;
+        while ((end = conn.in.find("\r\n\r\n")) != std::string::npos) {
+            std::string head = conn.in.substr(0, end);
+            conn.in.erase(0, end + 4);
+
+            Request req;
+            std::size_t sp1 = head.find(' ');
+            std::size_t sp2 = head.find(' ', sp1 + 1);
+            req.method = head.substr(0, sp1);
+            req.path = head.substr(sp1 + 1, sp2 - sp1 - 1);
+            Response res = handler_(req);
+
+            conn.out += "HTTP/1.1 " + std::to_string(res.status) + " " + reason(res.status) + "\r\n";
+            conn.out += "Content-Type: " + res.contentType + "\r\n";
+            conn.out += "Content-Length: " + std::to_string(res.body.size()) + "\r\n\r\n";
+            if (req.method != "HEAD") conn.out += res.body;
+            ++requests_;
+        }
+    }
+
+    void loop() {
+        std::vector<pollfd> fds;
+        while (!stopping_) {
+            auto now = Clock::now();
+            int timeout = -1;
+            fds.clear();
+            fds.push_back({wakePipe_[0], POLLIN, 0});
+            fds.push_back({listenFd_, POLLIN, 0});
+            for (auto& conn : conns_) {
+                short events = POLLIN;
+                if (!conn.out.empty()) {
+                    if (now >= conn.readyAt) {
+                        events |= POLLOUT;
+                    } else {
+                        auto wait = std::chrono::ceil<std::chrono::milliseconds>(conn.readyAt - now).count();
+                        timeout = timeout < 0 ? static_cast<int>(wait) : std::min(timeout, static_cast<int>(wait));
+                    }
+                }
+                fds.push_back({conn.fd, events, 0});
+            }
+            ::poll(fds.data(), fds.size(), timeout);
+            if (stopping_) break;
+
+            if (fds[1].revents & POLLIN) {
+                int fd;
+                while ((fd = ::accept(listenFd_, nullptr, nullptr)) >= 0) {
+                    set_nonblocking(fd);
+                    conns_.push_back(Conn{fd, Clock::now() + handshakeDelay_, {}, {}, false});
+                    ++connections_;
+                }
+            }
+
+            // conns_ may have grown; only the first fds.size() - 2 have poll results
+            std::size_t polled = fds.size() - 2;
+            for (std::size_t i = 0; i < polled; ++i) {
+                Conn& conn = conns_[i];
+                short re = fds[i + 2].revents;
+                if (re & (POLLIN | POLLHUP | POLLERR)) {
+                    char buf[16384];
+                    ssize_t n;
+                    while ((n = ::read(conn.fd, buf, sizeof(buf))) > 0) conn.in.append(buf, static_cast<std::size_t>(n));
+                    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+                        // Peer is gone; nothing left to answer
+                        conn.closeAfterWrite = true;
+                        conn.out.clear();
+                        continue;
+                    }
+                    serve(conn);
+                }
+                if ((re & POLLOUT) && !conn.out.empty()) {
+                    std::size_t chunk = throttleChunk_.load();
+                    std::size_t len = chunk ? std::min(chunk, conn.out.size()) : conn.out.size();
+                    ssize_t n = ::send(conn.fd, conn.out.data(), len, MSG_NOSIGNAL);
+                    if (n > 0) {
+                        conn.out.erase(0, static_cast<std::size_t>(n));
+                        bytesSent_ += static_cast<std::size_t>(n);
+                        if (chunk) conn.readyAt = Clock::now() + throttleInterval_.load();
+                    } else if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                        conn.closeAfterWrite = true;
+                        conn.out.clear();
+                    }
+                }
+            }
+
+            std::erase_if(conns_, [](const Conn& conn) {
+                if (conn.closeAfterWrite && conn.out.empty()) {
+                    ::close(conn.fd);
+                    return true;
+                }
+                return false;
+            });
+        }
+    }
+
+    Handler handler_;
+    std::chrono::milliseconds handshakeDelay_;
+    int listenFd_ = -1;
+    int wakePipe_[2] = {-1, -1};
+    int port_ = 0;
+    std::vector<Conn> conns_;
+    std::atomic<bool> stopping_ {false};
+    std::atomic<std::size_t> connections_ {0};
+    std::atomic<std::size_t> requests_ {0};
+    std::atomic<std::size_t> bytesSent_ {0};
+    std::atomic<std::size_t> throttleChunk_ {0};
+    std::atomic<std::chrono::milliseconds> throttleInterval_ {std::chrono::milliseconds(0)};
+    std::thread thread_;
+};
+
+#endif
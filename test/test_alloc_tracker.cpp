@@ -0,0 +1,143 @@
+#include "test.h"
+#include "core/alloc_tracker.h"
+#include "core/executor.h"
+#include "core/html_parser.h"
+#include "core/text_layout.h"
+#include "core/trace.h"
+#include "core/url.h"
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::uint64_t allocations(AllocPhase phase) {
+    return alloc_snapshot()[phase].allocations;
+}
+
+// Many paragraphs with a link in each, long enough to defeat the small-string buffer
+std::string linked_page(int paragraphs) {
+    std::string html = "<html><head><title>  Links &amp; more \n second line </title></head><body>\n";
+    for (int i = 0; i < paragraphs; ++i) {
+        html += "<p>Paragraph " + std::to_string(i) + " has some words and <a href=\"/articles/entry-" +
+                std::to_string(i) + ".html\">a link to entry number " + std::to_string(i) + "</a> after them.</p>\n";
+    }
+    return html + "</body></html>";
+}
+
+}
+
+TEST(test_alloc_tracking_counts_by_phase) {
+    ASSERT(alloc_tracking_enabled(), "Test binary is built with the counting hooks");
+    ASSERT(alloc_current_phase() == AllocPhase::Other, "Threads start outside any phase");
+
+    const AllocCounters before = alloc_snapshot()[AllocPhase::Decode];
+    auto* block = static_cast<std::vector<char>*>(nullptr);
+    {
+        AllocPhaseScope phase(AllocPhase::Decode);
+        {
+            AllocPhaseScope inner(AllocPhase::Layout);
+            ASSERT(alloc_current_phase() == AllocPhase::Layout, "Inner scope wins");
+        }
+        ASSERT(alloc_current_phase() == AllocPhase::Decode, "Outer phase restored");
+        block = new std::vector<char>(4000);
+    }
+    AllocCounters during = alloc_snapshot()[AllocPhase::Decode];
+    ASSERT_EQ(before.allocations + 2, during.allocations, "The vector and its buffer");
+    ASSERT(during.bytes - before.bytes >= 4000, "Bytes counted");
+    ASSERT(during.liveBytes - before.liveBytes >= 4000, "Still live");
+    ASSERT(during.peakLiveBytes >= during.liveBytes, "Peak covers live");
+
+    delete block;   // freed outside the phase, credited back to it
+    AllocCounters after = alloc_snapshot()[AllocPhase::Decode];
+    ASSERT_EQ(before.frees + 2, after.frees, "Frees counted against the allocating phase");
+    ASSERT_EQ(before.liveBytes, after.liveBytes, "Nothing left live");
+}
+
+TEST(test_alloc_tracking_threads_and_alignment) {
+    const std::uint64_t links = allocations(AllocPhase::Links);
+    std::thread t([] {
+        AllocPhaseScope phase(AllocPhase::Links);
+        std::vector<int> v(100);
+    });
+    t.join();
+    ASSERT_EQ(links + 1, allocations(AllocPhase::Links), "Another thread's scope counts for its own allocations");
+    ASSERT(alloc_current_phase() == AllocPhase::Other, "This thread's phase is untouched");
+
+    struct alignas(64) Line { char bytes[64]; };
+    const std::uint64_t draw = allocations(AllocPhase::Draw);
+    AllocPhaseScope phase(AllocPhase::Draw);
+    Line* line = new Line;
+    ASSERT_EQ(0u, reinterpret_cast<std::uintptr_t>(line) % 64, "Over-aligned new keeps its alignment");
+    delete line;
+    ASSERT_EQ(draw + 1, allocations(AllocPhase::Draw), "Over-aligned new is counted");
+}
+
+TEST(test_alloc_parse_budget) {
+    constexpr int kParagraphs = 1000;
+    const std::string html = linked_page(kParagraphs);
+    const AllocSnapshot before = alloc_snapshot();
+    ParsedPage page = parse_html_basic(html, ParseOptions{std::chrono::milliseconds(0), 1});
+    const AllocSnapshot after = alloc_snapshot();
+    ASSERT_EQ(static_cast<std::size_t>(kParagraphs), page.links.size(), "Every link found");
+    ASSERT_EQ(std::string("Links & more\nsecond line"), page.title, "Title decoded and trimmed");
+
+    // Per link: its text and URL strings, plus the links vector growing geometrically
+    const std::uint64_t parse = after[AllocPhase::Parse].allocations - before[AllocPhase::Parse].allocations;
+    ASSERT(parse <= 2 * kParagraphs + 40, "Parser allocations stay at about two per link, got " + std::to_string(parse));
+
+    const Url base = *Url::parse("https://example.com/index.html");
+    const AllocSnapshot beforeLinks = alloc_snapshot();
+    resolve_links(page.links, base);
+    const std::uint64_t resolve = alloc_snapshot()[AllocPhase::Links].allocations - beforeLinks[AllocPhase::Links].allocations;
+    ASSERT(resolve > 0, "Resolving is attributed to its own phase");
+    ASSERT(resolve <= 2 * kParagraphs, "Resolving stays within two allocations per link, got " + std::to_string(resolve));
+}
+
+TEST(test_alloc_steady_frame_allocates_nothing) {
+    ParsedPage page = parse_html_basic(linked_page(500));
+    FixedGlyphMetrics metrics(7.f, 17.f);
+    const std::uint64_t layoutBefore = allocations(AllocPhase::Layout);
+    TextLayout layout = layout_text(page.text, page.links, metrics, LayoutOptions{400.f, 1});
+    ASSERT(allocations(AllocPhase::Layout) > layoutBefore, "Layout is attributed to its phase");
+
+    std::vector<std::size_t> matches;
+    for (std::size_t m = page.text.find("entry number"); m != std::string::npos; m = page.text.find("entry number", m + 1)) {
+        matches.push_back(m);
+    }
+
+    // The core calls ContentView::draw makes per frame once a page is on screen: pick the visible
+    // lines and their link boxes, hit-test the pointer, place find matches, drain the main-thread queue
+    MainThreadQueue mainQueue;
+    const std::uint64_t drawBefore = allocations(AllocPhase::Draw);
+    std::size_t touched = 0;
+    for (int frame = 0; frame < 120; ++frame) {
+        AllocPhaseScope phase(AllocPhase::Draw);
+        TRACE_SCOPE("ui", "frame");
+        const float scrollY = static_cast<float>(frame) * 10.f;
+        const VisibleLines view = layout.visibleLines(scrollY, 600.f);
+        touched += view.lastBox - view.firstBox;
+        if (layout.linkAt(120.f, scrollY + 5.f) != TextLayout::npos) ++touched;
+        for (std::size_t i = layout.firstOffsetFrom(matches, view.first); i < matches.size(); ++i) {
+            if (layout.lineOf(matches[i]) >= view.last) break;
+            touched += layout.xOf(matches[i], page.text, metrics) > 0.f;
+        }
+        mainQueue.drain();
+    }
+    ASSERT(touched > 0, "Frames did real work");
+    ASSERT_EQ(drawBefore, allocations(AllocPhase::Draw), "Steady-state frames allocate nothing");
+}
+
+TEST(test_alloc_report_lists_active_phases) {
+    alloc_reset_peaks();
+    const AllocSnapshot before = alloc_snapshot();
+    {
+        AllocPhaseScope phase(AllocPhase::Parse);
+        std::string big(100000, 'x');
+    }
+    const std::string report = alloc_report(before, alloc_snapshot());
+    ASSERT(report.find("parse") != std::string::npos, "Phase that allocated is listed");
+    ASSERT(report.find("97.7 KB") != std::string::npos, "Bytes and peak live growth reported, got\n" + report);
+    ASSERT(report.find("draw") == std::string::npos, "Idle phases are left out");
+}
@@ -0,0 +1,64 @@
+#include "test.h"
+#include "core/charset.h"
+#include <string>
+
+TEST(test_utf8_validation) {
+    ASSERT(is_valid_utf8(""), "Empty text is valid");
+    ASSERT(is_valid_utf8(std::string(100, 'a')), "Long ASCII run is valid");
+    ASSERT(is_valid_utf8("caf\xC3\xA9 \xE2\x82\xAC \xF0\x9F\x98\x80"), "2-, 3- and 4-byte sequences");
+    ASSERT(!is_valid_utf8("\xC0\xAF"), "Overlong 2-byte form");
+    ASSERT(!is_valid_utf8("\xE0\x80\xAF"), "Overlong 3-byte form");
+    ASSERT(!is_valid_utf8("\xED\xA0\x80"), "UTF-16 surrogate");
+    ASSERT(!is_valid_utf8("\xF4\x90\x80\x80"), "Above U+10FFFF");
+    ASSERT(!is_valid_utf8("\xE2\x82"), "Truncated sequence");
+    ASSERT(!is_valid_utf8("\x80"), "Stray continuation byte");
+
+    // The error is located exactly, even past the word-at-a-time ASCII scan
+    std::string text = std::string(45, 'x') + "\xFF" + std::string(20, 'y');
+    ASSERT_EQ(45u, valid_utf8_prefix(text), "Prefix stops at the bad byte");
+}
+
+TEST(test_charset_detection) {
+    ASSERT(detect_charset("text/html; charset=ISO-8859-1", "<p>x</p>") == Charset::Windows1252,
+           "Header charset; latin1 labels map to windows-1252");
+    ASSERT(detect_charset("text/html; charset=\"utf-8\"", "\xE9") == Charset::Utf8, "Quoted header charset wins");
+    ASSERT(detect_charset("text/html", "<html><head><META CharSet='windows-1252'>") == Charset::Windows1252,
+           "<meta charset>");
+    ASSERT(detect_charset("", "<meta http-equiv=\"Content-Type\" content=\"text/html; charset=utf-8\">")
+               == Charset::Utf8,
+           "<meta http-equiv>");
+    ASSERT(detect_charset("text/html; charset=bogus", "<meta charset=latin1>") == Charset::Windows1252,
+           "Unknown header label falls through to <meta>");
+    ASSERT(detect_charset("text/html; charset=windows-1252", "\xEF\xBB\xBFhi") == Charset::Utf8, "BOM wins");
+    ASSERT(detect_charset("", std::string("\xFF\xFEh\0i\0", 6)) == Charset::Utf16Le, "UTF-16LE BOM");
+    ASSERT(detect_charset("", "plain caf\xC3\xA9") == Charset::Utf8, "Valid UTF-8 is assumed UTF-8");
+    ASSERT(detect_charset("", "plain caf\xE9") == Charset::Windows1252, "Invalid UTF-8 falls back to windows-1252");
+}
+
+TEST(test_transcode_to_utf8) {
+    ASSERT_EQ(std::string("caf\xC3\xA9 \xE2\x82\xAC \xE2\x80\x9Cq\xE2\x80\x9D"),
+              to_utf8("caf\xE9 \x80 \x93q\x94", Charset::Windows1252), "windows-1252 upper half");
+    ASSERT_EQ(std::string("ok"), to_utf8("\xEF\xBB\xBFok", Charset::Utf8), "UTF-8 BOM is dropped");
+    ASSERT_EQ(std::string("ok"), std::string(strip_utf8_bom("\xEF\xBB\xBFok")), "BOM stripped from UTF-8 used in place");
+    ASSERT_EQ(std::string("o\xEF\xBB\xBFk"), std::string(strip_utf8_bom("o\xEF\xBB\xBFk")), "Only a leading BOM is a BOM");
+    ASSERT_EQ(std::string("a\xEF\xBF\xBD" "b\xEF\xBF\xBD" "c"), to_utf8("a\xE2\x82" "b\x80" "c", Charset::Utf8),
+              "Malformed UTF-8 becomes U+FFFD");
+    ASSERT_EQ(std::string("h\xC3\xA9\xF0\x9F\x98\x80"),
+              to_utf8(std::string("\xFF\xFEh\0\xE9\0\x3D\xD8\x00\xDE", 10), Charset::Utf16Le),
+              "UTF-16LE with a surrogate pair");
+    ASSERT(is_valid_utf8(to_utf8("\xC0\xFF\xFE\xED\xA0\x80", Charset::Utf8)), "Output is always valid UTF-8");
+}
+
+TEST(test_decode_utf8) {
+    const std::string_view text = "a\xC3\xA9\xF0\x9F\x98\x80\xE2\x82";
+    char32_t cp = 0;
+    ASSERT_EQ(1u, decode_utf8(text, 0, cp), "ASCII is one byte");
+    ASSERT(cp == U'a', "ASCII decoded");
+    ASSERT_EQ(2u, decode_utf8(text, 1, cp), "Two-byte sequence");
+    ASSERT(cp == U'é', "é decoded");
+    ASSERT_EQ(4u, decode_utf8(text, 3, cp), "Four-byte sequence");
+    ASSERT(cp == U'\U0001F600', "Emoji decoded");
+    ASSERT_EQ(1u, decode_utf8(text, 7, cp), "A truncated sequence consumes one byte");
+    ASSERT(cp == 0xFFFD, "and decodes to U+FFFD");
+    ASSERT_EQ(0u, decode_utf8(text, text.size(), cp), "Nothing at the end");
+}
@@ -0,0 +1,116 @@
+#include "test.h"
+#include "local_server.h"
+#include "core/connection_pool.h"
+#include "core/http_client.h"
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+LocalServer::Response hello(const LocalServer::Request& req) {
+    return {200, "<p>hello " + req.path + "</p>"};
+}
+
+}
+
+TEST(test_preconnect_connection_is_reused) {
+    LocalServer server(hello);
+    ConnectionPool pool;
+
+    pool.preconnect(server.url() + "/page");
+    pool.waitForWarmups();
+    ASSERT_EQ(1u, pool.idleCount(), "Warm handle is parked");
+    ASSERT_EQ(1u, server.connections(), "Warm-up opened one connection");
+
+    HttpResult r = http_get(server.url() + "/page", 5000, &pool);
+    ASSERT(r.error.empty(), "Fetch succeeds");
+    ASSERT_EQ(200, r.status, "Status 200");
+    ASSERT_EQ(std::string("<p>hello /page</p>"), r.body, "Body of the GET, not the HEAD");
+    ASSERT_EQ(1u, server.connections(), "The fetch reused the warm connection");
+    ASSERT_EQ(1u, pool.idleCount(), "Handle is parked again after the fetch");
+
+    pool.preconnect(server.url() + "/other");
+    pool.waitForWarmups();
+    ASSERT_EQ(2u, server.requests(), "Already-warm origins are not warmed twice");
+}
+
+TEST(test_preconnect_never_requests_hovered_path) {
+    std::mutex mutex;
+    std::vector<std::string> seen;
+    LocalServer server([&](const LocalServer::Request& req) {
+        std::lock_guard lock(mutex);
+        seen.push_back(req.method + " " + req.path);
+        return LocalServer::Response{200, "ok"};
+    });
+    ConnectionPool pool;
+
+    pool.preconnect(server.url() + "/account/logout?token=abc");
+    pool.waitForWarmups();
+    ASSERT_EQ(1u, pool.idleCount(), "Origin is warm");
+    std::lock_guard lock(mutex);
+    ASSERT_EQ(1u, seen.size(), "One warm-up request");
+    ASSERT_EQ(std::string("HEAD /"), seen[0], "Warm-up targets the origin root, never the hovered path");
+}
+
+TEST(test_acquire_drops_queued_warmup) {
+    LocalServer slow(hello, 1000ms);
+    LocalServer fast(hello);
+    ConnectionPool pool;
+
+    // The slow origin's warm-up holds the worker; the fast one queues behind it
+    pool.preconnect(slow.url() + "/");
+    std::this_thread::sleep_for(50ms);
+    pool.preconnect(fast.url() + "/");
+
+    auto start = std::chrono::steady_clock::now();
+    HttpResult r = http_get(fast.url() + "/page", 5000, &pool);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    ASSERT(r.error.empty(), "Fetch succeeds");
+    ASSERT(elapsed < 500ms, "Did not wait behind another origin's warm-up");
+
+    pool.waitForWarmups();
+    ASSERT_EQ(1u, fast.requests(), "The queued warm-up was dropped, not run later");
+}
+
+TEST(test_preconnect_ignores_non_http) {
+    ConnectionPool pool;
+    pool.preconnect("mailto:someone@example.com");
+    pool.preconnect("not a url");
+    pool.waitForWarmups();
+    ASSERT_EQ(0u, pool.idleCount(), "Nothing to warm");
+}
+
+TEST(test_connection_pool_cap) {
+    std::vector<std::unique_ptr<LocalServer>> servers;
+    for (int i = 0; i < 5; ++i) servers.push_back(std::make_unique<LocalServer>(hello));
+
+    ConnectionPool pool(3);
+    for (auto& server : servers) {
+        pool.preconnect(server->url() + "/");
+        pool.waitForWarmups();
+    }
+    ASSERT_EQ(3u, pool.idleCount(), "At most maxIdle warm handles");
+
+    // The oldest origins were evicted, the newest is still warm
+    http_get(servers[4]->url() + "/", 5000, &pool);
+    ASSERT_EQ(1u, servers[4]->connections(), "Newest warm connection reused");
+    http_get(servers[0]->url() + "/", 5000, &pool);
+    ASSERT_EQ(2u, servers[0]->connections(), "Evicted origin had to reconnect");
+}
+
+TEST(test_connection_pool_idle_expiry) {
+    LocalServer server(hello);
+    ConnectionPool pool(4, 50ms);
+    pool.preconnect(server.url() + "/");
+    pool.waitForWarmups();
+    ASSERT_EQ(1u, pool.idleCount(), "Warm handle parked");
+
+    std::this_thread::sleep_for(300ms);
+    ASSERT_EQ(0u, pool.idleCount(), "Idle handle expired");
+}
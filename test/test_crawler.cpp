@@ -0,0 +1,201 @@
+#include "test.h"
+#include "local_server.h"
+#include "core/crawler.h"
+#include "core/http_client.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kSitePages = 2000;
+
+// Records every path served, in order, with its arrival time
+struct ServeLog {
+    std::mutex mutex;
+    std::vector<std::string> paths;
+    std::vector<Clock::time_point> times;
+
+    void record(const std::string& path) {
+        std::lock_guard lock(mutex);
+        paths.push_back(path);
+        times.push_back(Clock::now());
+    }
+};
+
+// /p/N links to a few pseudo-random pages plus its successor, so every page
+// is reachable from /p/0; fragments, self links and off-origin links must
+// all be skipped. /c/N is a plain chain for depth and politeness tests.
+LocalServer::Handler site(ServeLog& log) {
+    return [&log](const LocalServer::Request& req) -> LocalServer::Response {
+        log.record(req.path);
+        if (req.path.starts_with("/p/")) {
+            int n = std::stoi(req.path.substr(3));
+            if (n < 0 || n >= kSitePages) return {404, "gone"};
+            std::string body = "<html><head><title>Page " + std::to_string(n) + "</title></head><body><p>Body of page "
+                             + std::to_string(n) + ".</p>";
+            for (int next : {(n + 1) % kSitePages, (n * 7 + 3) % kSitePages, (n * 13 + 5) % kSitePages}) {
+                body += "<a href=\"/p/" + std::to_string(next) + "\">next</a> ";
+            }
+            body += "<a href=\"#top\">top</a> <a href=\"/p/" + std::to_string(n) + "#section\">self</a> "
+                    "<a href=\"../p/" + std::to_string((n + 1) % kSitePages) + "\">relative</a> "
+                    "<a href=\"http://127.0.0.1:1/p/0\">other port</a> <a href=\"mailto:a@b.c\">mail</a>"
+                    "<a href=\"/missing\">broken</a></body></html>";
+            return {200, body};
+        }
+        if (req.path.starts_with("/c/")) {
+            int n = std::stoi(req.path.substr(3));
+            return {200, "<title>Chain " + std::to_string(n) + "</title><a href=\"/c/" + std::to_string(n + 1) + "\">on</a>"};
+        }
+        return {404, "not found"};
+    };
+}
+
+std::size_t count_lines(const std::string& path) {
+    std::ifstream in(path);
+    std::size_t n = 0;
+    for (std::string line; std::getline(in, line);) ++n;
+    return n;
+}
+
+}
+
+TEST(test_visited_set) {
+    VisitedSet set(4);
+    ASSERT(set.insert("http://a/1"), "First insert is new");
+    ASSERT(!set.insert("http://a/1"), "Second insert is a duplicate");
+    ASSERT(set.contains("http://a/1"), "Inserted key is found");
+    ASSERT(!set.contains("http://a/2"), "Other key is not found");
+    for (int i = 0; i < 100000; ++i) set.insert("http://example.com/page/" + std::to_string(i));
+    ASSERT_EQ(100001u, set.size(), "Table grows without losing keys");
+    for (int i = 0; i < 100000; i += 997) {
+        ASSERT(set.contains("http://example.com/page/" + std::to_string(i)), "Keys survive rehashing");
+    }
+    ASSERT(set.memoryBytes() <= 100001u * 32, "Fingerprints only: a few words per URL");
+}
+
+TEST(test_crawler_fetches_every_page_once) {
+    ServeLog log;
+    LocalServer server(site(log));
+    CrawlOptions options;
+    options.seeds = {server.url() + "/p/0"};
+    options.maxPages = 100000;
+    options.maxDepth = 100000;
+    options.concurrency = 8;
+    options.maxPerHost = 8;
+
+    std::size_t callbacks = 0;
+    CrawlStats stats = crawl(options, [&](const std::string&, std::size_t, const ParsedPage& page) {
+        ++callbacks;
+        ASSERT(page.title.starts_with("Page "), "Callback gets the parsed page");
+    });
+
+    ASSERT_EQ(static_cast<std::size_t>(kSitePages), stats.pagesFetched, "Every generated page is fetched");
+    ASSERT_EQ(1u, stats.pagesFailed, "The broken link is the only failure");
+    ASSERT_EQ(stats.pagesFetched, callbacks, "One callback per page");
+    ASSERT_EQ(static_cast<std::size_t>(kSitePages + 1), server.requests(), "No URL is requested twice");
+    std::set<std::string> unique(log.paths.begin(), log.paths.end());
+    ASSERT_EQ(log.paths.size(), unique.size(), "Fragments and relative spellings are deduplicated");
+    ASSERT_EQ(static_cast<std::size_t>(kSitePages) * 2, stats.offOriginLinks, "Other-port and mailto links are out of scope");
+    ASSERT_EQ(static_cast<std::size_t>(kSitePages + 1), stats.visitedCount, "Visited set holds each URL once");
+    ASSERT(stats.frontierPeak > 0 && stats.frontierPeakBytes > 0, "Frontier memory is reported");
+    ASSERT(stats.visitedBytes > 0, "Visited-set memory is reported");
+    ASSERT(stats.pagesPerSecond() > 0.0, "Throughput is reported");
+}
+
+TEST(test_crawler_reads_spooled_bodies) {
+    ServeLog log;
+    LocalServer server(site(log));
+    CrawlOptions options;
+    options.seeds = {server.url() + "/p/0"};
+    options.maxPages = 20;
+
+    // Every body goes to a mapped temp file, none stays in HttpResult::body
+    http_set_spool_threshold(1);
+    std::size_t titled = 0;
+    CrawlStats stats = crawl(options, [&](const std::string&, std::size_t, const ParsedPage& page) {
+        if (page.title.starts_with("Page ")) ++titled;
+    });
+    http_set_spool_threshold(0);
+
+    ASSERT_EQ(20u, stats.pagesFetched + stats.pagesFailed, "Links were found in spooled pages");
+    ASSERT(stats.pagesFetched > 1, "Pages beyond the seed were reached");
+    ASSERT_EQ(stats.pagesFetched, titled, "Every spooled page was parsed");
+    ASSERT(stats.bytesFetched > 0, "Spooled bytes are counted");
+}
+
+TEST(test_crawler_respects_depth_and_page_limits) {
+    ServeLog log;
+    LocalServer server(site(log));
+    CrawlOptions options;
+    options.seeds = {server.url() + "/c/0"};
+    options.maxDepth = 5;
+    CrawlStats stats = crawl(options);
+    ASSERT_EQ(6u, stats.pagesFetched, "Depths 0 through 5 are fetched");
+    ASSERT_EQ(6u, server.requests(), "Nothing beyond the depth limit is requested");
+
+    options.seeds = {server.url() + "/p/0"};
+    options.maxDepth = 100000;
+    options.maxPages = 50;
+    stats = crawl(options);
+    ASSERT_EQ(50u, stats.pagesFetched + stats.pagesFailed, "Crawl stops at the page limit");
+    ASSERT_EQ(56u, server.requests(), "No request beyond the page limit");
+}
+
+TEST(test_crawler_politeness_delay) {
+    ServeLog log;
+    LocalServer server(site(log));
+    CrawlOptions options;
+    options.seeds = {server.url() + "/c/0", server.url() + "/c/100"};
+    options.maxDepth = 4;
+    options.concurrency = 8;
+    options.maxPerHost = 1;
+    options.hostDelay = 20ms;
+    CrawlStats stats = crawl(options);
+    ASSERT_EQ(10u, stats.pagesFetched, "Both chains are crawled");
+
+    std::lock_guard lock(log.mutex);
+    for (std::size_t i = 1; i < log.times.size(); ++i) {
+        // Measured at the server, so allow for scheduling jitter on either side
+        ASSERT(log.times[i] - log.times[i - 1] >= 15ms, "Requests to one origin are spaced by the delay");
+    }
+    ASSERT(stats.elapsed >= 180ms, "Ten requests with a 20 ms gap take at least 180 ms");
+}
+
+TEST(test_crawler_writes_text_and_index) {
+    ServeLog log;
+    LocalServer server(site(log));
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "mini-browser-test-crawl";
+    std::filesystem::remove_all(dir);
+
+    CrawlOptions options;
+    options.seeds = {server.url() + "/c/0"};
+    options.maxDepth = 2;
+    options.outputDir = dir.string();
+    CrawlStats stats = crawl(options);
+    ASSERT_EQ(3u, stats.pagesFetched, "Chain of three pages");
+    ASSERT_EQ(3u, count_lines((dir / "index.tsv").string()), "One index line per page");
+
+    std::ifstream index(dir / "index.tsv");
+    std::string url, depth, file;
+    std::getline(index, url, '\t');
+    std::getline(index, depth, '\t');
+    std::getline(index, file);
+    ASSERT_EQ(server.url() + "/c/0", url, "Index starts with the seed");
+    ASSERT_EQ(std::string("0"), depth, "Seed is at depth 0");
+    std::ifstream text(dir / file);
+    std::string first, title;
+    std::getline(text, first);
+    std::getline(text, title);
+    ASSERT_EQ(url, first, "Text file starts with the URL");
+    ASSERT_EQ(std::string("Chain 0"), title, "Then the title");
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,110 @@
+#include "test.h"
+#include "core/executor.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+TEST(test_executor_runs_every_task) {
+    std::atomic<int> count {0};
+    {
+        Executor executor(4);
+        auto answer = executor.submit([] { return 42; });
+        ASSERT_EQ(42, answer.get(), "submit returns the result");
+        for (int i = 0; i < 10000; ++i) executor.post([&] { ++count; });
+    }
+    ASSERT_EQ(10000, count.load(), "Destructor finishes queued tasks");
+}
+
+TEST(test_executor_priorities) {
+    Executor executor(1);
+    std::atomic<bool> release {false};
+    executor.post([&] { while (!release) std::this_thread::sleep_for(1ms); });   // hold the only worker
+
+    std::mutex mutex;
+    std::vector<std::string> order;
+    auto record = [&](const char* name) {
+        return [&, name] {
+            std::lock_guard lock(mutex);
+            order.push_back(name);
+        };
+    };
+    executor.post(record("background"), TaskPriority::Background);
+    executor.post(record("normal"), TaskPriority::Normal);
+    executor.post(record("interactive"), TaskPriority::Interactive);
+    release = true;
+    executor.submit([] {}, TaskPriority::Background).get();
+
+    ASSERT_EQ(3u, order.size(), "All ran");
+    ASSERT_EQ(std::string("interactive"), order[0], "Interactive first");
+    ASSERT_EQ(std::string("normal"), order[1], "Then normal");
+    ASSERT_EQ(std::string("background"), order[2], "Background last");
+}
+
+TEST(test_executor_work_stealing) {
+    Executor executor(4);
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    // One task fans out onto its own deque; idle workers have to steal to help
+    executor.submit([&] {
+        std::vector<std::future<void>> parts;
+        for (int i = 0; i < 64; ++i) {
+            parts.push_back(executor.submit([&] {
+                std::this_thread::sleep_for(1ms);
+                std::lock_guard lock(mutex);
+                threads.insert(std::this_thread::get_id());
+            }));
+        }
+        for (auto& part : parts) executor.wait(part);
+    }).get();
+    ASSERT(threads.size() > 1, "Subtasks ran on several workers");
+    ASSERT(executor.stats().stolen > 0, "Steals are counted");
+}
+
+TEST(test_executor_nested_wait_single_worker) {
+    Executor executor(1);
+    // The only worker waits on tasks queued behind it: wait() runs them itself
+    int total = executor.submit([&] {
+        std::vector<std::future<int>> parts;
+        for (int i = 1; i <= 10; ++i) parts.push_back(executor.submit([i] { return i; }));
+        int sum = 0;
+        for (auto& part : parts) sum += executor.wait(part);
+        return sum;
+    }).get();
+    ASSERT_EQ(55, total, "Nested fork/join completes on one worker");
+}
+
+TEST(test_executor_continuations) {
+    Executor executor(2);
+    std::promise<std::string> done;
+    executor.then([] { return std::string("parsed"); },
+                  [&](std::string r) { done.set_value(r + " then laid out"); });
+    ASSERT_EQ(std::string("parsed then laid out"), done.get_future().get(), "Continuation receives the result");
+
+    std::promise<void> voidDone;
+    executor.then([] {}, [&] { voidDone.set_value(); });
+    ASSERT(voidDone.get_future().wait_for(2s) == std::future_status::ready, "Void tasks chain too");
+}
+
+TEST(test_main_thread_queue) {
+    Executor executor(2);
+    auto main = std::make_shared<MainThreadQueue>();
+    std::thread::id ranOn;
+    int result = 0;
+    executor.then([] { return 7; }, main, [&](int r) {
+        ranOn = std::this_thread::get_id();
+        result = r;
+    });
+    auto deadline = std::chrono::steady_clock::now() + 2s;
+    while (main->pending() == 0 && std::chrono::steady_clock::now() < deadline) std::this_thread::sleep_for(1ms);
+    ASSERT_EQ(0, result, "Continuation waits for the owning thread");
+    ASSERT_EQ(1u, main->drain(), "One task drained");
+    ASSERT_EQ(7, result, "Continuation ran with the result");
+    ASSERT(ranOn == std::this_thread::get_id(), "Continuation ran on the draining thread");
+    ASSERT_EQ(0u, main->drain(), "Nothing left");
+}
@@ -0,0 +1,120 @@
+#include "test.h"
+#include "local_server.h"
+#include "core/connection_pool.h"
+#include "core/curl_session.h"
+#include "core/http_client.h"
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Cancellation must land within one poll interval; the rest is scheduling slack
+constexpr auto kCancelDeadline = CurlSession::kPollInterval + 150ms;
+
+LocalServer::Response big_page(const LocalServer::Request&) {
+    return {200, std::string(1 << 20, 'x')};
+}
+
+}
+
+TEST(test_cancel_stops_body_transfer) {
+    LocalServer server(big_page);
+    server.setThrottle(4096, 10ms);   // ~400 KB/s: the full page would take over 2 s
+
+    std::atomic<bool> cancel {false};
+    auto fetch = std::async(std::launch::async, [&] { return http_get(server.url() + "/big", 10000, nullptr, &cancel); });
+
+    while (server.bytesSent() < 32 * 1024) std::this_thread::sleep_for(5ms);
+    auto cancelledAt = Clock::now();
+    cancel = true;
+    HttpResult r = fetch.get();
+    auto took = Clock::now() - cancelledAt;
+
+    ASSERT(took < kCancelDeadline, "http_get returns within one poll interval of cancel");
+    ASSERT(r.cancelled, "Result is marked cancelled");
+    ASSERT_EQ(std::string("cancelled"), r.error, "Error says why");
+    ASSERT(r.body.size() < (1u << 20), "Body is incomplete");
+
+    // The connection is closed, so the server stops sending
+    std::this_thread::sleep_for(100ms);
+    std::size_t sent = server.bytesSent();
+    std::this_thread::sleep_for(300ms);
+    ASSERT_EQ(sent, server.bytesSent(), "No bytes flow after cancel");
+    ASSERT(sent < (1u << 20), "The page was never fully sent");
+}
+
+TEST(test_cancel_during_connect) {
+    LocalServer server(big_page, 2000ms);
+
+    std::atomic<bool> cancel {false};
+    auto fetch = std::async(std::launch::async, [&] { return http_get(server.url() + "/", 10000, nullptr, &cancel); });
+
+    std::this_thread::sleep_for(100ms);
+    auto cancelledAt = Clock::now();
+    cancel = true;
+    HttpResult r = fetch.get();
+
+    ASSERT(Clock::now() - cancelledAt < kCancelDeadline, "Cancel does not wait for the first byte");
+    ASSERT(r.cancelled, "Result is marked cancelled");
+    ASSERT_EQ(0u, server.bytesSent(), "Nothing was sent");
+}
+
+TEST(test_cancelled_before_start) {
+    LocalServer server(big_page);
+    std::atomic<bool> cancel {true};
+    HttpResult r = http_get(server.url() + "/", 10000, nullptr, &cancel);
+    ASSERT(r.cancelled, "Already-cancelled fetch does nothing");
+    ASSERT_EQ(0u, server.connections(), "No connection was opened");
+}
+
+TEST(test_cancelled_fetch_is_not_pooled) {
+    LocalServer server(big_page);
+    server.setThrottle(4096, 10ms);
+    ConnectionPool pool;
+
+    std::atomic<bool> cancel {false};
+    auto fetch = std::async(std::launch::async, [&] { return http_get(server.url() + "/big", 10000, &pool, &cancel); });
+    while (server.bytesSent() == 0) std::this_thread::sleep_for(5ms);
+    cancel = true;
+    HttpResult r = fetch.get();
+
+    ASSERT(r.cancelled, "Result is marked cancelled");
+    ASSERT_EQ(0u, pool.idleCount(), "A half-read connection is not reused");
+}
+
+TEST(test_cancel_while_warmup_pending) {
+    LocalServer server(big_page, 3000ms);
+    ConnectionPool pool;
+    pool.preconnect(server.url() + "/");
+    while (server.connections() == 0) std::this_thread::sleep_for(5ms);
+
+    // The fetch waits on the running warm-up for the same origin
+    std::atomic<bool> cancel {false};
+    auto fetch = std::async(std::launch::async, [&] { return http_get(server.url() + "/", 10000, &pool, &cancel); });
+    std::this_thread::sleep_for(20ms);
+    auto cancelledAt = Clock::now();
+    cancel = true;
+    HttpResult r = fetch.get();
+
+    ASSERT(Clock::now() - cancelledAt < kCancelDeadline, "Cancel ends the wait for the warm-up");
+    ASSERT(r.cancelled, "Result is marked cancelled");
+    ASSERT_EQ(1u, server.connections(), "No connection of its own was opened");
+}
+
+TEST(test_pool_shutdown_cancels_warmup) {
+    LocalServer server(big_page, 3000ms);
+    auto start = Clock::now();
+    {
+        ConnectionPool pool;
+        pool.preconnect(server.url() + "/");
+        while (server.connections() == 0) std::this_thread::sleep_for(5ms);
+    }
+    ASSERT(Clock::now() - start < 1000ms, "Destroying the pool does not wait out the handshake");
+}
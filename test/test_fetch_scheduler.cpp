@@ -0,0 +1,169 @@
+#include "test.h"
+#include "local_server.h"
+#include "core/fetch_scheduler.h"
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Records the order requests reach the servers (handlers run on server threads)
+struct ServeLog {
+    std::mutex mutex;
+    std::vector<std::string> paths;
+
+    LocalServer::Handler handler() {
+        return [this](const LocalServer::Request& req) {
+            std::lock_guard lock(mutex);
+            paths.push_back(req.path);
+            return LocalServer::Response{200, "<p>" + req.path + "</p>"};
+        };
+    }
+};
+
+LocalServer::Response ok(const LocalServer::Request&) {
+    return {200, "<p>ok</p>"};
+}
+
+// Occupies a single-slot scheduler until the slow server answers
+std::future<HttpResult> block(FetchScheduler& scheduler, const LocalServer& slow) {
+    auto blocker = scheduler.submit(slow.url() + "/blocker", FetchPriority::Background);
+    while (slow.connections() == 0) std::this_thread::sleep_for(1ms);
+    return blocker;
+}
+
+}
+
+TEST(test_scheduler_navigation_jumps_queue) {
+    LocalServer slow(ok, 150ms);
+    ServeLog log;
+    LocalServer server(log.handler());
+    FetchScheduler scheduler(1, 1);
+
+    auto blocker = block(scheduler, slow);
+    std::vector<std::future<HttpResult>> results;
+    for (int i = 0; i < 3; ++i) results.push_back(scheduler.submit(server.url() + "/bg" + std::to_string(i), FetchPriority::Background));
+    results.push_back(scheduler.submit(server.url() + "/visible", FetchPriority::Visible));
+    results.push_back(scheduler.submit(server.url() + "/nav", FetchPriority::Navigation));
+    for (auto& r : results) ASSERT(r.get().error.empty(), "Every fetch succeeds");
+
+    std::vector<std::string> expected = {"/nav", "/visible", "/bg0", "/bg1", "/bg2"};
+    ASSERT(log.paths == expected, "Served strictly by priority class, FIFO within a class");
+    ASSERT(blocker.get().error.empty(), "Running transfer was not interrupted");
+}
+
+TEST(test_scheduler_round_robin_across_hosts) {
+    LocalServer slow(ok, 150ms);
+    ServeLog log;
+    LocalServer a(log.handler());
+    LocalServer b(log.handler());
+    FetchScheduler scheduler(1, 1);
+
+    auto blocker = block(scheduler, slow);
+    std::vector<std::future<HttpResult>> results;
+    for (int i = 0; i < 3; ++i) results.push_back(scheduler.submit(a.url() + "/a" + std::to_string(i), FetchPriority::Background));
+    for (int i = 0; i < 3; ++i) results.push_back(scheduler.submit(b.url() + "/b" + std::to_string(i), FetchPriority::Background));
+    for (auto& r : results) r.get();
+
+    std::vector<std::string> expected = {"/a0", "/b0", "/a1", "/b1", "/a2", "/b2"};
+    ASSERT(log.paths == expected, "Hosts take turns instead of draining the first one");
+}
+
+TEST(test_scheduler_respects_limits) {
+    LocalServer a(ok, 10ms);
+    LocalServer b(ok, 10ms);
+    FetchScheduler scheduler(3, 2);
+
+    std::vector<std::future<HttpResult>> results;
+    for (int i = 0; i < 30; ++i) {
+        results.push_back(scheduler.submit(a.url() + "/", FetchPriority::Background));
+        results.push_back(scheduler.submit(b.url() + "/", FetchPriority::Visible));
+    }
+
+    std::size_t maxActive = 0, maxPerHost = 0;
+    for (auto& r : results) {
+        while (r.wait_for(1ms) != std::future_status::ready) {
+            FetchMetrics m = scheduler.metrics();
+            maxActive = std::max(maxActive, m.active);
+            for (const auto& [host, count] : m.activePerHost) maxPerHost = std::max(maxPerHost, count);
+        }
+        ASSERT(r.get().error.empty(), "Fetch succeeds");
+    }
+    ASSERT(maxActive <= 3, "Global limit holds");
+    ASSERT(maxPerHost <= 2, "Per-host limit holds");
+    ASSERT(maxActive >= 2, "Work ran concurrently");
+
+    FetchMetrics m = scheduler.metrics();
+    ASSERT_EQ(30u, m[FetchPriority::Background].started, "Background fetches counted");
+    ASSERT_EQ(30u, m[FetchPriority::Visible].started, "Visible fetches counted");
+    ASSERT_EQ(0u, m[FetchPriority::Visible].queued, "Queues drained");
+    ASSERT_EQ(0u, m.active, "Nothing in flight");
+}
+
+TEST(test_scheduler_cancel_queued) {
+    LocalServer slow(ok, 150ms);
+    LocalServer server(ok);
+    FetchScheduler scheduler(1, 1);
+
+    auto blocker = block(scheduler, slow);
+    auto cancel = std::make_shared<std::atomic<bool>>(false);
+    auto queued = scheduler.submit(server.url() + "/", FetchPriority::Background, cancel);
+    *cancel = true;
+    HttpResult r = queued.get();
+    ASSERT(r.cancelled, "Queued fetch completes as cancelled");
+    ASSERT_EQ(0u, server.connections(), "Cancelled fetch never connected");
+    blocker.get();
+}
+
+TEST(test_scheduler_shutdown_cancels_everything) {
+    LocalServer slow(ok, 2000ms);
+    std::future<HttpResult> running, queued;
+    auto start = Clock::now();
+    {
+        FetchScheduler scheduler(1, 1);
+        running = block(scheduler, slow);
+        queued = scheduler.submit(slow.url() + "/later", FetchPriority::Navigation);
+    }
+    ASSERT(Clock::now() - start < 1000ms, "Shutdown does not wait for slow transfers");
+    ASSERT(running.get().cancelled, "Running fetch is cancelled");
+    ASSERT(queued.get().cancelled, "Queued fetch is cancelled");
+}
+
+TEST(test_scheduler_navigation_latency_under_load) {
+    // 1,000 background fetches over four hosts; each new connection costs 5 ms
+    std::vector<std::unique_ptr<LocalServer>> hosts;
+    for (int i = 0; i < 4; ++i) hosts.push_back(std::make_unique<LocalServer>(ok, 5ms));
+    LocalServer page(ok, 5ms);
+    FetchScheduler scheduler(8, 2);
+
+    std::vector<std::future<HttpResult>> background;
+    for (int i = 0; i < 1000; ++i) {
+        background.push_back(scheduler.submit(hosts[i % 4]->url() + "/" + std::to_string(i), FetchPriority::Background));
+    }
+    std::this_thread::sleep_for(20ms);
+
+    auto clicked = Clock::now();
+    HttpResult nav = scheduler.submit(page.url() + "/", FetchPriority::Navigation).get();
+    auto latency = Clock::now() - clicked;
+    std::size_t stillQueued = scheduler.metrics()[FetchPriority::Background].queued;
+
+    for (auto& r : background) ASSERT(r.get().error.empty(), "Background fetch succeeds");
+    FetchMetrics m = scheduler.metrics();
+
+    ASSERT(nav.error.empty(), "Navigation succeeds");
+    ASSERT(stillQueued > 500, "Navigation finished while most background work was still queued");
+    ASSERT(latency < 250ms, "Navigation latency stays low under load");
+    ASSERT(m[FetchPriority::Navigation].maxWait < 100ms, "Navigation barely waits in the queue");
+    ASSERT(m[FetchPriority::Background].meanWaitMs() > m[FetchPriority::Navigation].meanWaitMs(),
+           "Background work absorbs the queueing delay");
+    ASSERT_EQ(1000u, m[FetchPriority::Background].started, "All background fetches ran");
+}
@@ -63,3 +63,14 @@ TEST(test_empty_html) {
     ASSERT(page.text.empty(), "Empty HTML should have empty text");
     ASSERT(page.links.empty(), "Empty HTML should have no links");
 }
+
+TEST(test_link_positions_match_text) {
+    std::string html = "<p>same <a href=\"/a\">same</a></p><p>x <a href=\"/b\">same</a></p>";
+    ParsedPage page = parse_html_basic(html);
+    ASSERT_EQ(2u, page.links.size(), "Should extract 2 links");
+    for (const auto& link : page.links) {
+        ASSERT_EQ(link.text, page.text.substr(link.start_pos, link.end_pos - link.start_pos), "Span covers link text");
+    }
+    ASSERT(page.links[0].start_pos != page.links[1].start_pos, "Repeated link text gets distinct spans");
+    ASSERT(page.links[0].start_pos > 0, "Link span skips the earlier plain occurrence");
+}
@@ -0,0 +1,146 @@
+#include "test.h"
+#include "local_server.h"
+#include "core/http_archive.h"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::string temp_path(const char* name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+LocalServer::Response pages(const LocalServer::Request& req) {
+    if (req.path == "/missing") return {404, "no such page"};
+    if (req.path == "/style.css") return {200, "p { color: red }", "text/css"};
+    return {200, "<title>" + req.path + "</title><p>Served " + req.path + "</p>"};
+}
+
+
+}
+
+TEST(test_archive_record_and_replay_offline) {
+    std::string base;
+    const std::string path = temp_path("mini-browser-test-archive.mbha");
+    {
+        LocalServer server(pages);
+        base = server.url();
+        http_record_start();
+        HttpResult live = http_get(base + "/index.html#top");
+        ASSERT_EQ(200L, live.status, "Live fetch succeeds");
+        http_get(base + "/missing");
+        http_get(base + "/style.css");
+        ASSERT_EQ(3u, http_recorded_count(), "Every request is captured");
+        ASSERT(http_record_stop(path), "Archive is written");
+    }
+
+    HttpArchive archive;
+    ASSERT(archive.load(path), "Archive loads");
+    ASSERT_EQ(3u, archive.size(), "Three entries");
+    const ArchiveEntry& first = archive.entries()[0];
+    ASSERT_EQ(base + "/index.html", first.url, "Fragment is not part of the key");
+    ASSERT(first.headers.starts_with("HTTP/1.1 200"), "Response headers are kept");
+    ASSERT(first.headers.find("Content-Length:") != std::string::npos, "All header lines are kept");
+    ASSERT(first.totalUs >= first.waitUs && first.totalUs > 0, "Timing is recorded");
+
+    // The server is gone: only the archive can answer
+    ASSERT(http_replay_start(path, 0.0), "Replay starts");
+    HttpResult page = http_get(base + "/index.html");
+    ASSERT_EQ(200L, page.status, "Status is replayed");
+    ASSERT_EQ(std::string("<title>/index.html</title><p>Served /index.html</p>"), page.body, "Body is replayed");
+    ASSERT_EQ(first.finalUrl, page.url, "Final URL is replayed");
+    ASSERT_EQ(std::string("text/html"), page.content_type, "Content type is replayed");
+    ASSERT_EQ(404L, http_get(base + "/missing").status, "Error statuses are replayed");
+    ASSERT_EQ(std::string("text/css"), http_get(base + "/style.css").content_type, "Every entry is served");
+    ASSERT_EQ(200L, http_get(base + "/index.html#again").status, "A repeated URL keeps being served");
+    HttpResult unknown = http_get(base + "/never-recorded");
+    ASSERT_EQ(std::string("not in archive"), unknown.error, "Unrecorded URLs fail without touching the network");
+    http_replay_stop();
+
+    HttpResult live = http_get(base + "/index.html", 2000);
+    ASSERT(!live.error.empty(), "After replay stops, requests go to the (closed) network again");
+    std::filesystem::remove(path);
+}
+
+TEST(test_archive_replay_timing) {
+    const std::string path = temp_path("mini-browser-test-archive-timing.mbha");
+    std::string url;
+    {
+        LocalServer server(pages);
+        server.setThrottle(32, 10ms);   // ~280 bytes with headers, 32 per 10 ms: about 90 ms
+        url = server.url() + "/slow-page-with-a-long-enough-name-to-need-several-chunks-of-throttled-output";
+        http_record_start();
+        http_get(url);
+        ASSERT(http_record_stop(path), "Archive is written");
+    }
+    HttpArchive archive;
+    ASSERT(archive.load(path), "Archive loads");
+    const auto recorded = std::chrono::microseconds(archive.entries()[0].totalUs);
+    ASSERT(recorded >= 50ms, "Throttled response took a while to record");
+
+    auto timed = [&](double scale) {
+        http_replay_start(path, scale);
+        auto t0 = Clock::now();
+        HttpResult r = http_get(url);
+        auto elapsed = Clock::now() - t0;
+        http_replay_stop();
+        ASSERT_EQ(200L, r.status, "Replayed");
+        return elapsed;
+    };
+    auto original = timed(1.0);
+    ASSERT(original >= recorded - 1ms, "Scale 1 reproduces the recorded duration");
+    ASSERT(original < recorded + 100ms, "and not much more");
+    auto doubled = timed(2.0);
+    ASSERT(doubled >= 2 * recorded - 1ms, "Scale 2 doubles it");
+    auto instant = timed(0.0);
+    ASSERT(instant < 20ms, "Scale 0 answers immediately");
+
+    // A replayed wait still honours the timeout and the cancel flag
+    http_replay_start(path, 100.0);
+    HttpResult timedOut = http_get(url, 50);
+    ASSERT_EQ(std::string("Timeout was reached"), timedOut.error, "Recorded time beyond the timeout fails like curl");
+    std::atomic<bool> cancel {false};
+    std::thread canceller([&] {
+        std::this_thread::sleep_for(30ms);
+        cancel = true;
+    });
+    auto t0 = Clock::now();
+    HttpResult cancelled = http_get(url, 60000, nullptr, &cancel);
+    canceller.join();
+    ASSERT(cancelled.cancelled, "Cancel flag aborts a replayed wait");
+    ASSERT(Clock::now() - t0 < 200ms, "within a poll interval");
+    http_replay_stop();
+    std::filesystem::remove(path);
+}
+
+TEST(test_archive_rejects_damaged_files) {
+    const std::string path = temp_path("mini-browser-test-archive-damaged.mbha");
+    HttpArchive archive;
+    ArchiveEntry entry;
+    entry.url = "http://example.com/";
+    entry.status = 200;
+    entry.body = std::string(1000, 'x');
+    archive.add(entry);
+    ASSERT(archive.save(path), "Archive is written");
+    ASSERT(archive.load(path), "Round trip loads");
+    ASSERT_EQ(std::string(1000, 'x'), archive.entries()[0].body, "Body survives the round trip");
+
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 10);
+    ASSERT(!archive.load(path), "Truncated file is rejected");
+    ASSERT_EQ(0u, archive.size(), "and leaves the archive empty");
+    ASSERT(!http_replay_start(path), "Replay refuses a damaged archive");
+
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << "not an archive at all, just some text";
+    ASSERT(!archive.load(path), "Foreign file is rejected");
+    ASSERT(!archive.load(temp_path("mini-browser-test-no-such-archive.mbha")), "Missing file is rejected");
+    ASSERT(!http_record_stop(path), "Stopping without recording writes nothing");
+    std::filesystem::remove(path);
+}
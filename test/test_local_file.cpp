@@ -0,0 +1,105 @@
+#include "test.h"
+#include "local_server.h"
+#include "core/alloc_tracker.h"
+#include "core/http_client.h"
+#include "core/html_parser.h"
+#include "core/local_file.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace {
+
+std::filesystem::path write_file(const char* name, const std::string& contents) {
+    auto dir = std::filesystem::temp_directory_path() / "mini-browser-test-local";
+    std::filesystem::create_directories(dir);
+    std::ofstream(dir / name, std::ios::binary) << contents;
+    return dir / name;
+}
+
+// About `bytes` of HTML: paragraphs with a link each
+std::string big_page(std::size_t bytes) {
+    std::string html = "<title>Big report</title>";
+    for (int i = 0; html.size() < bytes; ++i) {
+        html += "<p>Row " + std::to_string(i) + " of the generated report <a href=\"row" + std::to_string(i) + ".html\">details</a></p>\n";
+    }
+    return html;
+}
+
+}
+
+TEST(test_local_file_read_and_parsed) {
+    const std::string html = "<title>Local &amp; fast</title><p>Hello from disk <a href=\"next.html\">next</a></p>";
+    auto path = write_file("index.html", html);
+    auto url = Url::fromFilePath(path.string());
+    ASSERT(url.has_value(), "Temp path converts to a file: URL");
+
+    HttpResult r = load_local_file(*url);
+    ASSERT(r.error.empty(), "Loads: " + r.error);
+    ASSERT_EQ(200L, r.status, "Status 200 like a successful fetch");
+    ASSERT_EQ(std::string("text/html"), r.content_type, "Type from the extension");
+    ASSERT_EQ(url->href(), r.url, "Final URL is the file URL");
+    ASSERT(!r.mapped && r.body == html, "Small files are read, not mapped");
+
+    ParsedPage page = parse_html_basic(r.bodyView());
+    resolve_links(page.links, *url);
+    ASSERT_EQ(std::string("Local & fast"), page.title, "Parsed from the file");
+    ASSERT_EQ(1u, page.links.size(), "One link");
+    ASSERT_EQ((path.parent_path() / "next.html").string(), Url::parse(page.links[0].url)->filePath().value_or("<none>"),
+              "Relative links resolve next to the file");
+
+    auto empty = load_local_file(*Url::fromFilePath(write_file("empty.html", "").string()));
+    ASSERT(empty.error.empty() && empty.bodyView().empty(), "Empty files load empty");
+}
+
+TEST(test_local_file_large_is_a_mapped_snapshot) {
+    const std::string html = big_page(9 * 1024 * 1024);
+    auto path = write_file("large.html", html);
+    HttpResult r = load_local_file(*Url::fromFilePath(path.string()));
+    ASSERT(r.error.empty(), "Loads: " + r.error);
+    ASSERT(r.mapped && r.body.empty(), "Large files are mapped, not copied to the heap");
+
+    // The report is regenerated while the page is parsed: shorter, then gone
+    std::filesystem::resize_file(path, 100);
+    std::ofstream(path, std::ios::binary | std::ios::app) << "rewritten";
+    ASSERT(r.bodyView() == html, "The mapping is a snapshot: no SIGBUS, contents unchanged");
+    std::filesystem::remove(path);
+    ASSERT(r.bodyView() == html, "Snapshot outlives the file");
+}
+
+TEST(test_local_file_errors) {
+    auto dir = std::filesystem::temp_directory_path() / "mini-browser-test-local";
+    std::filesystem::create_directories(dir);
+    ASSERT(!load_local_file(*Url::fromFilePath((dir / "missing.html").string())).error.empty(), "Missing file");
+    ASSERT(!load_local_file(*Url::fromFilePath(dir.string())).error.empty(), "Directory");
+    HttpResult remote = load_local_file(*Url::parse("https://example.com/index.html"));
+    ASSERT(!remote.error.empty() && remote.status == 0, "Only local file: URLs load");
+}
+
+TEST(test_large_response_spools_to_mapped_file) {
+    const std::string big = big_page(8 * 1024 * 1024);
+    LocalServer server([&](const LocalServer::Request& req) {
+        return LocalServer::Response{200, req.path == "/small" ? std::string("<p>small</p>") : big};
+    });
+
+    http_set_spool_threshold(1024 * 1024);
+    alloc_reset_peaks();
+    const AllocSnapshot before = alloc_snapshot();
+    HttpResult r = http_get(server.url() + "/big");
+    const AllocSnapshot after = alloc_snapshot();
+    HttpResult small = http_get(server.url() + "/small");
+    http_set_spool_threshold(0);
+
+    ASSERT(r.error.empty(), "Spooled fetch succeeds: " + r.error);
+    ASSERT(r.mapped && r.body.empty(), "Body above the threshold lives in a mapped temp file");
+    ASSERT(r.bodyView() == big, "Spooled body is complete");
+    ASSERT(!small.mapped && small.body == "<p>small</p>", "Small bodies stay in memory");
+
+    // The heap only ever held up to the threshold (plus one string growth step), never the whole body
+    const std::uint64_t fetchPeak = after[AllocPhase::Fetch].peakLiveBytes - before[AllocPhase::Fetch].liveBytes;
+    ASSERT(fetchPeak < 3 * 1024 * 1024, "Fetch heap stayed near the threshold, peaked at " + std::to_string(fetchPeak));
+
+    ParsedPage page = parse_html_basic(r.bodyView());
+    ASSERT_EQ(std::string("Big report"), page.title, "Parsed from the spool mapping");
+    ASSERT(page.links.size() > 10000, "Whole document parsed");
+}
@@ -0,0 +1,260 @@
+#include "test.h"
+#include "local_server.h"
+#include "core/http_client.h"
+#include "core/page_daemon.h"
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+std::string socket_path(const char* name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+LocalServer::Response pages(const LocalServer::Request& req) {
+    if (req.path == "/missing") return {404, "no such page"};
+    if (req.path == "/big") {
+        std::string body = "<title>Big</title>";
+        for (int i = 0; i < 4000; ++i) body += "<p>Paragraph " + std::to_string(i) + " <a href=\"/p" + std::to_string(i) + "\">next</a></p>";
+        return {200, body};
+    }
+    return {200, "<title>" + req.path + "</title><p>Served " + req.path + " <a href=\"../up\">up</a></p>"};
+}
+
+}
+
+TEST(test_daemon_fetch_and_cache_hit) {
+    LocalServer server(pages);
+    const std::string path = socket_path("mini-browser-test-daemon-hit.sock");
+    PageDaemon daemon;
+    ASSERT(daemon.start(path), "Daemon starts");
+
+    PageClient a;
+    ASSERT(a.connect(path), "Client connects");
+    DaemonPage first = a.fetch(server.url() + "/dir/page.html");
+    ASSERT(first.response.error.empty(), "Fetch succeeds");
+    ASSERT_EQ(200L, first.response.status, "Status is forwarded");
+    ASSERT_EQ(std::string("/dir/page.html"), first.page.title, "Page arrives parsed");
+    ASSERT(first.page.text.find("Served /dir/page.html") != std::string::npos, "Text arrives");
+    ASSERT_EQ(1u, first.page.links.size(), "Links arrive");
+    ASSERT_EQ(server.url() + "/up", first.page.links[0].url, "Links are resolved against the final URL");
+    ASSERT(!first.cached, "First request is a miss");
+
+    // A second viewer process asking for the same page (with a fragment) costs no upstream request
+    PageClient b;
+    ASSERT(b.connect(path), "Second client connects");
+    DaemonPage second = b.fetch(server.url() + "/dir/page.html#section");
+    ASSERT(second.cached, "Second request is a hit");
+    ASSERT_EQ(first.page.text, second.page.text, "Hit serves the same page");
+    ASSERT_EQ(1u, server.requests(), "Only one upstream request");
+
+    PageDaemonStats stats = daemon.stats();
+    ASSERT_EQ(2u, stats.requests, "Both requests counted");
+    ASSERT_EQ(1u, stats.hits, "One hit");
+    ASSERT_EQ(1u, stats.fetches, "One fetch");
+    ASSERT_EQ(2u, stats.clients, "Two clients");
+    daemon.stop();
+    ASSERT(!std::filesystem::exists(path), "Socket file is removed on stop");
+}
+
+TEST(test_daemon_parses_spooled_bodies) {
+    LocalServer server(pages);
+    const std::string path = socket_path("mini-browser-test-daemon-spool.sock");
+    PageDaemon daemon;
+    ASSERT(daemon.start(path), "Daemon starts");
+
+    http_set_spool_threshold(1);
+    PageClient client;
+    ASSERT(client.connect(path), "Client connects");
+    DaemonPage r = client.fetch(server.url() + "/big");
+    http_set_spool_threshold(0);
+
+    ASSERT(r.response.error.empty(), "Fetch succeeds");
+    ASSERT_EQ(std::string("Big"), r.page.title, "A spooled body is parsed, not read as empty");
+    ASSERT_EQ(4000u, r.page.links.size(), "All of it");
+}
+
+TEST(test_daemon_large_page_through_shared_memory) {
+    LocalServer server(pages);
+    const std::string path = socket_path("mini-browser-test-daemon-shm.sock");
+    PageDaemon daemon(PageDaemonOptions{.sharedMemoryThreshold = 16u << 10});
+    ASSERT(daemon.start(path), "Daemon starts");
+
+    PageClient client;
+    ASSERT(client.connect(path), "Client connects");
+    DaemonPage page = client.fetch(server.url() + "/big");
+    ASSERT(page.response.error.empty(), "Fetch succeeds");
+    ASSERT(page.sharedMemory, "Large page goes through shared memory");
+    ASSERT_EQ(4000u, page.page.links.size(), "Every link arrives");
+    ASSERT_EQ(server.url() + "/p3999", page.page.links.back().url, "Last link is intact");
+    ASSERT_EQ(std::string("next"), page.page.text.substr(page.page.links[7].start_pos, 4), "Link offsets point into the text");
+
+    DaemonPage again = client.fetch(server.url() + "/big");
+    ASSERT(again.cached && again.sharedMemory, "Cached large page is shared again");
+    ASSERT_EQ(page.page.text, again.page.text, "Same content both times");
+
+    DaemonPage small = client.fetch(server.url() + "/small");
+    ASSERT(!small.sharedMemory, "Small pages travel inline");
+}
+
+TEST(test_daemon_concurrent_clients) {
+    LocalServer server(pages);
+    const std::string path = socket_path("mini-browser-test-daemon-many.sock");
+    PageDaemon daemon;
+    ASSERT(daemon.start(path), "Daemon starts");
+
+    constexpr int kClients = 16;
+    constexpr int kRequests = 200;
+    std::atomic<int> correct {0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kClients; ++t) {
+        threads.emplace_back([&, t] {
+            PageClient client;
+            if (!client.connect(path)) return;
+            for (int i = 0; i < kRequests; ++i) {
+                const std::string page = "/page" + std::to_string((t + i) % 20);
+                DaemonPage r = client.fetch(server.url() + page);
+                if (r.response.status == 200 && r.page.title == page) ++correct;
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    ASSERT_EQ(kClients * kRequests, correct.load(), "Every client gets its own page back");
+    ASSERT(server.requests() <= 20u, "Each distinct page is fetched once");
+    ASSERT_EQ(static_cast<std::size_t>(kClients * kRequests), daemon.stats().requests, "All requests counted");
+}
+
+TEST(test_daemon_coalesces_concurrent_misses) {
+    LocalServer server(pages);
+    server.setThrottle(16, 10ms);   // slow enough that every client asks while the fetch is in flight
+    const std::string path = socket_path("mini-browser-test-daemon-coalesce.sock");
+    PageDaemon daemon;
+    ASSERT(daemon.start(path), "Daemon starts");
+
+    std::atomic<int> ok {0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&] {
+            PageClient client;
+            if (client.connect(path) && client.fetch(server.url() + "/shared").response.status == 200) ++ok;
+        });
+    }
+    for (auto& t : threads) t.join();
+    ASSERT_EQ(8, ok.load(), "Every waiter gets the page");
+    ASSERT_EQ(1u, server.requests(), "One upstream request serves all of them");
+    PageDaemonStats stats = daemon.stats();
+    ASSERT_EQ(stats.requests, stats.fetches + stats.coalesced + stats.hits, "Each request is a fetch, a join or a hit");
+}
+
+TEST(test_daemon_forwards_errors) {
+    std::string deadUrl;
+    {
+        LocalServer gone(pages);
+        deadUrl = gone.url() + "/";
+    }
+    LocalServer server(pages);
+    const std::string path = socket_path("mini-browser-test-daemon-errors.sock");
+    PageDaemon daemon(PageDaemonOptions{.timeoutMs = 2000});
+    ASSERT(daemon.start(path), "Daemon starts");
+
+    PageClient client;
+    ASSERT(client.connect(path), "Client connects");
+    ASSERT_EQ(404L, client.fetch(server.url() + "/missing").response.status, "Error status is forwarded");
+    ASSERT(!client.fetch(server.url() + "/missing").cached, "Error pages are not cached");
+    ASSERT_EQ(2u, server.requests(), "Both 404 requests went upstream");
+    ASSERT(!client.fetch(deadUrl).response.error.empty(), "Connection errors are forwarded");
+    ASSERT_EQ(std::string("invalid URL"), client.fetch("not a url").response.error, "Invalid URLs are rejected");
+    ASSERT_EQ(200L, client.fetch(server.url() + "/after").response.status, "Connection stays usable");
+}
+
+TEST(test_daemon_unreachable) {
+    PageClient client;
+    ASSERT(!client.connect(socket_path("mini-browser-test-daemon-none.sock")), "Connect fails with no daemon");
+    DaemonPage r = client.fetch("http://example.com/");
+    ASSERT(!r.response.error.empty(), "Fetch without a daemon fails cleanly");
+
+    // A daemon that goes away mid-session is reported, not hung on
+    LocalServer server(pages);
+    const std::string path = socket_path("mini-browser-test-daemon-restart.sock");
+    auto daemon = std::make_unique<PageDaemon>();
+    ASSERT(daemon->start(path), "Daemon starts");
+    ASSERT(client.connect(path), "Client connects");
+    ASSERT_EQ(200L, client.fetch(server.url() + "/a").response.status, "First fetch works");
+    daemon.reset();
+    ASSERT(!client.fetch(server.url() + "/a", 1000).response.error.empty(), "Stopped daemon is an error");
+}
+
+TEST(test_daemon_socket_ownership) {
+    LocalServer server(pages);
+    const std::string path = socket_path("mini-browser-test-daemon-owner.sock");
+    std::filesystem::remove(path);
+
+    // A socket file nobody listens on any more is replaced
+    {
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr {};
+        addr.sun_family = AF_UNIX;
+        std::strcpy(addr.sun_path, path.c_str());
+        ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        ::close(fd);
+    }
+    PageDaemon first;
+    ASSERT(first.start(path), "Stale socket file is replaced");
+    struct stat st;
+    ASSERT(::stat(path.c_str(), &st) == 0 && (st.st_mode & 077) == 0, "Socket is owner-only");
+
+    PageDaemon second;
+    ASSERT(!second.start(path), "A live daemon's socket is not taken over");
+    PageClient client;
+    ASSERT(client.connect(path), "The first daemon still owns the socket");
+    ASSERT_EQ(200L, client.fetch(server.url() + "/a").response.status, "And still serves");
+}
+
+TEST(test_daemon_cancel) {
+    LocalServer server(pages);
+    server.setThrottle(8, 50ms);
+    const std::string path = socket_path("mini-browser-test-daemon-cancel.sock");
+    PageDaemon daemon;
+    ASSERT(daemon.start(path), "Daemon starts");
+
+    PageClient client;
+    ASSERT(client.connect(path), "Client connects");
+    std::atomic<bool> cancel {false};
+    std::thread canceller([&] {
+        std::this_thread::sleep_for(100ms);
+        cancel = true;
+    });
+    auto start = std::chrono::steady_clock::now();
+    DaemonPage r = client.fetch(server.url() + "/slow", 10000, &cancel);
+    canceller.join();
+    ASSERT(r.response.cancelled, "Request is cancelled");
+    ASSERT(std::chrono::steady_clock::now() - start < 1s, "Cancel returns promptly");
+    ASSERT(!client.isConnected(), "Cancelled connection is dropped");
+}
+
+TEST(test_daemon_cache_eviction) {
+    LocalServer server(pages);
+    const std::string path = socket_path("mini-browser-test-daemon-lru.sock");
+    PageDaemon daemon(PageDaemonOptions{.maxCacheBytes = 2048});
+    ASSERT(daemon.start(path), "Daemon starts");
+
+    PageClient client;
+    ASSERT(client.connect(path), "Client connects");
+    for (int i = 0; i < 20; ++i) client.fetch(server.url() + "/page" + std::to_string(i));
+    PageDaemonStats stats = daemon.stats();
+    ASSERT(stats.cacheBytes <= 2048u, "Cache stays within its byte limit");
+    ASSERT(stats.cacheEntries > 0 && stats.cacheEntries < 20u, "Old entries are evicted");
+    ASSERT(client.fetch(server.url() + "/page19").cached, "Most recent page is still cached");
+    ASSERT(!client.fetch(server.url() + "/page0").cached, "Least recent page was evicted");
+}
@@ -0,0 +1,66 @@
+#include "test.h"
+#include "core/html_parser.h"
+#include <random>
+#include <string>
+
+namespace {
+
+ParseOptions chunked(std::size_t threads) {
+    ParseOptions options;
+    options.threads = threads;
+    options.min_chunk_size = 64; // force many small chunks
+    return options;
+}
+
+void assert_same(const ParsedPage& serial, const ParsedPage& parallel) {
+    ASSERT_EQ(serial.title, parallel.title, "Titles match");
+    ASSERT_EQ(serial.text, parallel.text, "Texts match");
+    ASSERT_EQ(serial.links.size(), parallel.links.size(), "Link counts match");
+    for (std::size_t i = 0; i < serial.links.size(); ++i) {
+        ASSERT_EQ(serial.links[i].url, parallel.links[i].url, "Link URLs match");
+        ASSERT_EQ(serial.links[i].text, parallel.links[i].text, "Link texts match");
+        ASSERT_EQ(serial.links[i].start_pos, parallel.links[i].start_pos, "Link starts match");
+        ASSERT_EQ(serial.links[i].end_pos, parallel.links[i].end_pos, "Link ends match");
+    }
+}
+
+}
+
+TEST(test_parallel_matches_serial_random) {
+    const char* frags[] = {
+        "<p>", "</p>", "<br>", "text ", "  ", "\n", "\n\n", "&amp;", "&lt;", "\t",
+        "<a href=\"/x\">", "<a href='y'>", "<a href=z>", "</a>", "link", "word",
+        "<script>var a='<p>\n';</script>", "<style>\nx{}\n</style>", "<!-- a > b\n -->",
+        "<div class=c>", "</div>", "<b>", "</b>", "<title>T</title>", "\r\n", "<a href=\"q\n>\">"
+    };
+    std::mt19937 rng(7);
+    for (int it = 0; it < 300; ++it) {
+        std::string html;
+        std::size_t n = 50 + rng() % 400;
+        for (std::size_t k = 0; k < n; ++k) html += frags[rng() % (sizeof(frags) / sizeof(*frags))];
+        ParsedPage serial = parse_html_basic(html);
+        assert_same(serial, parse_html_basic(html, chunked(4)));
+        assert_same(serial, parse_html_basic(html, chunked(0)));
+    }
+}
+
+TEST(test_parallel_large_document) {
+    std::string html = "<html><head><title>Report</title></head><body>\n";
+    for (int i = 0; i < 20000; ++i) {
+        html += "<p>Row " + std::to_string(i) + " <a href=\"/r/" + std::to_string(i) + "\">details</a></p>\n";
+        if (i % 500 == 0) html += "<script>\nlet x = '<a href=\"no\">';\n</script>\n";
+    }
+    html += "</body></html>";
+    ParseOptions options;
+    options.threads = 8;
+    options.min_chunk_size = 4096;
+    ParsedPage serial = parse_html_basic(html);
+    ParsedPage parallel = parse_html_basic(html, options);
+    ASSERT_EQ(20000u, serial.links.size(), "Every row link is extracted");
+    assert_same(serial, parallel);
+}
+
+TEST(test_comments_are_skipped) {
+    ParsedPage page = parse_html_basic("<p>before<!-- hidden > still hidden --> after</p>");
+    ASSERT_EQ(std::string("before after"), page.text, "Comment body is removed");
+}
@@ -0,0 +1,100 @@
+#include "test.h"
+#include "core/html_parser.h"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <string>
+
+// Adversarial inputs that used to trigger super-linear behaviour. Each generator
+// is run at 1x/10x/100x size; parsing time must grow roughly linearly.
+
+namespace {
+
+std::string repeat(const std::string& unit, std::size_t times) {
+    std::string s;
+    s.reserve(unit.size() * times);
+    for (std::size_t i = 0; i < times; ++i) s += unit;
+    return s;
+}
+
+double best_parse_ms(const std::string& html) {
+    double best = 1e300;
+    for (int run = 0; run < 3; ++run) {
+        auto t0 = std::chrono::steady_clock::now();
+        ParsedPage page = parse_html_basic(html);
+        auto t1 = std::chrono::steady_clock::now();
+        ASSERT(page.text.size() <= html.size(), "Text cannot be longer than input");
+        best = std::min(best, std::chrono::duration<double, std::milli>(t1 - t0).count());
+    }
+    return best;
+}
+
+// Quadratic growth would give a ratio of ~100 per 10x step; allow generous noise
+// (cache effects at the larger sizes) while still catching it.
+void check_linear(const char* name, const std::function<std::string(std::size_t)>& gen) {
+    const std::size_t base = 2000;
+    double t1 = best_parse_ms(gen(base));
+    double t10 = best_parse_ms(gen(base * 10));
+    double t100 = best_parse_ms(gen(base * 100));
+    // Floor the small sizes so timer resolution does not dominate the ratio
+    double step1 = t10 / std::max(t1, 0.05);
+    double step2 = t100 / std::max(t10, 0.5);
+    std::cout << "  " << name << ": " << t1 << " / " << t10 << " / " << t100 << " ms\n";
+    ASSERT(step1 < 30.0, std::string(name) + " grows super-linearly (1x -> 10x)");
+    ASSERT(step2 < 30.0, std::string(name) + " grows super-linearly (10x -> 100x)");
+}
+
+}
+
+TEST(test_linear_anchors_without_href) {
+    check_linear("anchors without href", [](std::size_t n) {
+        return repeat("<a name=x>text</a> ", n);
+    });
+}
+
+TEST(test_linear_unclosed_anchors) {
+    check_linear("unclosed anchors", [](std::size_t n) {
+        return repeat("<a href=\"/u\">text ", n);
+    });
+}
+
+TEST(test_linear_unterminated_quotes) {
+    check_linear("unterminated href quotes", [](std::size_t n) {
+        return repeat("<a href='x>t ", n);
+    });
+}
+
+TEST(test_linear_script_blocks) {
+    check_linear("script/style blocks", [](std::size_t n) {
+        return repeat("<script>a<b</script>x<STYLE>y</style>", n);
+    });
+}
+
+TEST(test_linear_linebreak_tags) {
+    check_linear("line-break tags", [](std::size_t n) {
+        return repeat("a<br><P>b</p><hr />", n);
+    });
+}
+
+TEST(test_linear_repeated_link_text) {
+    check_linear("repeated link text", [](std::size_t n) {
+        return repeat("same <a href=\"/s\">same</a>\n", n);
+    });
+}
+
+TEST(test_cpu_budget_truncates) {
+    std::string html = repeat("<p>Paragraph <a href=\"/x\">link</a> text &amp; more</p>\n", 400000);
+    ParseOptions options;
+    options.cpu_budget = std::chrono::milliseconds(1);
+    ParsedPage page = parse_html_basic(html, options);
+    ASSERT(page.truncated, "Parse should stop once the budget is spent");
+    ASSERT(!page.text.empty(), "Text parsed before the budget ran out is kept");
+
+    ParsedPage full = parse_html_basic(html);
+    ASSERT(!full.truncated, "No budget means no truncation");
+    ASSERT(page.text.size() < full.text.size(), "Truncated text is shorter");
+    ASSERT(full.text.compare(0, page.text.size(), page.text) == 0, "Truncated text is a prefix");
+    for (const auto& link : page.links) {
+        ASSERT(link.end_pos <= page.text.size(), "Links stay inside the truncated text");
+    }
+}
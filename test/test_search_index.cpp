@@ -0,0 +1,194 @@
+#include "test.h"
+#include "core/search_index.h"
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::string fresh_dir(const char* name) {
+    auto dir = std::filesystem::temp_directory_path() / ("mini-browser-test-" + std::string(name));
+    std::filesystem::remove_all(dir);
+    return dir.string();
+}
+
+}
+
+TEST(test_tokenize_terms) {
+    std::vector<std::string> terms;
+    tokenize_terms("Hello, WORLD! a x2 caf\xC3\xA9", terms);
+    ASSERT_EQ(4u, terms.size(), "Single letters are skipped");
+    ASSERT_EQ(std::string("hello"), terms[0], "Terms are lowercased");
+    ASSERT_EQ(std::string("world"), terms[1], "Punctuation separates terms");
+    ASSERT_EQ(std::string("x2"), terms[2], "Digits are word characters");
+    ASSERT_EQ(std::string("caf\xC3\xA9"), terms[3], "UTF-8 bytes stay inside words");
+}
+
+TEST(test_index_ranked_search) {
+    std::string dir = fresh_dir("ranked");
+    IndexWriter writer;
+    writer.add("https://a.test/", "Cooking pasta", "Boil water and add pasta. Pasta needs salt.");
+    writer.add("https://b.test/", "Gardening", "Tomatoes grow well; pasta sauce uses tomatoes.");
+    writer.add("https://c.test/", "Cars", "Engines and wheels.");
+    ASSERT(writer.flush(dir), "Segment is written");
+
+    IndexReader reader(dir);
+    ASSERT_EQ(3u, reader.documentCount(), "Three documents indexed");
+    auto hits = reader.search("pasta");
+    ASSERT_EQ(2u, hits.size(), "Two pages mention pasta");
+    ASSERT_EQ(std::string("https://a.test/"), hits[0].url, "Title and frequency rank the pasta page first");
+    ASSERT_EQ(std::string("Cooking pasta"), hits[0].title, "Hit carries the title");
+    ASSERT(hits[0].score > hits[1].score, "Scores are descending");
+
+    auto multi = reader.search("TOMATOES pasta");
+    ASSERT_EQ(std::string("https://b.test/"), multi[0].url, "Matching more terms ranks higher");
+    ASSERT(reader.search("bicycle").empty(), "Unknown terms return nothing");
+}
+
+TEST(test_index_compaction_keeps_newest_copy) {
+    std::string dir = fresh_dir("compact");
+    for (int batch = 0; batch < 3; ++batch) {
+        IndexWriter writer;
+        writer.add("https://same.test/", "Version " + std::to_string(batch), "shared words version" + std::to_string(batch));
+        writer.add("https://p" + std::to_string(batch) + ".test/", "Page", "shared words");
+        ASSERT(writer.flush(dir), "Segment is written");
+    }
+    {
+        IndexReader before(dir);
+        ASSERT_EQ(3u, before.segmentCount(), "One segment per flush");
+        auto hits = before.search("shared");
+        ASSERT_EQ(4u, hits.size(), "Older copies of a URL are hidden");
+    }
+    ASSERT(compact_index(dir), "Compaction succeeds");
+    IndexReader after(dir);
+    ASSERT_EQ(1u, after.segmentCount(), "Segments merged");
+    ASSERT_EQ(4u, after.documentCount(), "Superseded copies dropped");
+    auto hits = after.search("version2");
+    ASSERT_EQ(1u, hits.size(), "Newest copy is searchable");
+    ASSERT_EQ(std::string("Version 2"), hits[0].title, "Newest title kept");
+    ASSERT(after.search("version0").empty(), "Old copy is gone");
+}
+
+TEST(test_search_index_background_and_persistence) {
+    std::string dir = fresh_dir("background");
+    {
+        SearchIndex index(dir);
+        for (int i = 0; i < 40; ++i) {
+            index.addAsync("https://site.test/" + std::to_string(i), "Doc " + std::to_string(i),
+                           std::make_shared<const std::string>(i == 7 ? "the unique zebra page" : "ordinary page text"));
+        }
+        index.flush();
+        auto hits = index.search("zebra");
+        ASSERT_EQ(1u, hits.size(), "Background indexing finished after flush");
+        ASSERT_EQ(std::string("https://site.test/7"), hits[0].url, "Correct page found");
+    }
+    SearchIndex reopened(dir);
+    ASSERT_EQ(40u, reopened.search("ordinary zebra", 100).size(), "Index persists across instances");
+}
+
+TEST(test_index_caps_text_per_page) {
+    std::string dir = fresh_dir("cap");
+    // "straddling" starts 4 bytes before the cap
+    std::string text = "aardvark ";
+    while (text.size() + 7 <= IndexWriter::kMaxTextBytes - 4) text += "filler ";
+    text.append(IndexWriter::kMaxTextBytes - 4 - text.size(), ' ');
+    text += "straddling words after the cap zebra";
+    IndexWriter writer;
+    writer.add("https://big.test/", "Huge report", text);
+    ASSERT(writer.flush(dir), "Segment is written");
+
+    IndexReader reader(dir);
+    ASSERT_EQ(1u, reader.search("aardvark").size(), "The start of the text is indexed");
+    ASSERT_EQ(1u, reader.search("report").size(), "So is the title");
+    ASSERT(reader.search("zebra").empty(), "Text past the cap is not");
+    ASSERT(reader.search("stra").empty() && reader.search("straddling").empty(), "A word across the cap is dropped, not cut");
+}
+
+TEST(test_index_caps_text_without_ascii_breaks) {
+    // Chinese text has no ASCII separators: the whole page is one run of word bytes
+    std::string dir = fresh_dir("cap-cjk");
+    std::string text = "\xE5\x8C\x97\xE4\xBA\xAC";   // 北京
+    while (text.size() <= IndexWriter::kMaxTextBytes + 100) text += "\xE4\xB8\xAD\xE6\x96\x87\xE3\x80\x82";   // 中文。
+    IndexWriter writer;
+    writer.add("https://cjk.test/", "", text);
+    ASSERT(writer.flush(dir), "Segment is written");
+
+    IndexReader reader(dir);
+    ASSERT_EQ(1u, reader.search(text.substr(0, 60)).size(), "The page is indexed, not cut back to nothing");
+}
+
+TEST(test_index_skips_corrupt_segments) {
+    std::string dir = fresh_dir("corrupt");
+    for (int batch = 0; batch < 3; ++batch) {
+        IndexWriter writer;
+        writer.add("https://p" + std::to_string(batch) + ".test/", "Page", "shared words");
+        ASSERT(writer.flush(dir), "Segment is written");
+    }
+    std::vector<std::filesystem::path> files;
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        if (entry.path().extension() == ".mbi") files.push_back(entry.path());
+    }
+    std::sort(files.begin(), files.end());
+    ASSERT_EQ(3u, files.size(), "Three segments");
+
+    auto patch = [](const std::filesystem::path& file, std::size_t offset, std::uint64_t value, std::size_t width) {
+        std::fstream f(file, std::ios::binary | std::ios::in | std::ios::out);
+        f.seekp(static_cast<std::streamoff>(offset));
+        f.write(reinterpret_cast<const char*>(&value), static_cast<std::streamsize>(width));
+    };
+    // Term table offset far past the end of the file
+    patch(files[0], 32, std::uint64_t(1) << 40, 8);
+    // A term count whose table would run into the postings
+    patch(files[1], 12, 1000000, 4);
+
+    IndexReader reader(dir);
+    ASSERT_EQ(1u, reader.segmentCount(), "Segments with out-of-range sections are skipped");
+    auto hits = reader.search("shared words");
+    ASSERT_EQ(1u, hits.size(), "The intact segment is still searchable");
+    ASSERT_EQ(std::string("https://p2.test/"), hits[0].url, "Hit from the intact segment");
+
+    // A term entry whose postings point past the file reads as a missing term
+    const std::size_t termIndex = [&] {
+        std::ifstream f(files[2], std::ios::binary);
+        std::uint64_t v = 0;
+        f.seekg(32);
+        f.read(reinterpret_cast<char*>(&v), 8);
+        return static_cast<std::size_t>(v);
+    }();
+    patch(files[2], termIndex, std::uint64_t(1) << 40, 8);
+    IndexReader damaged(dir);
+    ASSERT_EQ(1u, damaged.segmentCount(), "Segment header is still valid");
+    damaged.search("shared words");
+    ASSERT(compact_index(dir), "Compaction skips damaged entries");
+}
+
+TEST(test_index_writers_share_a_directory) {
+    // Stand-ins for browser processes sharing ~/.mini-browser/index: separate writers,
+    // each flushing and compacting on its own schedule
+    std::string dir = fresh_dir("shared");
+    constexpr int kWriters = 4;
+    constexpr int kBatches = 25;
+    std::vector<std::thread> writers;
+    for (int w = 0; w < kWriters; ++w) {
+        writers.emplace_back([&dir, w] {
+            for (int b = 0; b < kBatches; ++b) {
+                IndexWriter writer;
+                const std::string page = "https://w" + std::to_string(w) + ".test/" + std::to_string(b);
+                // Enough distinct terms that writing the segment takes a while
+                std::string text = "common";
+                for (int i = 0; i < 2000; ++i) text += " t" + std::to_string(w) + "x" + std::to_string(b) + "y" + std::to_string(i);
+                writer.add(page, "Page", text);
+                writer.flush(dir);
+                if (b % 10 == 9) compact_index(dir);
+            }
+        });
+    }
+    for (auto& t : writers) t.join();
+    IndexReader reader(dir);
+    ASSERT_EQ(static_cast<std::size_t>(kWriters * kBatches), reader.search("common", 1000).size(), "No page was lost");
+}
+
@@ -0,0 +1,120 @@
+#include "test.h"
+#include "core/session_snapshot.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace {
+
+std::string fresh_file(const char* name) {
+    auto dir = std::filesystem::temp_directory_path() / "mini-browser-test-session";
+    std::filesystem::create_directories(dir);
+    auto path = dir / name;
+    std::filesystem::remove(path);
+    return path.string();
+}
+
+SessionState sample_session() {
+    SessionState state;
+    state.url = "https://example.com/caf\xC3\xA9";
+    state.status = 200;
+    state.page.title = "Caf\xC3\xA9 menu";
+    state.page.text = "Welcome\nSee the menu or the menu again. Contact us.";
+    state.page.links = {
+        {"menu", "https://example.com/menu", 16, 20},
+        {"menu", "https://example.com/menu", 28, 32},
+        {"Contact us", "https://example.com/contact", 40, 50},
+    };
+    state.page.truncated = true;
+    state.scrollAnchor = 8;
+    state.history = {"https://example.com/", "https://example.com/menu", state.url};
+    return state;
+}
+
+}
+
+TEST(test_session_roundtrip) {
+    std::string path = fresh_file("roundtrip.mbs");
+    SessionState state = sample_session();
+    ASSERT(save_session(path, state), "Snapshot is written");
+
+    SessionSnapshot snap;
+    ASSERT(snap.open(path), "Snapshot opens");
+    ASSERT_EQ(state.url, std::string(snap.url()), "URL restored");
+    ASSERT_EQ(200, snap.status(), "Status restored");
+    ASSERT_EQ(state.page.title, std::string(snap.title()), "Title restored");
+    ASSERT_EQ(state.page.text, std::string(snap.text()), "Text restored");
+    ASSERT(snap.truncated(), "Truncated flag restored");
+    ASSERT_EQ(8u, snap.scrollAnchor(), "Scroll anchor restored");
+
+    ASSERT_EQ(3u, snap.linkCount(), "All links restored");
+    ParsedPage page = snap.page();
+    for (std::size_t i = 0; i < 3; ++i) {
+        ASSERT_EQ(state.page.links[i].url, page.links[i].url, "Link URL");
+        ASSERT_EQ(state.page.links[i].text, page.links[i].text, "Link text");
+        ASSERT_EQ(state.page.links[i].start_pos, page.links[i].start_pos, "Link start offset");
+        ASSERT_EQ(state.page.links[i].end_pos, page.links[i].end_pos, "Link end offset");
+    }
+
+    ASSERT_EQ(3u, snap.historyCount(), "History restored");
+    ASSERT_EQ(std::string("https://example.com/"), std::string(snap.history(0)), "Oldest entry first");
+    ASSERT_EQ(state.url, std::string(snap.history(2)), "Newest entry last");
+}
+
+TEST(test_session_strings_are_deduplicated) {
+    SessionState state;
+    state.url = "https://example.com/";
+    state.page.text = std::string(100, 'x');
+    for (std::size_t i = 0; i < 1000; ++i) state.page.links.push_back({"same text", "https://example.com/same-target", 0, 10});
+    std::string path = fresh_file("dedup.mbs");
+    ASSERT(save_session(path, state), "Snapshot is written");
+
+    SessionSnapshot snap;
+    ASSERT(snap.open(path), "Snapshot opens");
+    ASSERT_EQ(1000u, snap.linkCount(), "Every link is kept");
+    ASSERT(snap.size() < 1000 * 24 + 1024, "Repeated link strings are stored once");
+}
+
+TEST(test_session_rejects_damaged_files) {
+    std::string path = fresh_file("damaged.mbs");
+    SessionSnapshot snap;
+    ASSERT(!snap.open(path), "Missing file does not open");
+
+    ASSERT(save_session(path, sample_session()), "Snapshot is written");
+    std::string bytes;
+    {
+        std::ifstream in(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), {});
+    }
+    auto write = [&](const std::string& data) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    };
+
+    write(bytes.substr(0, bytes.size() - 3));
+    ASSERT(!snap.open(path), "Truncated file is rejected");
+    ASSERT(!snap.isOpen(), "Failed open leaves nothing mapped");
+
+    std::string otherVersion = bytes;
+    otherVersion[4] = 99;
+    write(otherVersion);
+    ASSERT(!snap.open(path), "Other format version is rejected");
+
+    std::string badLink = bytes;
+    std::size_t linksOffset = static_cast<unsigned char>(bytes[48]) | (static_cast<unsigned char>(bytes[49]) << 8);
+    badLink[linksOffset + 8] = 0x7F;   // end offset far past the text
+    write(badLink);
+    ASSERT(!snap.open(path), "Link outside the text is rejected");
+
+    write(bytes);
+    ASSERT(snap.open(path), "Intact file opens again");
+}
+
+TEST(test_session_empty_state) {
+    std::string path = fresh_file("empty.mbs");
+    ASSERT(save_session(path, SessionState{}), "Empty session is written");
+    SessionSnapshot snap;
+    ASSERT(snap.open(path), "Empty session opens");
+    ASSERT(snap.url().empty(), "Nothing to restore");
+    ASSERT_EQ(0u, snap.linkCount(), "No links");
+}
@@ -0,0 +1,182 @@
+#include "test.h"
+#include "core/executor.h"
+#include "core/text_layout.h"
+#include <chrono>
+#include <future>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 10 px per glyph, 20 px lines
+const FixedGlyphMetrics kMono(10.f, 20.f);
+
+Link link(std::size_t start, std::size_t end, const std::string& url) {
+    Link l;
+    l.start_pos = start;
+    l.end_pos = end;
+    l.url = url;
+    return l;
+}
+
+}
+
+TEST(test_layout_wraps_words_to_width) {
+    TextLayout layout = layout_text("aaa bbb ccc dddd", {}, kMono, LayoutOptions{100.f});
+    ASSERT_EQ(2u, layout.lines().size(), "Two lines at 100 px");
+    ASSERT_EQ(4u, layout.runs().size(), "One run per word");
+    const auto& runs = layout.runs();
+    ASSERT_EQ(40.f, runs[1].x, "Second word after one space");
+    ASSERT_EQ(0.f, runs[2].x, "Third word wraps to the line start");
+    ASSERT_EQ(40.f, runs[3].width, "Width from the metrics");
+    ASSERT_EQ(2u, layout.lines()[1].firstRun, "Second line starts at the third word");
+    ASSERT_EQ(8u, layout.lines()[1].byteStart, "Line start as a text offset");
+    ASSERT_EQ(40.f, layout.height(), "Height is lines times line height");
+}
+
+TEST(test_layout_paragraphs_and_whitespace) {
+    TextLayout layout = layout_text("a    b\n\n  c\n", {}, kMono, LayoutOptions{500.f});
+    ASSERT_EQ(3u, layout.lines().size(), "Each newline starts a line; a trailing one adds nothing");
+    ASSERT_EQ(20.f, layout.runs()[1].x, "Runs of spaces collapse to one");
+    ASSERT_EQ(0u, layout.lines()[1].runCount, "Blank paragraph is an empty line");
+    ASSERT_EQ(0.f, layout.runs()[2].x, "Leading spaces are dropped");
+    ASSERT_EQ(2u, layout.lineOf(10), "Offset in the last paragraph");
+    ASSERT_EQ(0u, layout.lineOf(3), "Whitespace belongs to the line before");
+
+    TextLayout narrow = layout_text("a supercalifragilistic b", {}, kMono, LayoutOptions{50.f});
+    ASSERT_EQ(3u, narrow.lines().size(), "An overlong word gets its own line");
+    ASSERT_EQ(200.f, narrow.runs()[1].width, "and overflows rather than being cut");
+}
+
+TEST(test_layout_utf8_offsets) {
+    std::string text = "h\xC3\xA9llo w\xC3\xB6rld \xE2\x82\xAC";   // héllo wörld €
+    TextLayout layout = layout_text(text, {}, kMono, LayoutOptions{1000.f});
+    const auto& runs = layout.runs();
+    ASSERT_EQ(3u, runs.size(), "Three words");
+    ASSERT_EQ(6u, runs[0].length, "Two-byte code point counted in bytes");
+    ASSERT_EQ(7u, layout.runStart(0, 1), "Byte offsets follow the UTF-8 text");
+    ASSERT_EQ(14u, layout.runStart(0, 2), "Three-byte code point");
+    ASSERT_EQ(text.size(), layout.runStart(0, 2) + runs[2].length, "Last run ends at the end of the text");
+    ASSERT_EQ(50.f, runs[0].width, "Measured in glyphs, not bytes");
+    ASSERT_EQ(80.f, layout.xOf(10, text, kMono), "x of an offset after a multi-byte code point");
+    ASSERT_EQ(16u, sizeof(LayoutRun), "A run is 16 bytes");
+
+    TextLayout wrapped = layout_text("ab\n" + text, {}, kMono, LayoutOptions{60.f});
+    ASSERT_EQ(4u, wrapped.lines().size(), "One word per line at 60 px");
+    ASSERT_EQ(0u, wrapped.runs()[2].start, "Run offsets are relative to their line");
+    ASSERT_EQ(10u, wrapped.runStart(2, 2), "and become text offsets with the line start");
+    ASSERT_EQ(20.f, wrapped.xOf(13, "ab\n" + text, kMono), "x of an offset on a later line");
+
+    const std::string invalid = "a\xFF" "b c";
+    TextLayout replaced = layout_text(invalid, {}, kMono, LayoutOptions{1000.f});
+    ASSERT_EQ(30.f, replaced.runs()[0].width, "A malformed byte measures as one replacement glyph");
+    ASSERT_EQ(4u, replaced.runStart(0, 1), "and keeps its byte");
+}
+
+TEST(test_layout_link_boxes) {
+    //                 0         1         2
+    //                 0123456789012345678901234567
+    std::string text = "see the linked page here now";
+    std::vector<Link> links = {link(8, 19, "http://a/"), link(21, 23, "http://b/")};
+    TextLayout layout = layout_text(text, links, kMono, LayoutOptions{150.f});
+    // Lines: "see the linked" / "page here now"
+    ASSERT_EQ(2u, layout.lines().size(), "Wrapped into two lines");
+    const auto& boxes = layout.linkBoxes();
+    ASSERT_EQ(3u, boxes.size(), "Wrapped link has a box per line");
+    ASSERT_EQ(0u, boxes[0].line, "First part on the first line");
+    ASSERT_EQ(80.f, boxes[0].x, "Starts at its word");
+    ASSERT_EQ(60.f, boxes[0].width, "Covers the word");
+    ASSERT_EQ(1u, boxes[1].line, "Second part on the next line");
+    ASSERT_EQ(0.f, boxes[1].x, "Starts at the line start");
+    ASSERT_EQ(40.f, boxes[1].width, "Covers 'page'");
+    ASSERT_EQ(1u, boxes[2].link, "Mid-word link");
+    ASSERT_EQ(60.f, boxes[2].x, "Starts inside 'here'");
+    ASSERT_EQ(20.f, boxes[2].width, "Ends inside 'here'");
+
+    ASSERT_EQ(0u, layout.linkAt(100.f, 5.f), "Hit on the first line");
+    ASSERT_EQ(0u, layout.linkAt(10.f, 25.f), "Hit on the wrapped part");
+    ASSERT_EQ(1u, layout.linkAt(70.f, 30.f), "Hit on the mid-word link");
+    ASSERT_EQ(TextLayout::npos, layout.linkAt(10.f, 5.f), "Miss on plain text");
+    ASSERT_EQ(TextLayout::npos, layout.linkAt(10.f, 500.f), "Miss below the text");
+
+    const VisibleLines second = layout.visibleLines(25.f, 10.f);
+    ASSERT(second.first == 1 && second.last == 2, "Scrolled to the second line, clamped to the text");
+    ASSERT(second.firstBox == 1 && second.lastBox == 3, "Only the second line's link boxes");
+    const VisibleLines top = layout.visibleLines(-5.f, 10.f);
+    ASSERT(top.first == 0 && top.last == 2 && top.firstBox == 0 && top.lastBox == 3, "Overscroll shows the top");
+    const std::vector<std::size_t> offsets = {8, 21, 25};
+    ASSERT_EQ(1u, layout.firstOffsetFrom(offsets, 1), "First offset on the second line");
+    ASSERT_EQ(3u, layout.firstOffsetFrom(offsets, 2), "None below the last line");
+}
+
+TEST(test_layout_parallel_matches_serial) {
+    std::string text;
+    std::vector<Link> links;
+    for (int i = 0; i < 3000; ++i) {
+        text += "Paragraph " + std::to_string(i) + " has some words, ";
+        std::size_t start = text.size();
+        text += "a link that may wrap";
+        links.push_back(link(start, text.size(), "http://x/" + std::to_string(i)));
+        text += " and a caf\xC3\xA9 or two" + std::string(i % 7 == 0 ? "\n\n" : "\n");
+    }
+    TableGlyphMetrics metrics(9.f, 18.f);
+    for (char32_t c = U'a'; c <= U'z'; ++c) metrics.set(c, 6.f + static_cast<float>(c % 5));
+
+    TextLayout serial = layout_text(text, links, metrics, LayoutOptions{240.f, 1});
+    TextLayout parallel = layout_text(text, links, metrics, LayoutOptions{240.f, 4, 4096});
+    ASSERT(serial.lines().size() > 3000, "Paragraphs wrap");
+    ASSERT_EQ(serial.lines().size(), parallel.lines().size(), "Same line count");
+    ASSERT_EQ(serial.runs().size(), parallel.runs().size(), "Same run count");
+    ASSERT_EQ(serial.linkBoxes().size(), parallel.linkBoxes().size(), "Same link boxes");
+    bool same = true;
+    for (std::size_t i = 0; i < serial.runs().size(); ++i) {
+        const LayoutRun& a = serial.runs()[i];
+        const LayoutRun& b = parallel.runs()[i];
+        same = same && a.start == b.start && a.length == b.length && a.x == b.x && a.width == b.width;
+    }
+    for (std::size_t i = 0; i < serial.lines().size(); ++i) {
+        same = same && serial.lines()[i].firstRun == parallel.lines()[i].firstRun
+                    && serial.lines()[i].byteStart == parallel.lines()[i].byteStart;
+    }
+    for (std::size_t i = 0; i < serial.linkBoxes().size(); ++i) {
+        const LinkBox& a = serial.linkBoxes()[i];
+        const LinkBox& b = parallel.linkBoxes()[i];
+        same = same && a.link == b.link && a.line == b.line && a.x == b.x && a.width == b.width;
+    }
+    ASSERT(same, "Parallel layout is identical to serial");
+    const std::size_t lastLine = parallel.lines().size() - 1;
+    ASSERT_EQ(text.size() - 1, parallel.runStart(lastLine, parallel.runs().size() - 1) + parallel.runs().back().length,
+              "Offsets are stitched across pieces");
+}
+
+TEST(test_layout_does_not_wait_for_busy_executor) {
+    // Every worker is stuck in a long task, as during a navigation's parse
+    std::promise<void> release;
+    std::shared_future<void> gate = release.get_future().share();
+    for (std::size_t i = 0; i < Executor::shared().size(); ++i) {
+        Executor::shared().post([gate] { gate.wait(); }, TaskPriority::Interactive);
+    }
+
+    std::string text;
+    for (int i = 0; i < 2000; ++i) text += "A paragraph of words that wraps at narrow widths " + std::to_string(i) + "\n";
+    auto layout = std::async(std::launch::async, [&] {
+        return layout_text(text, {}, kMono, LayoutOptions{200.f, 4, 4096});
+    });
+    const bool finished = layout.wait_for(std::chrono::seconds(5)) == std::future_status::ready;
+    release.set_value();
+    ASSERT(finished, "Layout finishes on the calling thread while the workers are busy");
+    ASSERT_EQ(layout_text(text, {}, kMono, LayoutOptions{200.f, 1}).lines().size(), layout.get().lines().size(),
+              "Same result as a serial layout");
+}
+
+TEST(test_table_glyph_metrics) {
+    TableGlyphMetrics metrics(8.f, 16.f);
+    metrics.set(U'i', 3.f);
+    metrics.set(U'中', 14.f);
+    ASSERT(metrics.has(U'i') && metrics.has(U'中'), "Set code points are known");
+    ASSERT(!metrics.has(U'm'), "Others are not");
+    ASSERT_EQ(3.f, metrics.advance(U'i'), "Latin-1 table");
+    ASSERT_EQ(14.f, metrics.advance(U'中'), "Wide code point map");
+    ASSERT_EQ(8.f, metrics.advance(U'm'), "Fallback advance");
+    ASSERT_EQ(25.f, metrics.measure(U"i中m"), "measure sums advances");
+}
@@ -0,0 +1,148 @@
+#include "test.h"
+#include "core/text_search.h"
+#include <chrono>
+#include <random>
+#include <string>
+#include <thread>
+
+namespace {
+
+std::vector<std::size_t> naive_find_all(const std::string& hay, const std::string& needle) {
+    std::vector<std::size_t> out;
+    auto lower = [](char c) { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + 32) : c; };
+    for (std::size_t i = 0; needle.size() && i + needle.size() <= hay.size(); ++i) {
+        std::size_t k = 0;
+        while (k < needle.size() && lower(hay[i + k]) == lower(needle[k])) ++k;
+        if (k == needle.size()) out.push_back(i);
+    }
+    return out;
+}
+
+bool wait_for_result(TextFinder& finder, FindResult& out) {
+    for (int i = 0; i < 2000; ++i) {
+        if (finder.poll(out)) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+}
+
+TEST(test_find_all_ci_matches_naive) {
+    std::mt19937 rng(3);
+    const char alphabet[] = "abAB \n";
+    for (int it = 0; it < 500; ++it) {
+        std::string hay, needle;
+        for (int i = 0, n = rng() % 200; i < n; ++i) hay.push_back(alphabet[rng() % 6]);
+        for (int i = 0, n = 1 + rng() % 4; i < n; ++i) needle.push_back(alphabet[rng() % 6]);
+        auto expected = naive_find_all(hay, needle);
+        auto actual = find_all_ci(hay, needle);
+        ASSERT_EQ(expected.size(), actual.size(), "Match count equals naive search");
+        ASSERT(expected == actual, "Match offsets equal naive search");
+    }
+}
+
+TEST(test_find_case_insensitive) {
+    CaseInsensitiveSearcher s("HeLLo");
+    ASSERT_EQ(4u, s.find("say hello, HELLO", 0), "Lowercase occurrence found");
+    ASSERT_EQ(11u, s.find("say hello, HELLO", 5), "Uppercase occurrence found");
+    ASSERT(s.find("help") == std::string_view::npos, "No false positives");
+}
+
+TEST(test_text_finder_incremental) {
+    auto text = std::make_shared<std::string>("Alpha beta alphabet ALPS");
+    TextFinder finder;
+    finder.setText(text);
+    FindResult r;
+
+    finder.search("al");
+    ASSERT(wait_for_result(finder, r), "Small text result is available");
+    ASSERT_EQ(3u, r.matches.size(), "Three 'al' matches");
+
+    finder.search("alp");
+    ASSERT(wait_for_result(finder, r), "Refined result is available");
+    ASSERT_EQ(3u, r.matches.size(), "Three 'alp' matches");
+
+    finder.search("alpha");
+    ASSERT(wait_for_result(finder, r), "Further refined result is available");
+    ASSERT_EQ(2u, r.matches.size(), "Two 'alpha' matches");
+    ASSERT_EQ(std::string("alpha"), r.query, "Result carries its query");
+}
+
+TEST(test_text_finder_background_and_cancel) {
+    auto text = std::make_shared<std::string>();
+    for (int i = 0; i < 200000; ++i) *text += "lorem ipsum dolor ";
+    *text += "needle";
+    TextFinder finder;
+    finder.setText(text);
+
+    finder.search("needle");
+    finder.cancel();
+    finder.search("NEEDLE");
+    FindResult r;
+    ASSERT(wait_for_result(finder, r), "Background search completes");
+    ASSERT_EQ(std::string("NEEDLE"), r.query, "Only the newest query is delivered");
+    ASSERT_EQ(1u, r.matches.size(), "Needle found once");
+    ASSERT_EQ(text->size() - 6, r.matches[0], "Needle offset");
+
+    finder.search("dolor");
+    finder.cancel();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT(!finder.poll(r), "Cancelled search delivers nothing");
+}
+
+TEST(test_text_finder_drops_undelivered_result) {
+    auto text = std::make_shared<std::string>();
+    for (int i = 0; i < 200000; ++i) *text += "lorem ipsum dolor ";
+    *text += "needle";
+    TextFinder finder;
+    finder.setText(text);
+
+    // Query A completes in the background but is never polled before query B starts
+    finder.search("needle");
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    finder.search("dolor");
+
+    FindResult r;
+    ASSERT(wait_for_result(finder, r), "Query B completes");
+    ASSERT_EQ(std::string("dolor"), r.query, "A's stale result is never delivered");
+    ASSERT_EQ(200000u, r.matches.size(), "B's matches");
+    ASSERT(!finder.poll(r), "Nothing else is pending");
+}
+
+TEST(test_find_all_ci_across_scan_windows) {
+    // Matches on and around the 1 MB boundaries between cancellation checks
+    std::string hay(3 * (1 << 20) + 10, 'x');
+    for (std::size_t edge : {std::size_t(1) << 20, std::size_t(2) << 20}) {
+        for (std::size_t at : {edge - 3, edge - 1, edge}) hay.replace(at, 3, "AbA");
+    }
+    hay.replace(hay.size() - 3, 3, "aba");
+    ASSERT(naive_find_all(hay, "aba") == find_all_ci(hay, "aba"), "Same matches as a single scan");
+    std::atomic<bool> cancelled {true};
+    ASSERT(find_all_ci(hay, "aba", &cancelled).size() < naive_find_all(hay, "aba").size(), "Cancel stops between windows");
+}
+
+TEST(test_text_finder_cancels_scan_without_matches) {
+    // Every byte is a candidate for the needle's first byte and none matches: a slow full scan
+    auto text = std::make_shared<const std::string>(24u << 20, 'q');
+    auto started = std::chrono::steady_clock::now();
+    ASSERT(find_all_ci(*text, "q!").empty(), "Needle is absent");
+    const auto fullScan = std::chrono::steady_clock::now() - started;
+
+    TextFinder finder;
+    finder.setText(text);
+    finder.search("q!");
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    started = std::chrono::steady_clock::now();
+    finder.search("q?");
+    FindResult result;
+    bool delivered = false;
+    while (!(delivered = finder.poll(result)) && std::chrono::steady_clock::now() - started < fullScan * 4) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT(delivered, "Newer query delivers");
+    const auto took = std::chrono::steady_clock::now() - started;
+    ASSERT_EQ(std::string("q?"), result.query, "Only the newest query is delivered");
+    ASSERT(took < fullScan * 3 / 2, "The superseded scan stopped early instead of finishing first");
+}
+
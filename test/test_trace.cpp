@@ -0,0 +1,72 @@
+#include "test.h"
+#include "core/html_parser.h"
+#include "core/trace.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+namespace {
+
+std::string read_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), {});
+}
+
+std::size_t count(const std::string& s, const std::string& needle) {
+    std::size_t n = 0;
+    for (std::size_t pos = s.find(needle); pos != std::string::npos; pos = s.find(needle, pos + 1)) ++n;
+    return n;
+}
+
+}
+
+TEST(test_trace_disabled_records_nothing) {
+    trace_stop();
+    trace_clear();
+    {
+        TRACE_SCOPE("test", "ignored");
+    }
+    parse_html_basic("<p>hello</p>");
+    ASSERT_EQ(0u, trace_event_count(), "No spans while tracing is off");
+}
+
+TEST(test_trace_records_spans_across_threads) {
+    trace_clear();
+    trace_start();
+    {
+        TRACE_SCOPE("test", "outer");
+        TRACE_SCOPE("test", "inner \"quoted\"");
+    }
+    std::thread worker([] {
+        trace_set_thread_name("worker");
+        TRACE_SCOPE("test", "on_worker");
+    });
+    worker.join();
+    parse_html_basic("<title>T</title><p>hello <a href=\"/x\">x</a></p>");
+    trace_stop();
+
+    ASSERT(trace_event_count() >= 5, "Scopes, the worker span and parser stages are recorded");
+
+    std::string path = (std::filesystem::temp_directory_path() / "mini-browser-test-trace.json").string();
+    ASSERT(trace_write(path), "Trace file is written");
+    std::string json = read_file(path);
+    ASSERT(json.starts_with("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["), "Chrome trace-event object");
+    ASSERT(json.ends_with("]}\n"), "Event array is closed");
+    ASSERT_EQ(1u, count(json, "\"name\":\"outer\""), "Outer span exported once");
+    ASSERT_EQ(1u, count(json, "\"name\":\"inner \\\"quoted\\\"\""), "Names are JSON-escaped");
+    ASSERT_EQ(1u, count(json, "\"name\":\"parse_html_basic\""), "Parser is instrumented");
+    ASSERT_EQ(1u, count(json, "\"name\":\"tokenize\""), "Serial tokenizer stage is instrumented");
+    ASSERT_EQ(1u, count(json, "\"args\":{\"name\":\"worker\"}"), "Thread name metadata is exported");
+
+    // The worker's span is on its own track
+    std::size_t outer = json.find("\"name\":\"outer\"");
+    std::size_t worker_span = json.find("\"name\":\"on_worker\"");
+    std::string outerTid = json.substr(json.find("\"tid\":", outer), 8);
+    std::string workerTid = json.substr(json.find("\"tid\":", worker_span), 8);
+    ASSERT(outerTid != workerTid, "Each thread has its own tid");
+
+    trace_clear();
+    ASSERT_EQ(0u, trace_event_count(), "Clear drops every event");
+    std::filesystem::remove(path);
+}
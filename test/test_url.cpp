@@ -0,0 +1,210 @@
+#include "test.h"
+#include "core/html_parser.h"
+#include "core/url.h"
+#include <cstdlib>
+#include <string>
+#include <unordered_set>
+
+namespace {
+
+std::string resolve(const Url& base, const char* ref) {
+    auto u = base.resolve(ref);
+    return u ? u->href() : std::string("<invalid>");
+}
+
+}
+
+TEST(test_url_components) {
+    auto u = Url::parse("HTTPS://user:pw@Example.COM:8443/a/b?x=1#top");
+    ASSERT(u.has_value(), "Absolute URL parses");
+    ASSERT_EQ(std::string("https"), std::string(u->scheme()), "Scheme is lowercased");
+    ASSERT_EQ(std::string("user:pw"), std::string(u->userinfo()), "Userinfo span");
+    ASSERT_EQ(std::string("example.com"), std::string(u->host()), "Host is lowercased");
+    ASSERT_EQ(8443, u->port(), "Explicit port");
+    ASSERT_EQ(std::string("/a/b"), std::string(u->path()), "Path span");
+    ASSERT_EQ(std::string("x=1"), std::string(u->query()), "Query span");
+    ASSERT_EQ(std::string("top"), std::string(u->fragment()), "Fragment span");
+    ASSERT_EQ(std::string("https://user:pw@example.com:8443/a/b?x=1#top"), u->href(), "Normalized href");
+    ASSERT_EQ(std::string("https://user:pw@example.com:8443/a/b?x=1"), std::string(u->cacheKey()),
+              "Cache key drops the fragment");
+    ASSERT_EQ(std::string("https://example.com:8443"), std::string(u->origin().str()), "Origin omits userinfo");
+
+    ASSERT(!Url::parse("/relative/path").has_value(), "A URL needs a scheme");
+    ASSERT(!Url::parse("http://host:99999/").has_value(), "Port out of range");
+    ASSERT(!Url::parse("http://host:8x/").has_value(), "Port must be numeric");
+}
+
+TEST(test_url_normalization) {
+    auto a = Url::parse("http://Example.com:80");
+    auto b = Url::parse("http://example.com/./x/../");
+    ASSERT(a && b, "Both parse");
+    ASSERT_EQ(std::string("http://example.com/"), a->href(), "Default port dropped, empty path becomes /");
+    ASSERT(*a == *b, "Equivalent spellings normalize to the same key");
+    ASSERT_EQ(std::hash<Url>{}(*a), std::hash<Url>{}(*b), "Equal URLs hash equally");
+    ASSERT_EQ(80, a->port(), "Default port is still reported");
+
+    auto v6 = Url::parse("http://[::1]:8080/");
+    ASSERT(v6.has_value(), "IPv6 literal parses");
+    ASSERT_EQ(std::string("[::1]"), std::string(v6->host()), "Brackets stay in the host");
+    ASSERT_EQ(8080, v6->port(), "Port after IPv6 literal");
+
+    auto mail = Url::parse("mailto:someone@example.com");
+    ASSERT(mail.has_value(), "URLs without authority parse");
+    ASSERT(mail->origin().isOpaque(), "mailto: has an opaque origin");
+}
+
+TEST(test_url_origins_are_interned) {
+    auto a = Url::parse("https://example.com/a");
+    auto b = Url::parse("https://EXAMPLE.com:443/b?q");
+    auto c = Url::parse("http://example.com/a");
+    ASSERT(a && b && c, "All parse");
+    ASSERT(a->origin() == b->origin(), "Same scheme, host and port share one origin");
+    ASSERT(!(a->origin() == c->origin()), "Scheme is part of the origin");
+    ASSERT_EQ(a->origin().str().data(), b->origin().str().data(), "Interned origins share storage");
+
+    std::unordered_set<Origin> origins {a->origin(), b->origin(), c->origin()};
+    ASSERT_EQ(2u, origins.size(), "Origins hash by identity");
+}
+
+TEST(test_url_rfc3986_normal_examples) {
+    // RFC 3986 section 5.4.1 (empty http paths are normalized to "/")
+    auto base = Url::parse("http://a/b/c/d;p?q");
+    ASSERT(base.has_value(), "Base parses");
+    const char* cases[][2] = {
+        {"g:h", "g:h"},
+        {"g", "http://a/b/c/g"},
+        {"./g", "http://a/b/c/g"},
+        {"g/", "http://a/b/c/g/"},
+        {"/g", "http://a/g"},
+        {"//g", "http://g/"},
+        {"?y", "http://a/b/c/d;p?y"},
+        {"g?y", "http://a/b/c/g?y"},
+        {"#s", "http://a/b/c/d;p?q#s"},
+        {"g#s", "http://a/b/c/g#s"},
+        {"g?y#s", "http://a/b/c/g?y#s"},
+        {";x", "http://a/b/c/;x"},
+        {"g;x", "http://a/b/c/g;x"},
+        {"g;x?y#s", "http://a/b/c/g;x?y#s"},
+        {"", "http://a/b/c/d;p?q"},
+        {".", "http://a/b/c/"},
+        {"./", "http://a/b/c/"},
+        {"..", "http://a/b/"},
+        {"../", "http://a/b/"},
+        {"../g", "http://a/b/g"},
+        {"../..", "http://a/"},
+        {"../../", "http://a/"},
+        {"../../g", "http://a/g"},
+    };
+    for (const auto& c : cases) {
+        ASSERT_EQ(std::string(c[1]), resolve(*base, c[0]), std::string("Resolving \"") + c[0] + "\"");
+    }
+}
+
+TEST(test_url_rfc3986_abnormal_examples) {
+    // RFC 3986 section 5.4.2
+    auto base = Url::parse("http://a/b/c/d;p?q");
+    ASSERT(base.has_value(), "Base parses");
+    const char* cases[][2] = {
+        {"../../../g", "http://a/g"},
+        {"../../../../g", "http://a/g"},
+        {"/./g", "http://a/g"},
+        {"/../g", "http://a/g"},
+        {"g.", "http://a/b/c/g."},
+        {".g", "http://a/b/c/.g"},
+        {"g..", "http://a/b/c/g.."},
+        {"..g", "http://a/b/c/..g"},
+        {"./../g", "http://a/b/g"},
+        {"./g/.", "http://a/b/c/g/"},
+        {"g/./h", "http://a/b/c/g/h"},
+        {"g/../h", "http://a/b/c/h"},
+        {"g;x=1/./y", "http://a/b/c/g;x=1/y"},
+        {"g;x=1/../y", "http://a/b/c/y"},
+        {"g?y/./x", "http://a/b/c/g?y/./x"},
+        {"g?y/../x", "http://a/b/c/g?y/../x"},
+        {"g#s/./x", "http://a/b/c/g#s/./x"},
+        {"g#s/../x", "http://a/b/c/g#s/../x"},
+        {"http:g", "http:g"},
+    };
+    for (const auto& c : cases) {
+        ASSERT_EQ(std::string(c[1]), resolve(*base, c[0]), std::string("Resolving \"") + c[0] + "\"");
+    }
+}
+
+TEST(test_url_from_user_input) {
+    auto a = Url::fromUserInput("  example.com/docs ");
+    ASSERT(a.has_value(), "Bare host parses");
+    ASSERT_EQ(std::string("https://example.com/docs"), a->href(), "https:// is assumed");
+
+    auto b = Url::fromUserInput("localhost:8080/x");
+    ASSERT(b.has_value(), "host:port parses");
+    ASSERT_EQ(std::string("https://localhost:8080/x"), b->href(), "host:port is not mistaken for a scheme");
+
+    auto c = Url::fromUserInput("http://example.com");
+    ASSERT(c.has_value(), "Explicit scheme parses");
+    ASSERT_EQ(std::string("http://example.com/"), c->href(), "Explicit scheme is kept");
+
+    ASSERT(!Url::fromUserInput("   ").has_value(), "Blank input is rejected");
+}
+
+TEST(test_resolve_links_batch) {
+    auto base = Url::parse("https://example.com/docs/guide/index.html?v=2");
+    ASSERT(base.has_value(), "Base parses");
+    auto page = parse_html_basic("<a href=\"../api\">API</a> <a href=\" //cdn.example.com/x \">CDN</a> "
+                                 "<a href=\"#intro\">Intro</a> <a href=\"?v=3\">Next</a>");
+    resolve_links(page.links, *base);
+    ASSERT_EQ(4u, page.links.size(), "Four links");
+    ASSERT_EQ(std::string("https://example.com/docs/api"), page.links[0].url, "Parent-relative link");
+    ASSERT_EQ(std::string("https://cdn.example.com/x"), page.links[1].url, "Protocol-relative link");
+    ASSERT_EQ(std::string("https://example.com/docs/guide/index.html?v=2#intro"), page.links[2].url,
+              "Fragment-only link");
+    ASSERT_EQ(std::string("https://example.com/docs/guide/index.html?v=3"), page.links[3].url, "Query-only link");
+}
+
+TEST(test_url_file_paths) {
+    auto u = Url::fromFilePath("/tmp/My Reports/q3#final?.html");
+    ASSERT(u.has_value(), "Absolute path converts");
+    ASSERT_EQ(std::string("file:///tmp/My%20Reports/q3%23final%3F.html"), u->href(), "Unsafe bytes are percent-encoded");
+    ASSERT_EQ(std::string("/tmp/My Reports/q3#final?.html"), u->filePath().value_or("<none>"), "Path round-trips");
+    ASSERT(!Url::fromFilePath("relative/x.html"), "Relative paths are rejected");
+
+    ASSERT_EQ(std::string("/srv/a.html"), Url::parse("file://localhost/srv/a.html")->filePath().value_or("<none>"),
+              "localhost is local");
+    ASSERT(!Url::parse("file://fileserver/share/a.html")->filePath(), "Another host is not a local path");
+    ASSERT(!Url::parse("https://example.com/a.html")->filePath(), "Only file: URLs have a path on disk");
+
+    auto base = *Url::parse("file:///home/me/report/index.html");
+    ASSERT_EQ(std::string("file:///home/me/report/charts/q1.html"), resolve(base, "charts/q1.html"), "Relative links stay local");
+    ASSERT_EQ(std::string("file:///home/me/style.css"), resolve(base, "../style.css"), "Dot segments resolve");
+}
+
+TEST(test_url_user_input_paths) {
+    ASSERT_EQ(std::string("file:///var/log/report%201.html"), Url::fromUserInput("  /var/log/report 1.html ")->href(),
+              "Absolute paths are local files");
+    ASSERT_EQ(std::string("file:///tmp/x.html"), Url::fromUserInput("file:///tmp/x.html")->href(), "file: URLs are kept");
+    const char* home = std::getenv("HOME");
+    if (home && home[0] == '/') {
+        ASSERT_EQ(Url::fromFilePath(std::string(home) + "/notes.html")->href(), Url::fromUserInput("~/notes.html")->href(),
+                  "~/ expands to HOME");
+    }
+    auto rel = Url::fromUserInput("./page.html");
+    ASSERT(rel && rel->scheme() == "file" && rel->path().ends_with("/page.html") && rel->path().find("/./") == std::string_view::npos,
+           "./ is resolved against the working directory");
+    ASSERT_EQ(std::string("https://example.com/a"), Url::fromUserInput("example.com/a")->href(), "Host names still mean https");
+}
+
+TEST(test_link_may_open) {
+    const auto remote = Url::parse("https://example.com/index.html");
+    const auto local = Url::parse("file:///home/me/report/index.html");
+    const auto secrets = *Url::parse("file:///etc/passwd");
+
+    // A remote page linking to file: (resolved like any other link) must not open it
+    ParsedPage page = parse_html_basic("<a href=\"file:///etc/passwd\">x</a><a href=\"/next\">y</a>");
+    resolve_links(page.links, *remote);
+    ASSERT(!link_may_open(remote, *Url::parse(page.links[0].url)), "http page cannot open a local file");
+    ASSERT(link_may_open(remote, *Url::parse(page.links[1].url)), "http page opens http links");
+
+    ASSERT(link_may_open(local, secrets), "Local pages link to other local files");
+    ASSERT(link_may_open(local, *Url::parse("https://example.com/")), "Local pages link out");
+    ASSERT(!link_may_open(std::nullopt, secrets), "No page, no file: link");
+    ASSERT(!link_may_open(remote, *Url::parse("javascript:alert(1)")), "Other schemes never open");
+}